@@ -0,0 +1,136 @@
+#! /usr/bin/env python3
+
+"""
+Runs every synthetic target natively, under NullTool.so (i.e. the bare overhead of Intel PIN) and under MemTrace.so,
+and reports for each of them:
+    - the slowdown of MemTrace with respect to the native execution and to NullTool (i.e. the cost of the analysis);
+    - the number of analysis calls per second, taken from the statistics written by MemTrace (knob --stats);
+    - the peak resident set size of the NullTool and MemTrace executions.
+"""
+
+import os
+import sys
+import json
+import time
+import tempfile
+import statistics
+import argparse as ap
+import subprocess as subp
+
+benchmarks_path = os.path.realpath(sys.path[0])
+root_path = os.path.realpath(os.path.join(benchmarks_path, '..', '..'))
+default_pin_path = os.path.join(root_path, 'third_party', 'PIN', 'pin', 'pin')
+default_tool_dir = os.path.join(root_path, 'tool')
+default_targets_dir = os.path.join(benchmarks_path, 'build')
+
+TARGETS = ['stack_recursion', 'malloc_churn', 'mmap_alloc', 'simd_strings', 'syscall_io', 'register_taint']
+# Counters of MemTrace statistics corresponding to the invocations of analysis routines
+ANALYSIS_COUNTERS = ['memory_reads', 'memory_writes', 'pending_read_propagations', 'excluded_writes']
+
+
+def parse_args():
+    parser = ap.ArgumentParser(description = "Measure the overhead of MemTrace on the synthetic targets")
+    parser.add_argument("--targets-dir", default = default_targets_dir,
+        help = "Directory containing the compiled targets (default: %(default)s)")
+    parser.add_argument("--pin", default = default_pin_path,
+        help = "Path of Intel PIN launcher (default: %(default)s)")
+    parser.add_argument("--tool-dir", default = default_tool_dir,
+        help = "Directory containing MemTrace.so and NullTool.so (default: %(default)s)")
+    parser.add_argument("--runs", type = int, default = 3,
+        help = "Number of executions of each configuration. The median is reported (default: %(default)s)")
+    parser.add_argument("--csv",
+        help = "Also write the results to the given CSV file")
+    parser.add_argument("targets", nargs = "*", default = TARGETS,
+        help = "Targets to run (default: all of them)")
+
+    return parser.parse_args()
+
+
+def measure(cmd):
+    """
+    Executes |cmd| and returns its wall-clock time (seconds) and its peak resident set size (KB)
+    """
+    start = time.monotonic()
+    p = subp.Popen(cmd, stdout = subp.DEVNULL, stderr = subp.DEVNULL)
+    _, status, rusage = os.wait4(p.pid, 0)
+    elapsed = time.monotonic() - start
+    p.returncode = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -os.WTERMSIG(status)
+
+    if p.returncode != 0:
+        raise RuntimeError("{0} exited with status {1}".format(" ".join(cmd), p.returncode))
+
+    return elapsed, rusage.ru_maxrss
+
+
+def measure_median(cmd, runs):
+    results = [measure(cmd) for _ in range(runs)]
+    return statistics.median([r[0] for r in results]), max([r[1] for r in results])
+
+
+def run_target(args, target, tmp_dir):
+    target_path = os.path.join(args.targets_dir, target)
+    report_path = os.path.join(tmp_dir, target + '.bin')
+    stats_path = os.path.join(tmp_dir, target + '.json')
+
+    native_time, _ = measure_median([target_path], args.runs)
+    null_time, null_rss = measure_median([args.pin, '-t', os.path.join(args.tool_dir, 'NullTool.so'), '--', target_path], args.runs)
+    memtrace_time, memtrace_rss = measure_median([args.pin, '-t', os.path.join(args.tool_dir, 'MemTrace.so'), '-o', report_path,
+        '--stats', stats_path, '--', target_path], args.runs)
+
+    with open(stats_path) as f:
+        stats = json.load(f)
+    analysis_calls = sum([stats['counters'][counter] for counter in ANALYSIS_COUNTERS])
+
+    return {
+        'target': target,
+        'native_s': native_time,
+        'nulltool_s': null_time,
+        'memtrace_s': memtrace_time,
+        'pin_slowdown': null_time / native_time,
+        'memtrace_slowdown': memtrace_time / native_time,
+        'analysis_slowdown': memtrace_time / null_time,
+        'analysis_calls_per_s': analysis_calls / memtrace_time,
+        'nulltool_peak_rss_mb': null_rss / 1024,
+        'memtrace_peak_rss_mb': memtrace_rss / 1024
+    }
+
+
+def print_results(results):
+    header = "{0:<16} {1:>9} {2:>10} {3:>10} {4:>9} {5:>10} {6:>10} {7:>14} {8:>12} {9:>12}"
+    row = "{0:<16} {1:>9.3f} {2:>10.3f} {3:>10.3f} {4:>8.1f}x {5:>9.1f}x {6:>9.1f}x {7:>14.0f} {8:>12.1f} {9:>12.1f}"
+
+    print(header.format("Target", "Native s", "NullTool s", "MemTrace s", "PIN", "MemTrace", "Analysis", "Calls/s", "NullTool MB", "MemTrace MB"))
+    for r in results:
+        print(row.format(r['target'], r['native_s'], r['nulltool_s'], r['memtrace_s'], r['pin_slowdown'], r['memtrace_slowdown'],
+            r['analysis_slowdown'], r['analysis_calls_per_s'], r['nulltool_peak_rss_mb'], r['memtrace_peak_rss_mb']))
+
+
+def write_csv(results, csv_path):
+    keys = list(results[0].keys())
+    with open(csv_path, 'w') as f:
+        f.write(";".join(keys) + "\n")
+        for r in results:
+            f.write(";".join([str(r[k]) for k in keys]) + "\n")
+
+
+def main():
+    args = parse_args()
+
+    for path in [args.pin, os.path.join(args.tool_dir, 'NullTool.so'), os.path.join(args.tool_dir, 'MemTrace.so')]:
+        if not os.path.exists(path):
+            print("{0} not found. Build the tool first (make tool nulltool)".format(path))
+            exit(1)
+
+    results = list()
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        for target in args.targets:
+            print("Running {0}...".format(target), file = sys.stderr)
+            results.append(run_target(args, target, tmp_dir))
+
+    print_results(results)
+    if args.csv is not None:
+        write_csv(results, args.csv)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,38 @@
+/*
+    Stresses the allocator handlers and the heap shadow memory: blocks of random sizes are continuously
+    allocated, partially initialized, read and freed.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SLOTS 256
+
+int main(int argc, char* argv[]){
+    unsigned iterations = argc > 1 ? strtoul(argv[1], NULL, 0) : 50000;
+    unsigned char* slots[SLOTS] = {0};
+    unsigned long sum = 0;
+    unsigned seed = 1;
+
+    for(unsigned i = 0; i < iterations; ++i){
+        seed = seed * 1103515245 + 12345;
+        unsigned slot = (seed >> 16) % SLOTS;
+        size_t size = 8 + (seed >> 8) % 1024;
+
+        if(slots[slot] != NULL){
+            sum += slots[slot][0];
+            free(slots[slot]);
+        }
+
+        slots[slot] = (unsigned char*) (i % 4 == 0 ? calloc(1, size) : malloc(size));
+        for(size_t j = 0; j < size; j += 16){
+            slots[slot][j] = (unsigned char) (i + j);
+        }
+    }
+
+    for(unsigned i = 0; i < SLOTS; ++i){
+        free(slots[i]);
+    }
+
+    printf("%lu\n", sum);
+    return 0;
+}
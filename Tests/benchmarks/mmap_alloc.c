@@ -0,0 +1,45 @@
+/*
+    Stresses the shadow memories of mmapped areas: large blocks are allocated (by mmap, directly or through malloc),
+    sparsely written and read, and released.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#define BLOCK_SIZE (8 << 20)
+#define PAGE_SIZE 4096
+
+int main(int argc, char* argv[]){
+    unsigned iterations = argc > 1 ? strtoul(argv[1], NULL, 0) : 64;
+    unsigned long sum = 0;
+
+    for(unsigned i = 0; i < iterations; ++i){
+        unsigned char* block;
+        if(i % 2 == 0){
+            block = (unsigned char*) mmap(NULL, BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(block == MAP_FAILED)
+                return 1;
+        }
+        else{
+            // Large enough to be served by mmap inside malloc
+            block = (unsigned char*) malloc(BLOCK_SIZE);
+            if(block == NULL)
+                return 1;
+        }
+
+        for(size_t offset = 0; offset < BLOCK_SIZE; offset += PAGE_SIZE){
+            block[offset] = (unsigned char) (offset >> 12);
+        }
+        for(size_t offset = 0; offset < BLOCK_SIZE; offset += PAGE_SIZE){
+            sum += block[offset];
+        }
+
+        if(i % 2 == 0)
+            munmap(block, BLOCK_SIZE);
+        else
+            free(block);
+    }
+
+    printf("%lu\n", sum);
+    return 0;
+}
@@ -0,0 +1,44 @@
+/*
+    Stresses the propagation of pending uninitialized reads through registers: values partially loaded
+    from uninitialized memory flow through long chains of arithmetic operations before being used.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHAIN_LENGTH 64
+
+static __attribute__((noinline)) unsigned long chain(const volatile unsigned long* values){
+    unsigned long a = values[0];
+    unsigned long b = values[1];
+    unsigned long c = values[2];
+
+    for(unsigned i = 0; i < CHAIN_LENGTH; ++i){
+        a += b ^ i;
+        b = (b << 1) | (c >> 63);
+        c -= a;
+    }
+
+    return a ^ b ^ c;
+}
+
+static __attribute__((noinline)) unsigned long step(unsigned i){
+    // Only part of the array is initialized: the remaining values are pending uninitialized reads
+    volatile unsigned long values[4];
+    values[i % 4] = i;
+
+    return chain(values);
+}
+
+int main(int argc, char* argv[]){
+    unsigned iterations = argc > 1 ? strtoul(argv[1], NULL, 0) : 20000;
+    unsigned long sum = 0;
+
+    for(unsigned i = 0; i < iterations; ++i){
+        // Using the result in a branch makes it a direct usage of the propagated values
+        if(step(i) & 1)
+            ++sum;
+    }
+
+    printf("%lu\n", sum);
+    return 0;
+}
@@ -0,0 +1,33 @@
+/*
+    Stresses wide (SIMD) accesses: the string and memory routines of the C library are implemented with
+    vector instructions, which often read past the end of the initialized part of a buffer.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BUFFER_SIZE 4096
+
+int main(int argc, char* argv[]){
+    unsigned iterations = argc > 1 ? strtoul(argv[1], NULL, 0) : 20000;
+    char* src = (char*) malloc(BUFFER_SIZE);
+    char* dst = (char*) malloc(BUFFER_SIZE);
+    unsigned long sum = 0;
+
+    for(unsigned i = 0; i < iterations; ++i){
+        size_t len = 1 + (i * 37) % (BUFFER_SIZE - 1);
+        memset(src, 'a' + i % 26, len);
+        src[len - 1] = '\0';
+
+        strcpy(dst, src);
+        sum += strlen(dst);
+        memcpy(src, dst, len);
+        sum += memcmp(src, dst, len) == 0;
+        sum += strchr(dst, 'z') != NULL;
+    }
+
+    free(src);
+    free(dst);
+    printf("%lu\n", sum);
+    return 0;
+}
@@ -0,0 +1,36 @@
+/*
+    Stresses the stack shadow memory: every call allocates a frame which is partially written and read,
+    and every return resets the shadow memory of the freed frame.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+
+static __attribute__((noinline)) unsigned long recurse(unsigned depth, unsigned long seed){
+    volatile unsigned long frame[16];
+
+    for(unsigned i = 0; i < 16; i += 2){
+        frame[i] = seed + i;
+    }
+
+    if(depth == 0)
+        return frame[0];
+
+    unsigned long ret = recurse(depth - 1, seed * 31 + depth);
+    for(unsigned i = 0; i < 16; i += 2){
+        ret += frame[i];
+    }
+
+    return ret;
+}
+
+int main(int argc, char* argv[]){
+    unsigned iterations = argc > 1 ? strtoul(argv[1], NULL, 0) : 2000;
+    unsigned long sum = 0;
+
+    for(unsigned i = 0; i < iterations; ++i){
+        sum += recurse(200, i);
+    }
+
+    printf("%lu\n", sum);
+    return 0;
+}
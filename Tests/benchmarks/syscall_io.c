@@ -0,0 +1,44 @@
+/*
+    Stresses system call handlers: small reads and writes on a pipe and on a temporary file, together with
+    system calls writing structures into user memory.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+int main(int argc, char* argv[]){
+    unsigned iterations = argc > 1 ? strtoul(argv[1], NULL, 0) : 20000;
+    char path[] = "/tmp/memtrace_benchXXXXXX";
+    int fd = mkstemp(path);
+    int fds[2];
+    char buffer[256];
+    unsigned long sum = 0;
+
+    if(fd < 0 || pipe(fds) != 0)
+        return 1;
+    unlink(path);
+
+    for(unsigned i = 0; i < iterations; ++i){
+        buffer[0] = (char) i;
+        if(write(fds[1], buffer, 64) != 64 || read(fds[0], buffer, 64) != 64)
+            return 1;
+
+        if(pwrite(fd, buffer, sizeof(buffer), (i % 64) * sizeof(buffer)) < 0 || pread(fd, buffer, sizeof(buffer), 0) < 0)
+            return 1;
+
+        struct stat st;
+        struct timeval tv;
+        fstat(fd, &st);
+        gettimeofday(&tv, NULL);
+        sum += st.st_size + buffer[0] + (tv.tv_usec & 1);
+    }
+
+    close(fd);
+    close(fds[0]);
+    close(fds[1]);
+    printf("%lu\n", sum);
+    return 0;
+}
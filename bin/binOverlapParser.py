@@ -7,6 +7,9 @@ import os
 sys.path.append(os.path.join(os.path.dirname(sys.path[0]), "python_modules"))
 
 import stringFilter as sf
+import nativeReports
+import mmap
+import struct
 
 from collections import deque
 from binascii import b2a_hex
@@ -18,6 +21,9 @@ from maSet import remove_useless_writes, check_for_overlapping_writes
 class ParseError(Exception):
     def __init__(self, file, message="Error while parsing"):
         super().__init__(message)
+        # Errors raised while parsing memory mapped reports have no file position to show
+        if file is None:
+            return
         print("Error @ byte " + str(file.tell()))
         try:
             file.seek(-6, 1)
@@ -28,6 +34,37 @@ class ParseError(Exception):
         print("            |")
 
 
+# Binary report format version 4 (see src/ReportFormat.h)
+REPORT_MAGIC = b"MTREPORT"
+REPORT_VERSION = 4
+
+HEADER_RECORD = struct.Struct("<8sIIQII14Q")
+IMAGE_RECORD = struct.Struct("<QII")
+INSTRUCTION_RECORD = struct.Struct("<QQII")
+ACCESS_SET_RECORD = struct.Struct("<QIIQ")
+ENTRY_RECORD = struct.Struct("<IIqqIIQQ")
+INTERVAL_RECORD = struct.Struct("<II")
+
+# Flags of the report (field |flags| of the header)
+HEADER_TRUNCATED = 1
+
+class Section(object):
+    ENTRIES = 0
+    INTERVALS = 1
+    FULL_OVERLAPS = 2
+    PARTIAL_OVERLAPS = 3
+    INSTRUCTIONS = 4
+    IMAGES = 5
+    STRINGS = 6
+    SECTIONS_NUM = 7
+
+class EntryFlags(object):
+    UNINITIALIZED_READ = 1
+    WRITE = 1 << 1
+    STACK = 1 << 2
+    PARTIAL_OVERLAP = 1 << 3
+
+
 class ReportWriter(object):
     file = None
 
@@ -244,11 +281,143 @@ def parse_partial_overlap(f, reg_size, ignore_if_no_overlapping_write, ignored_a
     return None
 
 
+class ReportV4(object):
+    def __init__(self, buf):
+        self.buf = buf
+        if len(buf) < HEADER_RECORD.size:
+            raise ParseError(None, "Report too short to contain a header")
+
+        header = HEADER_RECORD.unpack_from(buf, 0)
+        version = header[1]
+        if version != REPORT_VERSION:
+            raise ParseError(None, "Unsupported report version {0}".format(version))
+
+        self.stack_base = header[3]
+        # The analysis has been stopped because an execution budget was exhausted
+        self.truncated = (header[4] & HEADER_TRUNCATED) != 0
+        self.sections = [(header[6 + 2 * i], header[7 + 2 * i]) for i in range(Section.SECTIONS_NUM)]
+
+        for section, (offset, count) in enumerate(self.sections):
+            size = count if section == Section.STRINGS else count * self.record_size(section)
+            if offset + size > len(buf):
+                raise ParseError(None, "Section {0} exceeds the report size".format(section))
+
+        # Decode the instruction table only once: entries refer to it by index
+        strings_offset = self.sections[Section.STRINGS][0]
+        offset, count = self.sections[Section.IMAGES]
+        self.images = []
+        for i in range(count):
+            base_addr, name_offset, _ = IMAGE_RECORD.unpack_from(buf, offset + i * IMAGE_RECORD.size)
+            self.images.append((self.get_string(strings_offset + name_offset), hex(base_addr)))
+
+        offset, count = self.sections[Section.INSTRUCTIONS]
+        self.instructions = []
+        for i in range(count):
+            ip, actual_ip, disasm_offset, _ = INSTRUCTION_RECORD.unpack_from(buf, offset + i * INSTRUCTION_RECORD.size)
+            self.instructions.append((hex(ip), hex(actual_ip), self.get_string(strings_offset + disasm_offset)))
+
+    def record_size(self, section):
+        return {
+            Section.ENTRIES: ENTRY_RECORD.size,
+            Section.INTERVALS: INTERVAL_RECORD.size,
+            Section.FULL_OVERLAPS: ACCESS_SET_RECORD.size,
+            Section.PARTIAL_OVERLAPS: ACCESS_SET_RECORD.size,
+            Section.INSTRUCTIONS: INSTRUCTION_RECORD.size,
+            Section.IMAGES: IMAGE_RECORD.size
+        }[section]
+
+    def get_string(self, offset):
+        end = self.buf.find(b"\x00", offset)
+        if end < 0:
+            raise ParseError(None, "Unterminated string in string table")
+        return self.buf[offset:end].decode("utf-8")
+
+    def access_sets(self, section):
+        offset, count = self.sections[section]
+        for i in range(count):
+            addr, size, entries_count, first_entry = ACCESS_SET_RECORD.unpack_from(self.buf, offset + i * ACCESS_SET_RECORD.size)
+            yield (AccessIndex(hex(addr), size), range(first_entry, first_entry + entries_count))
+
+    def entry(self, index, exec_order):
+        entries_offset = self.sections[Section.ENTRIES][0]
+        intervals_offset = self.sections[Section.INTERVALS][0]
+        instruction_index, access_size, sp_offset, bp_offset, flags, intervals_count, first_interval, _ = \
+            ENTRY_RECORD.unpack_from(self.buf, entries_offset + index * ENTRY_RECORD.size)
+        ip, actual_ip, disasm = self.instructions[instruction_index]
+
+        uninitialized_intervals = deque()
+        for i in range(first_interval, first_interval + intervals_count):
+            uninitialized_intervals.append(INTERVAL_RECORD.unpack_from(self.buf, intervals_offset + i * INTERVAL_RECORD.size))
+
+        access_type = AccessType.WRITE if flags & EntryFlags.WRITE else AccessType.READ
+        mem_type = MemType.STACK if flags & EntryFlags.STACK else MemType.HEAP
+        is_uninitialized_read = bool(flags & EntryFlags.UNINITIALIZED_READ)
+        is_partial_overlap = bool(flags & EntryFlags.PARTIAL_OVERLAP)
+
+        return MemoryAccess(exec_order, ip, actual_ip, sp_offset, bp_offset, access_type, access_size, disasm, is_uninitialized_read, uninitialized_intervals, mem_type, is_partial_overlap)
+
+
+def parse_v2(buf, ignore_if_no_overlapping_write, ignored_addresses)->ParseResult:
+    ret = ParseResult()
+    report = ReportV4(buf)
+
+    # Order images base addresses in the same way as the legacy parser
+    load_bases = list(set(report.images))
+    load_bases.sort(key = lambda x: x[1])
+    ret.load_bases = load_bases
+    ret.stack_base = hex(report.stack_base)
+
+    for ai, entries in report.access_sets(Section.FULL_OVERLAPS):
+        overlaps = deque()
+        for exec_order, index in enumerate(entries):
+            overlaps.append(report.entry(index, exec_order))
+
+        if len(overlaps) > 0:
+            ret.full_overlaps.append((ai, overlaps))
+
+    for ai, entries in report.access_sets(Section.PARTIAL_OVERLAPS):
+        exec_order = 0
+        ignored = 0
+        overlaps = deque()
+
+        for index in entries:
+            entry = report.entry(index, exec_order)
+            if entry.isUninitializedRead:
+                if ignore_if_no_overlapping_write:
+                    has_overlapping_writes = check_for_overlapping_writes(overlaps, entry)
+                    if not has_overlapping_writes:
+                        continue
+
+                if int(entry.actualIp, 16) in ignored_addresses:
+                    print(entry.actualIp, " ignored")
+                    ignored += 1
+                    continue
+
+            entry.accessedAddress = ai
+            overlaps.append(entry)
+            exec_order += 1
+
+        if ignore_if_no_overlapping_write or ignored > 0:
+            overlaps = remove_useless_writes(overlaps)
+
+        if len(overlaps) > 0:
+            ret.partial_overlaps.append((ai, overlaps))
+
+    return ret
+
+
 def parse(ignore_if_no_overlapping_write: bool = True, bin_report_dir = ".", ignored_addresses = set())->ParseResult:
     ret = ParseResult()
 
     bin_report_path = os.path.join(bin_report_dir, "overlaps.bin")
     with open(bin_report_path, "rb") as f:
+        # Reports written by the current version of the tool start with a magic number.
+        # Reports without it are parsed with the legacy (version 1) textual-binary parser.
+        if f.read(len(REPORT_MAGIC)) == REPORT_MAGIC:
+            with mmap.mmap(f.fileno(), 0, access = mmap.ACCESS_READ) as buf:
+                return parse_v2(buf, ignore_if_no_overlapping_write, ignored_addresses)
+        f.seek(0, 0)
+
         read_bytes = b"\xff"
         while(read_bytes != b"\x00\x00\x00\x00"):
             while(read_bytes != b"\x00"):
@@ -358,6 +527,11 @@ def main():
     ignore_if_no_overlapping_write = args.ignore_if_no_overlap
     apply_string_filter = not args.disable_string_filter
     ignored_addresses = set(args.ignored_addresses)
+
+    # Use the native parser if it has been built
+    if nativeReports.parse(bin_report_dir, ignore_if_no_overlapping_write, ignored_addresses, apply_string_filter):
+        return
+
     fo = FullOverlapsWriter()
     po = PartialOverlapsWriter()
 
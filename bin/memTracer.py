@@ -16,6 +16,7 @@ from psutil import Process, STATUS_RUNNING
 from collections import deque
 from typing import Deque
 from merge_reports import merge_reports
+import nativeDispatcher
 
 class MissingExecutableError(Exception):
     pass
@@ -295,6 +296,25 @@ def parse_args(args):
         dest = "store_tracer_out"
     )
 
+    parser.add_argument("--tracer-timeout",
+        default = 300,
+        help =  "Specify the number of seconds after which a tracer process is considered stuck and terminated. "
+                "This is only enforced by the native dispatcher (bin/dispatcher): when it is used, tracer processes also stop the analysis and write "
+                "their report after 90%% of this time (reports stopped in this way are never stored in the cache, see --cache-dir). Otherwise, tracer processes "
+                "are never terminated and their analysis is not bounded. If 0, tracer processes are never terminated. (default: 300)",
+        dest = "tracer_timeout",
+        type = int
+    )
+
+    parser.add_argument("--cache-dir",
+        default = None,
+        help =  "Path of a directory used to cache the binary reports generated by the tracer. Every report is identified by the build-id of "
+                "the executable, the content of the input, the command line arguments, the environment and the tool options and version. "
+                "If an execution with the same identifier has already been traced, its report is reused instead of running the tracer again. "
+                "The same directory can be shared among different analyses (e.g. when re-executing the tracer with --no-fuzzing). (default: None)",
+        dest = "cache_dir"
+    )
+
     parser.add_argument("--dict",
         default = None,
         help =  "Path of the dictionary to be used by the fuzzer in order to produce new inputs",
@@ -323,6 +343,21 @@ def parse_args(args):
     return ret
 
 
+# Options used to make the launcher reuse the reports already stored in the cache directory (if any)
+def cache_opts(args):
+    if args.cache_dir is None:
+        return []
+    return ["--cache-dir", os.path.realpath(args.cache_dir)]
+
+
+# Options used to make the tracer write its report before the native dispatcher terminates it as stuck.
+# Without the native dispatcher tracer processes are never terminated, so their analysis is not bounded either.
+def budget_opts(args, dispatcher):
+    if dispatcher is None or args.tracer_timeout <= 0:
+        return []
+    return ["--max-time", str(max(1, args.tracer_timeout * 9 // 10))]
+
+
 def launchTracer(exec_cmd, args, fuzz_int_event: t.Event, fuzzer_error_event: t.Event = None):
 
     def remove_terminated_processes(proc_list: Deque[subp.Popen], strikes: Deque[int]):
@@ -528,7 +563,6 @@ def launchTracer(exec_cmd, args, fuzz_int_event: t.Event, fuzzer_error_event: t.
     tracer_out = os.path.join(fuzz_dir, args.tracer_out)
     inputs_dir = os.path.join(fuzz_out, "Main", "queue")
     launcher_path = os.path.join(sys.path[0], "launcher")
-    tracer_cmd = [launcher_path, "-o", "./overlaps.bin", "-u", args.heuristic_status, "--keep-ld", args.keep_ld, "--"] + exec_cmd[:1]
     traced_inputs = set()
 
     # If this expression evaluates to True, it means the user used --no-fuzzing option, but the tracer output folder
@@ -598,27 +632,49 @@ def launchTracer(exec_cmd, args, fuzz_int_event: t.Event, fuzzer_error_event: t.
             os.mkdir(os.path.join(environ_dir, directory))
             os.mkdir(os.path.join(private_cpy_dir, directory))
 
+    # If available, the native dispatcher is notified by the kernel about new inputs and terminated tracer processes,
+    # so that neither the inputs directories nor the processes need to be polled
+    dispatcher = None
+    if nativeDispatcher.is_available():
+        watched_dirs = dict()
+        for directory in instance_names:
+            watched_dirs[directory] = [os.path.join(fuzz_out, directory, "queue"), os.path.join(fuzz_out, directory, "crashes")]
+        dispatcher = nativeDispatcher.Dispatcher(args.processes, args.tracer_timeout, watched_dirs)
+        if not dispatcher.start():
+            print("[Tracer Thread] Native dispatcher not supported. Falling back to polling")
+            dispatcher = None
+    tracer_cmd = [launcher_path, "-o", "./overlaps.bin", "-u", args.heuristic_status, "--keep-ld", args.keep_ld] + cache_opts(args) + budget_opts(args, dispatcher) + ["--"] + exec_cmd[:1]
+    # Inputs notified by the dispatcher
+    found_inputs = set()
+
     pat = r"sync"
     # Loop interrupts if and only if there are no new_inputs and the fuzzer has been interrupted
     while new_inputs_found or not fuzz_int_event.is_set():
-        processes = remove_terminated_processes(processes, strikes)
         # This set will contain tuples of type (<Instance_Name>, <Input_File_Name>)
         inputs = set()
-        for directory in instance_names:
-            inputs_dirs = {os.path.join(fuzz_out, directory, "queue"), os.path.join(fuzz_out, directory, "crashes")}
-            for inputs_dir in inputs_dirs:
-                for f in os.scandir(inputs_dir):
-                    res = re.search(pat, f.name)
-                    # If the file contains "sync", it has been imported from other parallel instances, and it is identical
-                    # to an input file generated by that instance. Avoid executing it twice.
-                    if res is None:
-                        path = os.path.join(inputs_dir, f.name)
-                        inputs.add((directory, path))
+        if dispatcher is not None:
+            found_inputs.update(dispatcher.wait_inputs(timeout = 1))
+            for directory, path in found_inputs:
+                # See below
+                if re.search(pat, os.path.basename(path)) is None:
+                    inputs.add((directory, path))
+        else:
+            processes = remove_terminated_processes(processes, strikes)
+            for directory in instance_names:
+                inputs_dirs = {os.path.join(fuzz_out, directory, "queue"), os.path.join(fuzz_out, directory, "crashes")}
+                for inputs_dir in inputs_dirs:
+                    for f in os.scandir(inputs_dir):
+                        res = re.search(pat, f.name)
+                        # If the file contains "sync", it has been imported from other parallel instances, and it is identical
+                        # to an input file generated by that instance. Avoid executing it twice.
+                        if res is None:
+                            path = os.path.join(inputs_dir, f.name)
+                            inputs.add((directory, path))
 
         new_inputs = inputs.difference(traced_inputs)
         if(len(new_inputs) == 0):
             new_inputs_found = False
-            if fuzz_int_event.is_set():
+            if fuzz_int_event.is_set() or dispatcher is not None:
                 continue
             print("[Tracer Thread] Waiting the fuzzer for new inputs")
             time.sleep(10)
@@ -638,7 +694,7 @@ def launchTracer(exec_cmd, args, fuzz_int_event: t.Event, fuzzer_error_event: t.
 
             full_cmd = list(map(lambda x: x.encode('utf-8'), tracer_cmd)) 
             
-            if len(processes) == args.processes:
+            if dispatcher is None and len(processes) == args.processes:
                 processes = wait_process_termination(processes, strikes)
 
             argv_file_path = os.path.join(input_folder, "argv")
@@ -707,21 +763,21 @@ def launchTracer(exec_cmd, args, fuzz_int_event: t.Event, fuzzer_error_event: t.
             # Set stdin to be either the input file or an empty file, according to the flags used to launch the tool
             if args.no_fuzzing:
                 if args.stdin:
-                    tracer_stdin = open(input_cpy_path, "rb")
+                    tracer_stdin_path = input_cpy_path
                 else:
                     empty_file = open("empty_file", "w")
                     empty_file.close()
-                    tracer_stdin = open("empty_file", "rb")
+                    tracer_stdin_path = os.path.realpath("empty_file")
             else:
                 # If there isn't any fuzzed input file, use the generated file as stdin
                 if len(input_path_indices) == 0:
-                    tracer_stdin = open(input_cpy_path, "rb")
+                    tracer_stdin_path = input_cpy_path
                 # otherwise, set stdin to an empty file, so that if the program tries to read from that
                 # it won't stuck waiting for input
                 else:
                     empty_file = open("empty_file", "w")
                     empty_file.close()
-                    tracer_stdin = open("empty_file", "rb")
+                    tracer_stdin_path = os.path.realpath("empty_file")
 
             # Store the exact command used to launch the execution of the analyzed program
             #print("[Tracer Thread] FULL_CMD: ", full_cmd)
@@ -730,6 +786,14 @@ def launchTracer(exec_cmd, args, fuzz_int_event: t.Event, fuzzer_error_event: t.
                     f.write(cmd_part)
                     f.write(b' ')
 
+            if dispatcher is not None:
+                output_file_path = os.path.join(input_folder, "output") if args.store_tracer_out else None
+                dispatcher.submit(full_cmd, env_file_path, tracer_stdin_path, output_file_path)
+                print("[Tracer Thread] {0} has been queued".format(el[1]))
+                print()
+                continue
+
+            tracer_stdin = open(tracer_stdin_path, "rb")
             if args.store_tracer_out:
                 output_file_path = os.path.join(input_folder, "output")
                 with open(output_file_path, "w") as out:
@@ -765,8 +829,12 @@ def launchTracer(exec_cmd, args, fuzz_int_event: t.Event, fuzzer_error_event: t.
         if fuzzer_error_event.is_set():
             print("[Tracer Thread] Tracer thread stopped due to fuzzer error")
             return
-        time.sleep(10)
+        if dispatcher is None:
+            time.sleep(10)
 
+    if dispatcher is not None:
+        print("[Tracer Thread] Waiting for the queued tracer processes to terminate")
+        dispatcher.close()
     while len(processes) > 0:
         processes = wait_process_termination(processes, strikes)
     print("[Tracer Thread] Generating textual report...")
@@ -1052,7 +1120,7 @@ def main():
         if not os.path.exists(tracer_out):
             raise IOError("Folder {0} must exist".format(tracer_out))
         launcher_path = os.path.join(sys.path[0], "launcher")
-        tracer_cmd = [launcher_path, "-o", os.path.join(tracer_out, "overlaps.bin"), "-u", args.heuristic_status, "--"] + executable
+        tracer_cmd = [launcher_path, "-o", os.path.join(tracer_out, "overlaps.bin"), "-u", args.heuristic_status] + cache_opts(args) + ["--"] + executable
         proc = subp.Popen(tracer_cmd) #, stdout = subp.DEVNULL, stderr = subp.DEVNULL)
         proc.wait()
         return
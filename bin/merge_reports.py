@@ -9,6 +9,7 @@ from collections import deque, defaultdict
 from typing import Deque, Tuple, Dict, List, Set
 from binOverlapParser import parse, ParseError, print_table_header, print_table_footer, PartialOverlapsWriter
 import stringFilter as sf
+import nativeReports
 from parsedData import MemoryAccess, ParseResult, AccessType, MemType
 from instructionAddress import InstructionAddress
 from maSet import MASet, remove_useless_writes
@@ -20,63 +21,34 @@ class ArgumentError(Exception):
 
 def merge_reports(tracer_out_path: str, ignored_addresses: Dict[str, Set[int]] = dict(), apply_string_filter: bool = True, report_unique_access_sets = False, ignore_if_no_overlap = True):
 
-    def merge_ma_sets(accumulator: Deque[MASet], element: MASet):
-
-        # Returns True if 2 ma_sets are to be considered equal
-        def compare_ma_sets(accumulator_el: MASet):
-            acc_el_ma_set = accumulator_el.set
-            el_ma_set = element.set
-            if len(acc_el_ma_set) != len(el_ma_set) or not accumulator_el.compareMemLocation(element):
-                return False
-            
-            # Get the list of tuples (name, address) of loaded libraries for the accumulator element
-            # Note that the accumulator element may have more than 1 origin at this time. However,
-            # the reported set comes from the first origin. Sets from other origins may be identical,
-            # unless they may have different addresses due to ASLR or different library load address.
-            # This means we need to use the load_bases of the first origins to compare offsets.
-            acc_el_load_bases = load_bases[accumulator_el.origins[0]]
-
-            res = True
-            # We already know el_ma_set and acc_el_ma_set have the same length.
-            # Since we are using a deque, it is less expensive to pop and re-append 
-            # elements circularly than performing random access.
-            for _  in range(len(el_ma_set)):
-                el_ma = el_ma_set.popleft()
-                acc_el_ma = acc_el_ma_set.popleft()
-                el_ma_set.append(el_ma)
-                acc_el_ma_set.append(acc_el_ma)
-
-                # If we have already found that the sets are not identical, it is useless to
-                # try and keep comparing them. However, we need to complete the whole loop,
-                # as we must leave the deques |el_ma_set| and |acc_el_ma_set| untouched.
-                if res:
-                    el_load_base = int(findLib(el_ma.actualIp, element_load_bases)[1], 16)
-                    acc_el_load_base = int(findLib(acc_el_ma.actualIp, acc_el_load_bases)[1], 16)
-
-                    # Compare MemoryAccess object to check ma_sets equality
-                    if not el_ma.compare(acc_el_ma, el_load_base, acc_el_load_base):
-                        res = False
-                
-            return res
-            
-
-        # |merge_ma_sets| beginning
-
-        # Note that the element comes from |tmp_partial_overlaps|, which has 1 origin for each entry
-        element_origin = element.origins[0] 
-        element_load_bases = load_bases[element_origin]
-        filtered_acc = list(filter(compare_ma_sets, accumulator))
-
-        # If there are no elements with the same ma_set as |element|, insert |element| itself
-        if len(filtered_acc) == 0:
-            accumulator.append(element)
-        # If there's at least 1, we are sure there's exactly one (as a consequence of the applied reduce
-        # that uses this function)
-        else:
-            maSet = filtered_acc[0]
-            maSet.addOrigins(element.origins)
+    # Use the native merger if it has been built. It produces the same textual reports, but it is much faster
+    # when merging the results of a fuzzing campaign.
+    if nativeReports.merge(tracer_out_path, ignored_addresses, apply_string_filter, report_unique_access_sets, ignore_if_no_overlap):
+        return
 
-        return accumulator
+    def fingerprint(maSet: MASet, lib_offsets: Dict[str, int], cur_load_bases: List[Tuple[str, str]]) -> Tuple:
+        '''
+        Returns a canonical representation of |maSet|, independent of the address libraries have been loaded at.
+        2 MASets are considered identical (and merged) if and only if they have the same fingerprint.
+        |lib_offsets| caches the offset of actual ips from the base address of their library.
+        '''
+        accesses = []
+        for ma in maSet.set:
+            if ma.actualIp not in lib_offsets:
+                lib_offsets[ma.actualIp] = int(ma.actualIp, 16) - int(findLib(ma.actualIp, cur_load_bases)[1], 16)
+
+            accesses.append((
+                ma.ip,
+                ma.accessType,
+                ma.accessSize,
+                ma.isUninitializedRead,
+                tuple(ma.uninitializedIntervals),
+                ma.memType,
+                ma.isPartialOverlap,
+                lib_offsets[ma.actualIp]
+            ))
+
+        return (maSet.memType, maSet.memOffset, maSet.size, tuple(accesses))
 
 
     def remove_ignored_addresses(maSet: MASet) -> Deque[MemoryAccess]:
@@ -124,10 +96,10 @@ def merge_reports(tracer_out_path: str, ignored_addresses: Dict[str, Set[int]] =
     stack_bases: Dict[str, str] = dict()
     partial_overlaps: Dict[InstructionAddress, Deque[MASet]] = dict()
 
-    # Although |tmp_partial_overlaps| has the same type of |partial_overlaps|, this is thought to contain MASets
-    # containing, in turns, only 1 input reference (origin). Afterwards, this will be processed to merge all MASets having the same set of 
-    # MemoryAccess objects into 1 single MASet containing all the identical origins.
-    tmp_partial_overlaps: Dict[InstructionAddress, Deque[MASet]] = dict()
+    # Hash index of the MASets already inserted in |partial_overlaps|, by instruction and fingerprint.
+    # MASets identical to an indexed one are merged into it by simply adding their origin, so that merging
+    # takes linear time in the number of sets.
+    merged_sets: Dict[Tuple[InstructionAddress, Tuple], MASet] = dict()
     for instance in os.listdir(tracer_out_path):
         instance_path = os.path.join(tracer_out_path, instance)
         for input_dir in os.listdir(instance_path):
@@ -151,6 +123,7 @@ def merge_reports(tracer_out_path: str, ignored_addresses: Dict[str, Set[int]] =
             cur_stack_base = parse_res.stack_base
             overlaps = parse_res.partial_overlaps
             input_ref = os.path.join(instance, input_dir)
+            lib_offsets: Dict[str, int] = dict()
 
             # Fill partial_overlaps, load_bases and stack_bases
             for ia, ma_set in overlaps:
@@ -184,14 +157,18 @@ def merge_reports(tracer_out_path: str, ignored_addresses: Dict[str, Set[int]] =
                                 heap_name, mem_base = findLib(addr, cur_load_bases)
                                 mem_base = int(mem_base, 16)
                         newSet.setMemLocation(ma.accessedAddress, ma.memType, mem_base, heap_name)
-                        
-                        if instrAddr in tmp_partial_overlaps:
-                            maSet = tmp_partial_overlaps[instrAddr]
-                            maSet.append(newSet)
+
+                        key = (instrAddr, fingerprint(newSet, lib_offsets, cur_load_bases))
+                        if key in merged_sets:
+                            merged_sets[key].addOrigins(newSet.origins)
+                        elif instrAddr in partial_overlaps:
+                            partial_overlaps[instrAddr].append(newSet)
+                            merged_sets[key] = newSet
                         else:
                             newMASets = deque()
                             newMASets.append(newSet)
-                            tmp_partial_overlaps[instrAddr] = newMASets
+                            partial_overlaps[instrAddr] = newMASets
+                            merged_sets[key] = newSet
 
                         # Remove the read access from |writes| (cost O(1))
                         writes.pop()
@@ -199,16 +176,6 @@ def merge_reports(tracer_out_path: str, ignored_addresses: Dict[str, Set[int]] =
             load_bases.update([(input_ref, cur_load_bases)])
             stack_bases.update([(input_ref, cur_stack_base)])
 
-    # Sort partial_overlaps by AccessIndex (increasing address, decreasing access size)
-    # sorted_partial_overlaps = sorted(tmp_partial_overlaps.items(), key=lambda x: x[0])
-
-    print("Starting merging sets...")
-
-    for ia, access_set in tmp_partial_overlaps.items():
-        initial = partial_overlaps[ia] if ia in partial_overlaps else deque()
-        ma_sets = reduce(merge_ma_sets, access_set, initial)
-        partial_overlaps[ia] = ma_sets
-
     if len(ignored_addresses) > 0:
         print("Removing ignored addresses...")
 
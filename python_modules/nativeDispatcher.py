@@ -0,0 +1,87 @@
+import os
+import select
+import subprocess as subp
+from typing import Dict, List, Set, Tuple
+
+DISPATCHER_PATH = os.path.realpath(os.path.join(os.path.dirname(__file__), "..", "bin", "dispatcher"))
+
+
+def is_available() -> bool:
+    return os.path.isfile(DISPATCHER_PATH) and os.access(DISPATCHER_PATH, os.X_OK)
+
+
+def convert_to_bytes(el) -> bytes:
+    try:
+        return el.encode('utf-8')
+    except AttributeError:
+        return el
+
+
+class Dispatcher(object):
+    '''
+    Wrapper of the native dispatcher (src/tracerDispatcher.cpp), which watches the fuzzer's output directories
+    through inotify and runs the tracer processes on a bounded pool, without polling.
+    '''
+
+    def __init__(self, processes: int, timeout: int, watched_dirs: Dict[str, List[str]]):
+        self.cmd = [DISPATCHER_PATH, "-j", str(processes), "-t", str(timeout)]
+        for instance, dirs in watched_dirs.items():
+            for directory in dirs:
+                self.cmd.extend(["--watch", instance, directory])
+        self.proc = None
+        self.buffer = b""
+
+    def start(self) -> bool:
+        '''
+        Launches the dispatcher. Returns False if it could not be started (e.g. the kernel does not support pidfds),
+        in which case the caller should fall back to the python implementation.
+        '''
+        try:
+            self.proc = subp.Popen(self.cmd, stdin = subp.PIPE, stdout = subp.PIPE, bufsize = 0)
+        except OSError:
+            return False
+
+        if self.proc.stdout.readline() != b"READY\n":
+            self.proc.wait()
+            return False
+
+        return True
+
+    def wait_inputs(self, timeout: float) -> Set[Tuple[str, str]]:
+        '''
+        Returns the set of tuples (<Instance_Name>, <Input_File_Path>) notified by the dispatcher, waiting at most
+        |timeout| seconds for the first one.
+        '''
+        ret = set()
+        fd = self.proc.stdout.fileno()
+        ready, _, _ = select.select([fd], [], [], timeout)
+        # Only consume what is already available
+        while len(ready) > 0:
+            data = os.read(fd, 65536)
+            if not data:
+                break
+            self.buffer += data
+            ready, _, _ = select.select([fd], [], [], 0)
+
+        lines = self.buffer.split(b"\n")
+        self.buffer = lines.pop()
+        for line in lines:
+            fields = line.decode('utf-8', errors = 'surrogateescape').split('\t', 2)
+            if len(fields) == 3 and fields[0] == "INPUT":
+                ret.add((fields[1], fields[2]))
+
+        return ret
+
+    def submit(self, cmd: List, env_file_path: str, stdin_path: str, output_path: str = None):
+        '''Queues the execution of |cmd|. The environment is read from |env_file_path| (one KEY=VALUE pair per line).'''
+        fields = [str(len(cmd)), stdin_path, output_path if output_path is not None else "", env_file_path] + cmd
+        self.proc.stdin.write(b"".join(convert_to_bytes(field) + b"\0" for field in fields))
+        self.proc.stdin.flush()
+
+    def close(self):
+        '''Waits for the termination of every submitted job'''
+        self.proc.stdin.close()
+        # Notifications sent after the last call to |wait_inputs| are discarded
+        self.proc.stdout.read()
+        self.proc.stdout.close()
+        self.proc.wait()
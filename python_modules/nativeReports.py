@@ -0,0 +1,64 @@
+import os
+import subprocess as subp
+from typing import Dict, Set, Iterable
+
+# Exit code used by the native parser when a report has been written with the legacy format
+EXIT_LEGACY_REPORT = 2
+
+REPORT_PARSER_PATH = os.path.realpath(os.path.join(os.path.dirname(__file__), "..", "bin", "reportParser"))
+
+
+def is_available() -> bool:
+    return os.path.isfile(REPORT_PARSER_PATH) and os.access(REPORT_PARSER_PATH, os.X_OK)
+
+
+def run(args) -> bool:
+    '''
+    Runs the native report parser (src/reportParser) with the given arguments.
+    Returns True if the textual reports have been created, False if the caller should fall back
+    to the python implementation (the parser has not been built, or some report has been written
+    with the legacy format).
+    '''
+    if not is_available():
+        return False
+
+    try:
+        res = subp.run([REPORT_PARSER_PATH] + args)
+    except OSError:
+        return False
+
+    if res.returncode == EXIT_LEGACY_REPORT:
+        print("Legacy report format detected. Falling back to the python parser")
+
+    return res.returncode == 0
+
+
+def parse(bin_report_dir: str, ignore_if_no_overlapping_write: bool = True, ignored_addresses: Iterable[int] = set(), apply_string_filter: bool = True) -> bool:
+    '''Same as the main of bin/binOverlapParser.py'''
+    args = ["parse", "-d", bin_report_dir]
+    if not ignore_if_no_overlapping_write:
+        args.append("-a")
+    if not apply_string_filter:
+        args.append("--disable-string-filter")
+    for addr in ignored_addresses:
+        args.extend(["-i", hex(addr)])
+
+    return run(args)
+
+
+def merge(tracer_out_path: str, ignored_addresses: Dict[str, Set[int]] = dict(), apply_string_filter: bool = True, report_unique_access_sets: bool = False, ignore_if_no_overlap: bool = True) -> bool:
+    '''Same as |merge_reports| of bin/merge_reports.py'''
+    args = ["merge"]
+    if not ignore_if_no_overlap:
+        args.append("-a")
+    if report_unique_access_sets:
+        args.append("-q")
+    if not apply_string_filter:
+        args.append("--disable-string-filter")
+    for lib, offsets in ignored_addresses.items():
+        args.extend(["--into", lib])
+        for offset in offsets:
+            args.extend(["-i", hex(offset)])
+    args.append(tracer_out_path)
+
+    return run(args)
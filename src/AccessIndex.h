@@ -1,4 +1,4 @@
-#include "pin.H"
+#include "PinTypes.h"
 #include <iostream>
 
 #ifndef ACCESSINDEX
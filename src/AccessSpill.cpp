@@ -0,0 +1,487 @@
+#include "AccessSpill.h"
+#include "TagManager.h"
+
+#include <algorithm>
+#include <queue>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define SPILL_SEGMENT_MAGIC 0x314c4c495053544dULL // "MTSPILL1"
+// Zeroed bytes at the end of every segment. Hashers of MemoryAccess read uninitialized intervals in words of 8 bytes,
+// possibly going past their end: padding guarantees they never read past the end of the mapping.
+#define SPILL_SEGMENT_PADDING 4096
+// Size of the buffer used to write merged segments
+#define SPILL_MERGE_BUFFER_SIZE (1 << 20)
+
+namespace{
+    struct SegmentHeader{
+        uint64_t magic;
+        uint64_t groupsCount;
+    };
+
+    struct GroupRecord{
+        uint64_t address;
+        uint32_t size;
+        uint32_t accessesCount;
+    };
+
+    // Followed by |intervalLength| bytes of uninitialized interval
+    struct AccessRecord{
+        uint64_t executionOrder;
+        uint64_t ip;
+        uint64_t actualIp;
+        uint64_t address;
+        int64_t spOffset;
+        int64_t bpOffset;
+        // Pointers are only valid inside the process which wrote the segment (and its children)
+        uint64_t disasm;
+        uint64_t shadowMemory;
+        uint32_t opcode;
+        uint32_t size;
+        uint8_t type;
+        uint8_t isUninitializedRead;
+        uint16_t intervalLength;
+        uint32_t padding;
+    };
+
+    // Number of bytes of the uninitialized interval of |ma| (see ShadowBase::computeIntervals)
+    uint16_t getIntervalLength(const MemoryAccess& ma){
+        if(!ma.getIsUninitializedRead() || ma.getUninitializedInterval() == NULL)
+            return 0;
+
+        UINT32 size = ma.getSize() + ma.getAddress() % 8;
+        return size % 8 != 0 ? (size / 8) + 1 : (size / 8);
+    }
+
+    // Writes the whole |buffer| at the current offset of |fd|
+    bool writeAll(int fd, const std::vector<uint8_t>& buffer){
+        size_t written = 0;
+        while(written < buffer.size()){
+            ssize_t len = write(fd, buffer.data() + written, buffer.size() - written);
+            if(len < 0){
+                if(errno == EINTR)
+                    continue;
+                return false;
+            }
+            written += len;
+        }
+        return true;
+    }
+}
+
+SpillSegment::SpillSegment(const std::string& path, size_t size) : path(path), owned(true), size(size), mapping(NULL){}
+
+const std::string& SpillSegment::getPath() const{
+    return path;
+}
+
+size_t SpillSegment::getSize() const{
+    return size;
+}
+
+void SpillSegment::disown(){
+    owned = false;
+}
+
+bool SpillSegment::map(){
+    if(mapping != NULL)
+        return true;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd == -1)
+        return false;
+
+    void* ptr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(ptr == MAP_FAILED)
+        return false;
+
+    mapping = (const uint8_t*) ptr;
+    return true;
+}
+
+void SpillSegment::unmap(){
+    if(mapping == NULL)
+        return;
+
+    munmap((void*) mapping, size);
+    mapping = NULL;
+}
+
+void SpillSegment::remove(){
+    unmap();
+    if(owned)
+        unlink(path.c_str());
+}
+
+SpillSegment::Cursor SpillSegment::begin() const{
+    if(mapping == NULL)
+        return Cursor();
+
+    SegmentHeader header;
+    memcpy(&header, mapping, sizeof(header));
+    if(header.magic != SPILL_SEGMENT_MAGIC || header.groupsCount == 0)
+        return Cursor();
+
+    return Cursor(mapping + sizeof(header), mapping + size - SPILL_SEGMENT_PADDING);
+}
+
+bool SpillSegment::Cursor::isValid() const{
+    return current != NULL && current < end;
+}
+
+AccessIndex SpillSegment::Cursor::peek() const{
+    GroupRecord record;
+    memcpy(&record, current, sizeof(record));
+    return AccessIndex(record.address, record.size);
+}
+
+void SpillSegment::Cursor::read(StreamedGroup& group){
+    GroupRecord groupRecord;
+    memcpy(&groupRecord, current, sizeof(groupRecord));
+    current += sizeof(groupRecord);
+
+    for(uint32_t i = 0; i < groupRecord.accessesCount; ++i){
+        AccessRecord record;
+        memcpy(&record, current, sizeof(record));
+        current += sizeof(record);
+
+        MemoryAccess ma(record.opcode, record.executionOrder, record.ip, record.actualIp, record.address, record.spOffset,
+            record.bpOffset, record.size, (AccessType) record.type, (std::string*) (uintptr_t) record.disasm, (ShadowBase*) (uintptr_t) record.shadowMemory);
+        if(record.isUninitializedRead){
+            ma.setUninitializedRead();
+            if(record.intervalLength != 0)
+                ma.setUninitializedInterval((uint8_t*) current);
+        }
+        current += record.intervalLength;
+
+        group.spilled.push_back(ma);
+    }
+}
+
+const uint8_t* SpillSegment::Cursor::skip(uint32_t& accessesCount, size_t& length){
+    GroupRecord groupRecord;
+    memcpy(&groupRecord, current, sizeof(groupRecord));
+    current += sizeof(groupRecord);
+
+    const uint8_t* records = current;
+    for(uint32_t i = 0; i < groupRecord.accessesCount; ++i){
+        AccessRecord record;
+        memcpy(&record, current, sizeof(record));
+        current += sizeof(record) + record.intervalLength;
+    }
+
+    accessesCount = groupRecord.accessesCount;
+    length = current - records;
+    return records;
+}
+
+AccessSpill::AccessSpill() : budget(0), storeBytes(0), segmentsCounter(0){}
+
+AccessSpill& AccessSpill::getInstance(){
+    static AccessSpill instance;
+
+    return instance;
+}
+
+void AccessSpill::enable(const std::string& directory, size_t budget){
+    this->directory = directory;
+    this->budget = budget;
+}
+
+void AccessSpill::disable(){
+    budget = 0;
+}
+
+bool AccessSpill::isEnabled() const{
+    return budget != 0;
+}
+
+size_t AccessSpill::getAccessBytes(const MemoryAccess& ma){
+    // Node of the unordered_set (the element, the next pointer and the cached hash), its bucket and the interval
+    return sizeof(MemoryAccess) + 3 * sizeof(void*) + getIntervalLength(ma);
+}
+
+size_t AccessSpill::getGroupBytes(){
+    // Node of the unordered_map, its bucket and the initial buckets of the set
+    return sizeof(AccessIndex) + sizeof(unordered_set<MemoryAccess, MemoryAccess::MAHasher>) + 6 * sizeof(void*);
+}
+
+size_t AccessSpill::getStoredGroupBytes(const unordered_set<MemoryAccess, MemoryAccess::MAHasher>& group) const{
+    size_t ret = getGroupBytes();
+    for(const MemoryAccess& ma : group){
+        ret += getAccessBytes(ma);
+    }
+    return ret;
+}
+
+bool AccessSpill::writeSegment(const std::string& path, const vector<AccessStore::iterator>& groups, size_t& segmentSize){
+    segmentSize = sizeof(SegmentHeader) + SPILL_SEGMENT_PADDING;
+    for(const auto& group : groups){
+        segmentSize += sizeof(GroupRecord);
+        for(const MemoryAccess& ma : group->second){
+            segmentSize += sizeof(AccessRecord) + getIntervalLength(ma);
+        }
+    }
+
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if(fd == -1)
+        return false;
+
+    if(ftruncate(fd, segmentSize) != 0){
+        close(fd);
+        unlink(path.c_str());
+        return false;
+    }
+
+    void* ptr = mmap(NULL, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(ptr == MAP_FAILED){
+        unlink(path.c_str());
+        return false;
+    }
+
+    uint8_t* current = (uint8_t*) ptr;
+    SegmentHeader header;
+    header.magic = SPILL_SEGMENT_MAGIC;
+    header.groupsCount = groups.size();
+    memcpy(current, &header, sizeof(header));
+    current += sizeof(header);
+
+    for(const auto& group : groups){
+        GroupRecord groupRecord;
+        groupRecord.address = group->first.getFirst();
+        groupRecord.size = group->first.getSecond();
+        groupRecord.accessesCount = group->second.size();
+        memcpy(current, &groupRecord, sizeof(groupRecord));
+        current += sizeof(groupRecord);
+
+        for(const MemoryAccess& ma : group->second){
+            AccessRecord record;
+            memset(&record, 0, sizeof(record));
+            record.executionOrder = ma.getOrder();
+            record.ip = ma.getIP();
+            record.actualIp = ma.getActualIP();
+            record.address = ma.getAddress();
+            record.spOffset = ma.getSPOffset();
+            record.bpOffset = ma.getBPOffset();
+            record.disasm = (uintptr_t) ma.getDisasmPtr();
+            record.shadowMemory = (uintptr_t) ma.getShadowMemory();
+            record.opcode = ma.getOpcode();
+            record.size = ma.getSize();
+            record.type = (uint8_t) ma.getType();
+            record.isUninitializedRead = ma.getIsUninitializedRead();
+            record.intervalLength = getIntervalLength(ma);
+            memcpy(current, &record, sizeof(record));
+            current += sizeof(record);
+
+            if(record.intervalLength != 0){
+                memcpy(current, ma.getUninitializedInterval(), record.intervalLength);
+                current += record.intervalLength;
+            }
+        }
+    }
+
+    // The file is read again only at the end of the execution: no need to wait for the pages to be written
+    munmap(ptr, segmentSize);
+    return true;
+}
+
+std::string AccessSpill::getNextSegmentPath(){
+    return directory + "/memtrace." + std::to_string(getpid()) + "." + std::to_string(segmentsCounter++) + ".spill";
+}
+
+bool AccessSpill::mergeSegments(){
+    // Merging the smallest segments first, each access is rewritten a logarithmic number of times
+    vector<size_t> inputs;
+    for(size_t i = 0; i < segments.size(); ++i){
+        inputs.push_back(i);
+    }
+    std::sort(inputs.begin(), inputs.end(),
+        [this](size_t i1, size_t i2){
+            return segments[i1].getSize() < segments[i2].getSize();
+        }
+    );
+    inputs.resize(std::min(inputs.size(), (size_t) SPILL_MERGE_FAN_IN));
+    std::sort(inputs.begin(), inputs.end());
+
+    typedef std::pair<AccessIndex, size_t> CursorEntry;
+    auto comparator = [](const CursorEntry& e1, const CursorEntry& e2){
+        return e2.first < e1.first;
+    };
+    std::priority_queue<CursorEntry, vector<CursorEntry>, decltype(comparator)> nextCursors(comparator);
+    vector<SpillSegment::Cursor> cursors;
+    bool ret = true;
+    for(size_t i : inputs){
+        ret = ret && segments[i].map();
+        SpillSegment::Cursor cursor = segments[i].begin();
+        if(cursor.isValid()){
+            nextCursors.push(CursorEntry(cursor.peek(), cursors.size()));
+            cursors.push_back(cursor);
+        }
+    }
+
+    std::string path = getNextSegmentPath();
+    int fd = ret ? open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600) : -1;
+    ret = fd != -1;
+
+    // The header is written once the number of groups is known
+    SegmentHeader header;
+    header.magic = SPILL_SEGMENT_MAGIC;
+    header.groupsCount = 0;
+    size_t segmentSize = sizeof(header);
+    std::vector<uint8_t> buffer(reinterpret_cast<const uint8_t*>(&header), reinterpret_cast<const uint8_t*>(&header) + sizeof(header));
+    buffer.reserve(SPILL_MERGE_BUFFER_SIZE);
+
+    vector<std::pair<const uint8_t*, size_t>> records;
+    while(ret && !nextCursors.empty()){
+        // Accesses of the same group stored in different segments are stored in a single group
+        AccessIndex ai = nextCursors.top().first;
+        GroupRecord groupRecord;
+        groupRecord.address = ai.getFirst();
+        groupRecord.size = ai.getSecond();
+        groupRecord.accessesCount = 0;
+        records.clear();
+        while(!nextCursors.empty() && nextCursors.top().first == ai){
+            size_t cursorIndex = nextCursors.top().second;
+            nextCursors.pop();
+
+            uint32_t accessesCount;
+            size_t length;
+            const uint8_t* groupRecords = cursors[cursorIndex].skip(accessesCount, length);
+            groupRecord.accessesCount += accessesCount;
+            records.push_back(std::make_pair(groupRecords, length));
+
+            if(cursors[cursorIndex].isValid())
+                nextCursors.push(CursorEntry(cursors[cursorIndex].peek(), cursorIndex));
+        }
+
+        const uint8_t* groupRecordBytes = reinterpret_cast<const uint8_t*>(&groupRecord);
+        buffer.insert(buffer.end(), groupRecordBytes, groupRecordBytes + sizeof(groupRecord));
+        segmentSize += sizeof(groupRecord);
+        for(const auto& groupRecords : records){
+            buffer.insert(buffer.end(), groupRecords.first, groupRecords.first + groupRecords.second);
+            segmentSize += groupRecords.second;
+        }
+        ++header.groupsCount;
+
+        if(buffer.size() >= SPILL_MERGE_BUFFER_SIZE){
+            ret = writeAll(fd, buffer);
+            buffer.clear();
+        }
+    }
+
+    // Zeroed padding is added by extending the file
+    segmentSize += SPILL_SEGMENT_PADDING;
+    ret = ret && writeAll(fd, buffer) && pwrite(fd, &header, sizeof(header), 0) == sizeof(header) && ftruncate(fd, segmentSize) == 0;
+    if(fd != -1)
+        close(fd);
+
+    for(size_t i : inputs){
+        segments[i].unmap();
+    }
+
+    if(!ret){
+        if(fd != -1)
+            unlink(path.c_str());
+        return false;
+    }
+
+    // Inputs are removed from the last one, so that the indexes of the others are still valid
+    for(auto iter = inputs.rbegin(); iter != inputs.rend(); ++iter){
+        segments[*iter].remove();
+        segments.erase(segments.begin() + *iter);
+    }
+    segments.push_back(SpillSegment(path, segmentSize));
+    return true;
+}
+
+long long AccessSpill::spill(AccessStore& store){
+    if(!isEnabled() || store.empty())
+        return 0;
+
+    if(segments.size() >= SPILL_MAX_SEGMENTS && !mergeSegments())
+        return -1;
+
+    // The most recent access of each group: groups not accessed for the longest time are the first to be spilled
+    vector<std::pair<unsigned long long, AccessStore::iterator>> groups;
+    groups.reserve(store.size());
+    for(auto iter = store.begin(); iter != store.end(); ++iter){
+        unsigned long long lastOrder = 0;
+        for(const MemoryAccess& ma : iter->second){
+            lastOrder = std::max(lastOrder, ma.getOrder());
+        }
+        groups.push_back(std::make_pair(lastOrder, iter));
+    }
+    std::sort(groups.begin(), groups.end(),
+        [](const std::pair<unsigned long long, AccessStore::iterator>& g1, const std::pair<unsigned long long, AccessStore::iterator>& g2){
+            return g1.first < g2.first;
+        }
+    );
+
+    size_t target = budget / 2;
+    size_t freedBytes = 0;
+    vector<AccessStore::iterator> spilled;
+    for(auto& group : groups){
+        if(storeBytes - freedBytes <= target)
+            break;
+
+        spilled.push_back(group.second);
+        freedBytes += std::min(getStoredGroupBytes(group.second->second), storeBytes - freedBytes);
+    }
+
+    // Groups are stored in the same order used to write the report, so that segments can be merged by streaming them
+    std::sort(spilled.begin(), spilled.end(),
+        [](const AccessStore::iterator& g1, const AccessStore::iterator& g2){
+            return g1->first < g2->first;
+        }
+    );
+
+    std::string path = getNextSegmentPath();
+    size_t segmentSize;
+    if(!writeSegment(path, spilled, segmentSize))
+        return -1;
+    segments.push_back(SpillSegment(path, segmentSize));
+
+    // Uninitialized reads may still be referenced by tags (see TagManager), which share their interval
+    TagManager& tagManager = TagManager::getInstance();
+    for(auto& group : spilled){
+        for(const MemoryAccess& ma : group->second){
+            if(!tagManager.hasTag(std::make_pair(group->first, ma)))
+                ma.freeMemory();
+        }
+        store.erase(group);
+    }
+    storeBytes -= freedBytes;
+
+    return spilled.size();
+}
+
+const vector<SpillSegment>& AccessSpill::getSegments() const{
+    return segments;
+}
+
+vector<SpillSegment>& AccessSpill::getSegments(){
+    return segments;
+}
+
+size_t AccessSpill::getStoreBytes() const{
+    return storeBytes;
+}
+
+void AccessSpill::restart(){
+    for(SpillSegment& segment : segments){
+        segment.disown();
+    }
+}
+
+void AccessSpill::clear(){
+    for(SpillSegment& segment : segments){
+        segment.remove();
+    }
+    segments.clear();
+    storeBytes = 0;
+}
@@ -0,0 +1,145 @@
+#ifndef ACCESSSPILL
+#define ACCESSSPILL
+
+#include <string>
+#include <vector>
+#include <deque>
+#include "PinTypes.h"
+#include "AccessIndex.h"
+#include "MemoryAccess.h"
+#include "OverlapAnalysis.h"
+
+using std::vector;
+
+// Maximum number of spill segments. Once it is reached, the SPILL_MERGE_FAN_IN smallest segments are merged into a single
+// one before writing a new segment, so that both the number of files and the number of segments mapped at once are bounded.
+#define SPILL_MAX_SEGMENTS 16
+#define SPILL_MERGE_FAN_IN 8
+
+/*
+    Bounds the memory used by the access store (|memAccesses| in MemTrace.cpp).
+    Whenever its estimated size exceeds the budget, the least recently updated groups of accesses (i.e. the groups
+    whose last access is the oldest) are moved to a segment file and removed from the store, until it
+    uses half of the budget. At the end of the execution, the groups still in memory and the ones stored in segments
+    are merged back by |AccessStream|, one group at a time.
+    Segments are merged as soon as there are SPILL_MAX_SEGMENTS of them (see |mergeSegments|), so that each access is
+    only rewritten a logarithmic number of times.
+
+    Segments are written in the directory of the report and removed by |clear|.
+*/
+
+// A group of accesses produced by |AccessStream|. Accesses read from segments are stored in |spilled|: their
+// uninitialized intervals refer to the file mapping, so they must not be used once the segment is unmapped, nor freed.
+struct StreamedGroup{
+    AccessIndex ai;
+    std::deque<MemoryAccess> spilled;
+};
+
+class SpillSegment{
+    private:
+        std::string path;
+        // Whether this process created the segment (fork server children inherit the segments of the fork server,
+        // but must not remove them)
+        bool owned;
+        size_t size;
+        const uint8_t* mapping;
+
+    public:
+        SpillSegment(const std::string& path, size_t size);
+
+        const std::string& getPath() const;
+        size_t getSize() const;
+        void disown();
+
+        // Maps the segment in memory, if it isn't already. Returns false if the segment can't be read.
+        bool map();
+        void unmap();
+        // Unmaps the segment and deletes its file, if it has been created by this process
+        void remove();
+
+        // Cursor over the groups of the segment, which are stored in increasing order of AccessIndex
+        class Cursor{
+            private:
+                const uint8_t* current;
+                const uint8_t* end;
+
+            public:
+                Cursor() : current(NULL), end(NULL){}
+                Cursor(const uint8_t* begin, const uint8_t* end) : current(begin), end(end){}
+
+                bool isValid() const;
+                // AccessIndex of the group the cursor points to
+                AccessIndex peek() const;
+                // Appends the accesses of the current group to |group.spilled| and moves to the next group
+                void read(StreamedGroup& group);
+                // Moves to the next group, returning the records of the accesses of the current one as they are stored
+                // in the segment, together with their number and their length in bytes
+                const uint8_t* skip(uint32_t& accessesCount, size_t& length);
+        };
+
+        Cursor begin() const;
+};
+
+class AccessSpill{ // Singleton
+    private:
+        std::string directory;
+        size_t budget;
+        // Estimated number of bytes used by the access store
+        size_t storeBytes;
+        unsigned long long segmentsCounter;
+        vector<SpillSegment> segments;
+
+        AccessSpill();
+
+        size_t getStoredGroupBytes(const unordered_set<MemoryAccess, MemoryAccess::MAHasher>& group) const;
+        std::string getNextSegmentPath();
+        bool writeSegment(const std::string& path, const vector<AccessStore::iterator>& groups, size_t& segmentSize);
+        // Replaces the SPILL_MERGE_FAN_IN smallest segments with a single segment holding all of their groups, in order.
+        // Returns false if the merged segment can't be written (in which case the segments are not modified).
+        bool mergeSegments();
+
+    public:
+        AccessSpill(AccessSpill const& other) = delete;
+        void operator=(AccessSpill const& other) = delete;
+
+        static AccessSpill& getInstance();
+
+        // Segments are written into |directory|. If |budget| is 0 (the default), the access store is never spilled.
+        void enable(const std::string& directory, size_t budget);
+        // Called if a segment can't be written: the access store is kept in memory from now on
+        void disable();
+        bool isEnabled() const;
+
+        // Estimated number of bytes used by an access inside the access store
+        static size_t getAccessBytes(const MemoryAccess& ma);
+
+        // Must be called whenever an access is inserted into the access store
+        inline void accessStored(const MemoryAccess& ma, bool isNewGroup){
+            storeBytes += getAccessBytes(ma) + (isNewGroup ? getGroupBytes() : 0);
+        }
+
+        inline bool isOverBudget() const{
+            return budget != 0 && storeBytes > budget;
+        }
+
+        // Estimated number of bytes used by an AccessIndex and by its (empty) set of accesses
+        static size_t getGroupBytes();
+
+        // Moves the coldest groups of |store| to a new segment, until the store uses at most half of the budget.
+        // Returns the number of spilled groups, or -1 if the segment can't be written (in which case |store| is not modified).
+        long long spill(AccessStore& store);
+
+        const vector<SpillSegment>& getSegments() const;
+        vector<SpillSegment>& getSegments();
+        size_t getStoreBytes() const;
+
+        // Called by fork server children: segments written by the fork server are still part of the analysis of the
+        // child, but only the ones written by the child itself will be removed by |clear|
+        void restart();
+
+        // Removes the segments created by this process and resets the estimated size of the access store.
+        // Must be called whenever the access store is emptied.
+        void clear();
+};
+
+#endif // ACCESSSPILL
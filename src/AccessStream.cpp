@@ -0,0 +1,156 @@
+#include "AccessStream.h"
+
+#include <algorithm>
+
+// Minimum number of expired groups dropped at once by OverlapWindow
+#define OVERLAP_WINDOW_DROP_BATCH 1024
+
+AccessStream::AccessStream(const vector<OrderedAccessEntry>& inMemory, vector<SpillSegment>& segments) : inMemory(inMemory), inMemoryIndex(0), complete(true){
+    for(SpillSegment& segment : segments){
+        if(!segment.map()){
+            complete = false;
+            continue;
+        }
+
+        SpillSegment::Cursor cursor = segment.begin();
+        if(cursor.isValid()){
+            nextCursors.push(CursorEntry(cursor.peek(), cursors.size()));
+            cursors.push_back(cursor);
+        }
+    }
+}
+
+bool AccessStream::next(StreamedGroup& group, OrderedAccessGroup& accesses){
+    group.spilled.clear();
+    accesses.clear();
+
+    bool isInMemoryFinished = inMemoryIndex >= inMemory.size();
+    if(isInMemoryFinished && nextCursors.empty())
+        return false;
+
+    if(!isInMemoryFinished && (nextCursors.empty() || !(nextCursors.top().first < *inMemory[inMemoryIndex].first)))
+        group.ai = *inMemory[inMemoryIndex].first;
+    else
+        group.ai = nextCursors.top().first;
+
+    if(!isInMemoryFinished && *inMemory[inMemoryIndex].first == group.ai){
+        accesses = inMemory[inMemoryIndex].second;
+        ++inMemoryIndex;
+    }
+
+    bool isSpilled = false;
+    while(!nextCursors.empty() && nextCursors.top().first == group.ai){
+        size_t cursorIndex = nextCursors.top().second;
+        nextCursors.pop();
+
+        size_t firstRead = group.spilled.size();
+        cursors[cursorIndex].read(group);
+        for(size_t i = firstRead; i < group.spilled.size(); ++i){
+            accesses.push_back(&group.spilled[i]);
+        }
+        isSpilled = true;
+
+        if(cursors[cursorIndex].isValid())
+            nextCursors.push(CursorEntry(cursors[cursorIndex].peek(), cursorIndex));
+    }
+
+    // Groups of the access store are already ordered by |getOrderedView|
+    if(isSpilled){
+        MemoryAccess::ExecutionComparator execComparator;
+        std::stable_sort(accesses.begin(), accesses.end(), execComparator);
+        auto last = std::unique(accesses.begin(), accesses.end(),
+            [](const MemoryAccess* ma1, const MemoryAccess* ma2){
+                return ma1->getOrder() == ma2->getOrder();
+            }
+        );
+        accesses.erase(last, accesses.end());
+    }
+
+    return true;
+}
+
+bool AccessStream::isComplete() const{
+    return complete;
+}
+
+OverlapWindow::OverlapWindow(const vector<OrderedAccessEntry>& inMemory, vector<SpillSegment>& segments) :
+    stream(inMemory, segments),
+    isStreamFinished(false),
+    current(0),
+    expiredGroups(0),
+    firstPartiallyOverlappingIndex(0)
+    {}
+
+bool OverlapWindow::load(){
+    if(isStreamFinished)
+        return false;
+
+    groups.emplace_back();
+    entries.push_back(OrderedAccessEntry(&groups.back().ai, OrderedAccessGroup()));
+    if(!stream.next(groups.back(), entries.back().second)){
+        groups.pop_back();
+        entries.pop_back();
+        isStreamFinished = true;
+        return false;
+    }
+
+    return true;
+}
+
+void OverlapWindow::dropExpiredGroups(){
+    ADDRINT firstAddress = entries[current].first->getFirst();
+    while(expiredGroups < current){
+        const AccessIndex& ai = *entries[expiredGroups].first;
+        if(ai.getFirst() + ai.getSecond() - 1 >= firstAddress)
+            break;
+        ++expiredGroups;
+    }
+
+    // Erasing groups from the beginning of |entries| moves all the following ones, so they are dropped in batches
+    if(expiredGroups == 0 || (expiredGroups < OVERLAP_WINDOW_DROP_BATCH && expiredGroups * 2 < entries.size()))
+        return;
+
+    entries.erase(entries.begin(), entries.begin() + expiredGroups);
+    for(size_t i = 0; i < expiredGroups; ++i){
+        groups.pop_front();
+    }
+    current -= expiredGroups;
+    firstPartiallyOverlappingIndex = firstPartiallyOverlappingIndex > expiredGroups ? firstPartiallyOverlappingIndex - expiredGroups : 0;
+    expiredGroups = 0;
+}
+
+bool OverlapWindow::next(){
+    if(!entries.empty())
+        ++current;
+
+    if(current >= entries.size() && !load())
+        return false;
+
+    dropExpiredGroups();
+    return true;
+}
+
+const AccessIndex& OverlapWindow::getAccessIndex() const{
+    return *entries[current].first;
+}
+
+const OrderedAccessGroup& OverlapWindow::getAccesses() const{
+    return entries[current].second;
+}
+
+bool OverlapWindow::isComplete() const{
+    return stream.isComplete();
+}
+
+set<PartialOverlapAccess> OverlapWindow::getPartialOverlapGroup(){
+    // Load every group starting before the end of the current one
+    const AccessIndex& ai = *entries[current].first;
+    ADDRINT lastAccessedByte = ai.getFirst() + ai.getSecond() - 1;
+    while(!isStreamFinished && entries.back().first->getFirst() <= lastAccessedByte){
+        load();
+    }
+
+    vector<size_t> overlapping;
+    findPartialOverlaps(entries, current, firstPartiallyOverlappingIndex, overlapping);
+    return ::getPartialOverlapGroup(entries, current, overlapping);
+}
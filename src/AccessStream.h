@@ -0,0 +1,90 @@
+#ifndef ACCESSSTREAM
+#define ACCESSSTREAM
+
+#include <deque>
+#include <queue>
+#include <vector>
+#include <set>
+#include "AccessIndex.h"
+#include "MemoryAccess.h"
+#include "OverlapAnalysis.h"
+#include "AccessSpill.h"
+
+using std::vector;
+using std::set;
+
+/*
+    Merges the groups of accesses still held by the access store and the ones moved to spill segments (see AccessSpill.h),
+    producing them one at a time in increasing order of AccessIndex, as |getOrderedView| does for the access store alone.
+    Groups with the same AccessIndex coming from different sources are merged, and accesses stored more than once
+    (i.e. stored again after being spilled) are only produced once.
+*/
+class AccessStream{
+    private:
+        typedef std::pair<AccessIndex, size_t> CursorEntry;
+
+        struct CursorEntryComparator{
+            bool operator()(const CursorEntry& e1, const CursorEntry& e2) const{
+                return e2.first < e1.first;
+            }
+        };
+
+        const vector<OrderedAccessEntry>& inMemory;
+        size_t inMemoryIndex;
+        // Whether every segment has been mapped
+        bool complete;
+        vector<SpillSegment::Cursor> cursors;
+        // Cursors not yet exhausted, ordered by the AccessIndex of their current group (smallest first)
+        std::priority_queue<CursorEntry, vector<CursorEntry>, CursorEntryComparator> nextCursors;
+
+    public:
+        // |inMemory| is the ordered view of the access store (see |getOrderedView|)
+        AccessStream(const vector<OrderedAccessEntry>& inMemory, vector<SpillSegment>& segments);
+
+        // Fills |group| and |accesses| (ordered by execution order) with the next group. Accesses either point to elements
+        // of the access store or to elements of |group.spilled|. Returns false if there are no more groups.
+        bool next(StreamedGroup& group, OrderedAccessGroup& accesses);
+
+        // Returns false if some segments can't be read, in which case their groups are missing
+        bool isComplete() const;
+};
+
+/*
+    Sliding window over the groups produced by an AccessStream, used to compute partial overlaps without holding every
+    group in memory. The window only keeps the groups which may still partially overlap the current group or any
+    following one: since groups are ordered by their first accessed address, a group ending before the first address of
+    the current group can't overlap any later group, and is dropped.
+*/
+class OverlapWindow{
+    private:
+        AccessStream stream;
+        // Owners of the groups in |entries|: elements of a deque are never moved by insertions at its ends
+        std::deque<StreamedGroup> groups;
+        vector<OrderedAccessEntry> entries;
+        bool isStreamFinished;
+        size_t current;
+        // Number of groups at the beginning of |entries| which can't overlap the current group or any later one
+        size_t expiredGroups;
+        // See |findPartialOverlaps|
+        size_t firstPartiallyOverlappingIndex;
+
+        bool load();
+        void dropExpiredGroups();
+
+    public:
+        OverlapWindow(const vector<OrderedAccessEntry>& inMemory, vector<SpillSegment>& segments);
+
+        // Moves to the next group. Returns false if there are no more groups.
+        bool next();
+
+        const AccessIndex& getAccessIndex() const;
+        const OrderedAccessGroup& getAccesses() const;
+
+        // See AccessStream::isComplete
+        bool isComplete() const;
+
+        // See |getPartialOverlapGroup|. As with |findPartialOverlaps|, it must be called for groups in increasing order.
+        set<PartialOverlapAccess> getPartialOverlapGroup();
+};
+
+#endif // ACCESSSTREAM
@@ -0,0 +1,88 @@
+#include "ForkServer.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+
+ForkServer::ForkServer(){}
+
+ForkServer& ForkServer::getInstance(){
+    static ForkServer instance;
+
+    return instance;
+}
+
+bool ForkServer::writeInt(uint32_t value){
+    ssize_t written;
+    do{
+        written = write(FORKSRV_ST_FD, &value, sizeof(value));
+    } while(written < 0 && errno == EINTR);
+
+    return written == sizeof(value);
+}
+
+bool ForkServer::sendHello(){
+    return writeInt(FORKSRV_HELLO);
+}
+
+bool ForkServer::nextRequest(std::string& inputPath, std::string& reportPath){
+    size_t newLine;
+    while((newLine = buffer.find('\n')) == std::string::npos){
+        char chunk[512];
+        ssize_t len = read(FORKSRV_CTL_FD, chunk, sizeof(chunk));
+        if(len < 0 && errno == EINTR)
+            continue;
+        if(len <= 0)
+            return false;
+
+        buffer.append(chunk, len);
+    }
+
+    std::string line = buffer.substr(0, newLine);
+    buffer.erase(0, newLine + 1);
+
+    size_t separator = line.find('\t');
+    if(separator == std::string::npos){
+        inputPath = line;
+        reportPath.clear();
+    }
+    else{
+        inputPath = line.substr(0, separator);
+        reportPath = line.substr(separator + 1);
+    }
+
+    return true;
+}
+
+bool ForkServer::setupChild(const std::string& inputPath, int inputFd){
+    close(FORKSRV_CTL_FD);
+    close(FORKSRV_ST_FD);
+
+    if(inputPath.empty())
+        return true;
+
+    int fd = open(inputPath.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    if(fd != inputFd){
+        if(dup2(fd, inputFd) < 0){
+            close(fd);
+            return false;
+        }
+        close(fd);
+    }
+
+    return true;
+}
+
+void ForkServer::waitChild(pid_t pid){
+    writeInt((uint32_t) pid);
+    if(pid <= 0)
+        return;
+
+    int status = 0;
+    while(waitpid(pid, &status, 0) < 0 && errno == EINTR);
+    writeInt((uint32_t) status);
+}
@@ -0,0 +1,55 @@
+#ifndef FORKSERVER
+#define FORKSERVER
+
+#include <string>
+#include <stdint.h>
+#include <sys/types.h>
+
+// File descriptors the fork server talks to its client through, inherited from the client itself (same as AFL's).
+#define FORKSRV_CTL_FD 198
+#define FORKSRV_ST_FD (FORKSRV_CTL_FD + 1)
+
+// Message written on the status pipe once the fork server is ready to accept requests
+#define FORKSRV_HELLO 0x4d54534bU
+
+/*
+    Client side of the fork server protocol.
+    Once the application reaches the configured snapshot point, the tool writes FORKSRV_HELLO on FORKSRV_ST_FD.
+    Then, for each input to be analyzed:
+        - the client writes a request on FORKSRV_CTL_FD: a line containing the path of the input and the path of the
+          binary report to be generated for it, separated by a tab. The input path may be empty if the client
+          delivers the input by itself (e.g. by overwriting the file passed to the application as an argument).
+        - the tool forks, and writes the pid of the child (4 bytes) on FORKSRV_ST_FD.
+        - when the child terminates, the tool writes its wait status (4 bytes) on FORKSRV_ST_FD.
+    Closing FORKSRV_CTL_FD terminates the fork server.
+*/
+class ForkServer{ // Singleton
+    private:
+        std::string buffer;
+
+        ForkServer();
+
+        bool writeInt(uint32_t value);
+
+    public:
+        ForkServer(ForkServer const& other) = delete;
+        void operator=(ForkServer const& other) = delete;
+
+        static ForkServer& getInstance();
+
+        // Returns false if no client is listening on the fork server file descriptors
+        bool sendHello();
+
+        // Blocks until the next request is received. Returns false if the client closed the control pipe.
+        bool nextRequest(std::string& inputPath, std::string& reportPath);
+
+        // Called by the child: redirects |inputFd| to the file at |inputPath| (if not empty)
+        // and closes the fork server file descriptors
+        bool setupChild(const std::string& inputPath, int inputFd);
+
+        // Called by the fork server: notifies the client about the child |pid| and waits for it to terminate.
+        // A negative |pid| means the fork failed: in that case it is just forwarded to the client.
+        void waitChild(pid_t pid);
+};
+
+#endif // FORKSERVER
@@ -3,7 +3,7 @@
 
 #include "Optional.h"
 #include "HeapEnum.h"
-#include "pin.H"
+#include "PinTypes.h"
 
 class HeapType {
     private:
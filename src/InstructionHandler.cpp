@@ -171,7 +171,8 @@ void InstructionHandler::handle(const AccessIndex& ai){
     ADDRINT addr = ai.getFirst();
     UINT32 size = ai.getSecond();
 
-    set_as_initialized(addr, size);
+    // These accesses may be very large (e.g. buffers written by system calls)
+    currentShadow->initializeRange(addr, size);
     updateStoredPendingReads(ai);
 }
 
@@ -0,0 +1,191 @@
+#include "InstrumentationFilter.h"
+
+#include <cstdlib>
+#include <cerrno>
+#include <algorithm>
+#include <iterator>
+
+InstrumentationFilter::InstrumentationFilter(){}
+
+InstrumentationFilter& InstrumentationFilter::getInstance(){
+    static InstrumentationFilter instance;
+
+    return instance;
+}
+
+bool InstrumentationFilter::matchesImage(const std::string& imageName, const std::string& filter){
+    if(imageName == filter)
+        return true;
+
+    size_t slash = imageName.find_last_of('/');
+    return slash != std::string::npos && imageName.compare(slash + 1, std::string::npos, filter) == 0;
+}
+
+bool InstrumentationFilter::matchesAny(const std::string& imageName, const std::vector<std::string>& filters){
+    for(const std::string& filter : filters){
+        if(matchesImage(imageName, filter))
+            return true;
+    }
+
+    return false;
+}
+
+void InstrumentationFilter::addRange(std::map<ADDRINT, ADDRINT>& rangesMap, ADDRINT start, ADDRINT end){
+    // Merge the new range with every range it overlaps (or is adjacent to), so that ranges in the map stay disjoint
+    auto iter = rangesMap.upper_bound(start);
+    if(iter != rangesMap.begin()){
+        auto prev = std::prev(iter);
+        if(prev->second >= start || prev->second + 1 == start)
+            iter = prev;
+    }
+
+    while(iter != rangesMap.end() && (iter->first <= end || iter->first == end + 1)){
+        start = std::min(start, iter->first);
+        end = std::max(end, iter->second);
+        iter = rangesMap.erase(iter);
+    }
+
+    rangesMap[start] = end;
+}
+
+void InstrumentationFilter::removeRanges(std::map<ADDRINT, ADDRINT>& rangesMap, ADDRINT start, ADDRINT end){
+    // Ranges may start before |start| or end after |end| (e.g. if they have been merged with the ones of an adjacent
+    // image): only the part overlapping [start, end] is removed, trimming or splitting them
+    auto iter = rangesMap.upper_bound(start);
+    if(iter != rangesMap.begin() && std::prev(iter)->second >= start)
+        --iter;
+
+    while(iter != rangesMap.end() && iter->first <= end){
+        ADDRINT rangeStart = iter->first;
+        ADDRINT rangeEnd = iter->second;
+        iter = rangesMap.erase(iter);
+
+        if(rangeStart < start)
+            rangesMap[rangeStart] = start - 1;
+        // Ranges are disjoint, so the following ones start after |rangeEnd| and the loop ends here
+        if(rangeEnd > end)
+            rangesMap[end + 1] = rangeEnd;
+    }
+}
+
+bool InstrumentationFilter::contains(const std::map<ADDRINT, ADDRINT>& rangesMap, ADDRINT addr){
+    auto iter = rangesMap.upper_bound(addr);
+    if(iter == rangesMap.begin())
+        return false;
+
+    --iter;
+    return addr <= iter->second;
+}
+
+void InstrumentationFilter::includeImage(const std::string& name){
+    if(!name.empty())
+        includedImages.push_back(name);
+}
+
+void InstrumentationFilter::excludeImage(const std::string& name){
+    if(!name.empty())
+        excludedImages.push_back(name);
+}
+
+void InstrumentationFilter::includeRoutine(const std::string& name){
+    if(!name.empty())
+        includedRoutines.push_back(name);
+}
+
+bool InstrumentationFilter::includeRange(const std::string& spec){
+    if(spec.empty())
+        return true;
+
+    RangeSpec range;
+    std::string addresses = spec;
+    size_t colon = spec.find_last_of(':');
+    if(colon != std::string::npos){
+        range.image = spec.substr(0, colon);
+        addresses = spec.substr(colon + 1);
+        if(range.image.empty())
+            return false;
+    }
+
+    size_t minus = addresses.find('-');
+    if(minus == std::string::npos)
+        return false;
+
+    std::string startStr = addresses.substr(0, minus);
+    std::string endStr = addresses.substr(minus + 1);
+    char* end;
+    errno = 0;
+    range.start = strtoull(startStr.c_str(), &end, 0);
+    if(startStr.empty() || *end != '\0' || errno != 0)
+        return false;
+    range.end = strtoull(endStr.c_str(), &end, 0);
+    if(endStr.empty() || *end != '\0' || errno != 0 || range.end < range.start)
+        return false;
+
+    if(range.image.empty())
+        addRange(absoluteRanges, range.start, range.end);
+    else
+        ranges.push_back(range);
+
+    return true;
+}
+
+bool InstrumentationFilter::isEnabled() const{
+    return hasIncludeFilters() || !excludedImages.empty();
+}
+
+bool InstrumentationFilter::hasIncludeFilters() const{
+    return !includedImages.empty() || !includedRoutines.empty() || !absoluteRanges.empty() || !ranges.empty();
+}
+
+void InstrumentationFilter::onImageLoad(IMG img){
+    if(!isEnabled())
+        return;
+
+    const std::string& name = IMG_Name(img);
+    ADDRINT low = IMG_LowAddress(img);
+    ADDRINT high = IMG_HighAddress(img);
+
+    if(matchesAny(name, excludedImages))
+        addRange(excludedRanges, low, high);
+
+    if(matchesAny(name, includedImages))
+        addRange(includedRanges, low, high);
+
+    for(const RangeSpec& range : ranges){
+        if(matchesImage(name, range.image))
+            addRange(includedRanges, low + range.start, low + range.end);
+    }
+
+    if(includedRoutines.empty())
+        return;
+
+    for(SEC sec = IMG_SecHead(img); SEC_Valid(sec); sec = SEC_Next(sec)){
+        for(RTN rtn = SEC_RtnHead(sec); RTN_Valid(rtn); rtn = RTN_Next(rtn)){
+            if(RTN_Size(rtn) == 0)
+                continue;
+
+            const std::string& rtnName = RTN_Name(rtn);
+            for(const std::string& included : includedRoutines){
+                if(rtnName == included){
+                    addRange(includedRanges, RTN_Address(rtn), RTN_Address(rtn) + RTN_Size(rtn) - 1);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void InstrumentationFilter::onImageUnload(IMG img){
+    if(!isEnabled())
+        return;
+
+    removeRanges(includedRanges, IMG_LowAddress(img), IMG_HighAddress(img));
+    removeRanges(excludedRanges, IMG_LowAddress(img), IMG_HighAddress(img));
+}
+
+bool InstrumentationFilter::isInstrumented(ADDRINT addr) const{
+    if(contains(excludedRanges, addr))
+        return false;
+
+    return !hasIncludeFilters() || contains(includedRanges, addr) || contains(absoluteRanges, addr);
+}
@@ -0,0 +1,71 @@
+#ifndef INSTRUMENTATIONFILTER
+#define INSTRUMENTATIONFILTER
+
+#include "pin.H"
+#include <string>
+#include <vector>
+#include <map>
+
+/*
+    Decides, at instrumentation time, which instructions are fully analyzed.
+    Code can be selected by image (--include-img/--exclude-img), by routine (--include-rtn) or by address range (--range).
+    If no include filter is specified, every instruction is analyzed, except the ones belonging to excluded images.
+    Otherwise, only instructions selected by at least one include filter (and not belonging to an excluded image) are.
+    Instructions which are not analyzed are still instrumented by a cheaper routine which only keeps shadow memory
+    up to date (see |instrumentExcludedInstruction| in MemTrace.cpp).
+*/
+class InstrumentationFilter{ // Singleton
+    private:
+        struct RangeSpec{
+            // Empty if the range is made of absolute addresses
+            std::string image;
+            ADDRINT start;
+            ADDRINT end;
+        };
+
+        std::vector<std::string> includedImages;
+        std::vector<std::string> excludedImages;
+        std::vector<std::string> includedRoutines;
+        std::vector<RangeSpec> ranges;
+
+        // Disjoint ranges of addresses, mapping their first address to their last one.
+        // |absoluteRanges| contains the ranges specified without an image, which are never removed.
+        std::map<ADDRINT, ADDRINT> absoluteRanges;
+        std::map<ADDRINT, ADDRINT> includedRanges;
+        std::map<ADDRINT, ADDRINT> excludedRanges;
+
+        InstrumentationFilter();
+
+        static bool matchesImage(const std::string& imageName, const std::string& filter);
+        static bool matchesAny(const std::string& imageName, const std::vector<std::string>& filters);
+        static void addRange(std::map<ADDRINT, ADDRINT>& rangesMap, ADDRINT start, ADDRINT end);
+        static void removeRanges(std::map<ADDRINT, ADDRINT>& rangesMap, ADDRINT start, ADDRINT end);
+        static bool contains(const std::map<ADDRINT, ADDRINT>& rangesMap, ADDRINT addr);
+
+    public:
+        InstrumentationFilter(InstrumentationFilter const& other) = delete;
+        void operator=(InstrumentationFilter const& other) = delete;
+
+        static InstrumentationFilter& getInstance();
+
+        // Images are matched either by their full path or by their file name. Empty names (i.e. the default value
+        // of the knobs) are ignored.
+        void includeImage(const std::string& name);
+        void excludeImage(const std::string& name);
+        void includeRoutine(const std::string& name);
+        // |spec| has format [<image>:]<start>-<end>. If the image is specified, addresses are offsets from its load address.
+        // Returns false if |spec| is not valid.
+        bool includeRange(const std::string& spec);
+
+        // Returns true if any filter has been specified
+        bool isEnabled() const;
+        bool hasIncludeFilters() const;
+
+        // Must be called whenever an image is loaded (unloaded), before any of its instructions is instrumented
+        void onImageLoad(IMG img);
+        void onImageUnload(IMG img);
+
+        bool isInstrumented(ADDRINT addr) const;
+};
+
+#endif // INSTRUMENTATIONFILTER
@@ -1,4 +1,5 @@
 #include <string>
+#include "ShadowPagePool.h"
 
 static void toUppercase(std::string& s){
     for(std::size_t i = 0; i < s.size(); ++i){
@@ -30,3 +31,51 @@ namespace HeuristicStatus{
     }
 }
 
+namespace ForkServerMode{
+    enum Mode{
+        OFF,
+        // Start the fork server at the first system call executed after the entry point
+        ENTRY,
+        // Start the fork server at the first read from the input file descriptor
+        READ
+    };
+
+    Mode fromString(std::string& s){
+        toUppercase(s);
+        if(s.compare("ENTRY") == 0)
+            return ENTRY;
+        if(s.compare("READ") == 0)
+            return READ;
+
+        return OFF;
+    }
+}
+
+namespace BudgetAction{
+    enum Action{
+        // Write the report and terminate the application
+        EXIT,
+        // Write the report and let the application go on without instrumentation
+        DETACH
+    };
+
+    Action fromString(std::string& s){
+        toUppercase(s);
+        if(s.compare("DETACH") == 0)
+            return DETACH;
+
+        return EXIT;
+    }
+}
+
+namespace ShadowHugePages{
+    ShadowPagePool::HugePages fromString(std::string& s){
+        toUppercase(s);
+        if(s.compare("THP") == 0)
+            return ShadowPagePool::THP;
+        if(s.compare("HUGETLB") == 0)
+            return ShadowPagePool::HUGETLB;
+
+        return ShadowPagePool::OFF;
+    }
+}
@@ -19,10 +19,12 @@
 #include <unordered_map>
 #include <cstring>
 #include <memory>
+#include <algorithm>
 
 #include <ctime>
 
 #include "ShadowMemory.h"
+#include "ShadowPagePool.h"
 #include "AccessIndex.h"
 #include "MemoryAccess.h"
 #include "SyscallHandler.h"
@@ -37,10 +39,21 @@
 #include "misc/SetOps.h"
 #include "misc/DstRegsChecker.h"
 #include "misc/InstructionClassification.h"
+#include "misc/NulScan.h"
 #include "TagManager.h"
 #include "PendingDirectMemoryCopy.h"
 #include "XsaveHandler.h"
 #include "StackAllocation.h"
+#include "ReportWriter.h"
+#include "ForkServer.h"
+#include "InstrumentationFilter.h"
+#include "Stats.h"
+#include "OverlapAnalysis.h"
+#include "AccessSpill.h"
+#include "AccessStream.h"
+#include "ReadContextFilter.h"
+#include "RoutineSummaries.h"
+#include "StringRoutines.h"
 
 using std::cerr;
 using std::string;
@@ -85,6 +98,8 @@ std::list<std::list<REG>*> regsPtrs;
 bool heuristicEnabled = false;
 bool heuristicLibsOnly = false;
 bool heuristicAlreadyApplied = false;
+// Kind of the string routine performing the read being analyzed, if any (see |stringRoutineRead|)
+StringRoutines::Kind stringReadKind = StringRoutines::NONE;
 
 bool ignoreLdInstructions;
 
@@ -97,6 +112,11 @@ ADDRINT loaderHighestAddr = -1;
 ADDRINT lastExecutedInstruction;
 StackAllocation lastStackAllocation;
 unsigned long long executedAccesses;
+Stats& stats = Stats::getInstance();
+AccessSpill& accessSpill = AccessSpill::getInstance();
+ReadContextFilter& readContextFilter = ReadContextFilter::getInstance();
+RoutineSummaries& routineSummaries = RoutineSummaries::getInstance();
+StringRoutines& stringRoutines = StringRoutines::getInstance();
 
 PendingDirectMemoryCopy pendingDirectMemoryCopy;
 
@@ -121,7 +141,6 @@ unordered_map<AccessIndex, MemoryAccess, AccessIndex::AIHasher> mallocTemporaryW
 // uninitialized read accesses. If a set contains at least 1 uninitialized read,
 // the correspondin AccessIndex object is inserted in the set (implemented as an hash table).
 unordered_set<AccessIndex, AccessIndex::AIHasher> containsUninitializedRead;
-map<AccessIndex, set<MemoryAccess>> partialOverlaps;
 
 // Map thought to contain the loaded images (e.g. libraries) base addresses, so that it is possible to add them to the report
 // in order to make debugging and verification easier
@@ -147,6 +166,8 @@ bool removedThroughBrk = false;
 bool memalignCalled = false;
 void** memalignPtr = NULL;
 ADDRINT mallocRequestedSize = 0;
+// Size requested to the pending call to calloc (0 if the pending allocation is not a calloc)
+ADDRINT callocRequestedSize = 0;
 ADDRINT freeRequestedAddr = 0;
 ADDRINT freeBlockSize = 0;
 unsigned nestedCalls = 0;
@@ -158,8 +179,97 @@ unordered_map<ADDRINT, size_t> mmapMallocated;
 bool mmapMallocCalled = false;
 bool firstMallocCalled = false;
 
+/*
+Persistent mode: the routine specified through knob -persistent-fn is executed once for each input listed in
+-persistent-inputs without restarting the application, producing a separate binary report for each of them.
+When the routine is entered for the first time, its context and the initialization status of shadow memory and registers
+are saved. Whenever it returns, the report of the current input is written and execution restarts from the
+routine's entry point with the saved status and the next input.
+*/
+enum class PersistentStatus{
+    WAITING,
+    RUNNING,
+    DONE
+};
+
+PersistentStatus persistentStatus = PersistentStatus::WAITING;
+// Pairs <input path, binary report path>
+vector<std::pair<std::string, std::string>> persistentInputs;
+size_t persistentIteration = 0;
+// Number of nested invocations of the persistent routine currently being executed
+unsigned persistentDepth = 0;
+CONTEXT persistentContext;
+map<AccessIndex, MemoryAccess, AccessIndex::LastAccessedByteSorter> persistentLastWrites;
+StackAllocation persistentStackAllocation;
+
+/*
+Fork server mode: the application runs up to the snapshot point selected through knob -fork-server, and from there
+it forks a child for each request received from the client (see ForkServer.h). Children inherit the instrumented
+code and the whole analysis state, so they go on analyzing the execution with a different input without restarting
+the application. The fork is obtained by turning the system call executed at the snapshot point into a fork and
+re-executing the original system call after the fork returns, both in the parent (which then forks again at the next request)
+and in the child.
+*/
+ForkServerMode::Mode forkServerMode = ForkServerMode::OFF;
+bool forkServerStarted = false;
+bool forkServerParent = false;
+// Set while the system call at the snapshot point has been replaced by a fork
+bool forkServerForking = false;
+ADDRINT forkServerSyscallNum;
+ADDRINT forkServerSyscallIP;
+std::string forkServerInputPath;
+// Path of the binary report. It is replaced by the one received with the request in fork server children.
+std::string reportPath;
+
+/*
+Execution budget: the analysis is stopped as soon as the application executes more instructions, runs for more time or
+performs more memory accesses than allowed. The report is written with what has been traced so far, so that inputs
+making the application loop for a long time still produce a report instead of being killed.
+Budgets are checked every BUDGET_CHECK_INTERVAL instructions, counted per basic block.
+*/
+#define BUDGET_CHECK_INTERVAL (1ULL << 20)
+
+bool budgetEnabled = false;
+UINT64 instructionBudget;
+UINT64 accessBudget;
+time_t timeBudget;
+BudgetAction::Action budgetAction;
+UINT64 executedInstructions = 0;
+UINT64 nextBudgetCheck = BUDGET_CHECK_INTERVAL;
+time_t budgetStartTime;
+unsigned long long budgetStartAccesses = 0;
+// Set when a budget is exhausted, so that the next report written is flagged as truncated (see ReportFormat::TRUNCATED)
+bool budgetExhausted = false;
+
+/*
+Adaptive instrumentation: once an instruction performed uninitialized reads in the maximum number of distinct contexts
+(see ReadContextFilter.h), its further reads would never be stored, so it is instrumented again as an excluded instruction,
+which only keeps the shadow memory consistent (see |InstrumentExcludedInstruction|).
+*/
+bool adaptiveInstrumentation = false;
+unordered_set<ADDRINT> saturatedInstructions;
+
+/*
+Routine summaries (see RoutineSummaries.h): a summary is applied when a summarized routine is entered, and the routine is
+considered running until one of its ret instructions is executed. Variants of the routines may jump to the entry point
+of another one (e.g. __memmove_chk to memmove) with the same arguments: the summary is not applied again in that case.
+*/
+bool summaryRunning = false;
+ADDRINT summarySp;
+ADDRINT summaryArgs[3];
+
+/*
+Copy performed by realloc when it moves a block (through a summarized memcpy). It can't be applied when memcpy is called,
+as the new block may not be known as a heap address yet, so the status of the copied bytes is saved in |reallocShadow|
+before the old block is freed, and copied to the new block once it is known (see |MallocAfter|).
+*/
+ADDRINT reallocCopySrc;
+ADDRINT reallocCopyDst;
+size_t reallocCopySize = 0;
+bool reallocCopySaved = false;
+HeapShadow* reallocShadow = NULL;
+
 #ifdef DEBUG
-    std::ofstream isReadLogger("isReadLog.log");
     std::ofstream analysisProfiling("MemTrace.profile");
     std::ofstream applicationTiming("appTiming.profile");
 #endif
@@ -171,6 +281,26 @@ bool firstMallocCalled = false;
 KNOB<string> KnobOutputFile(KNOB_MODE_WRITEONCE, "pintool", "o", "./overlaps.bin", "Specify the path of the binary report generated by the tool", "");
 KNOB<string> KnobHeuristicStatus(KNOB_MODE_WRITEONCE, "pintool", "u", "LIBS", "Specify whether the string optimization removal heuristic should be enabled", "");
 KNOB<bool> KnobKeepLoader(KNOB_MODE_WRITEONCE, "pintool", "-keep-ld", "false", "If enabled, instructions from the loader's library (ld.so in Linux) are not ignored", "");
+KNOB<string> KnobPersistentFunction(KNOB_MODE_WRITEONCE, "pintool", "-persistent-fn", "", "Specify the name of the routine to be analyzed once for each input in persistent mode. If empty, persistent mode is disabled", "");
+KNOB<string> KnobPersistentInputs(KNOB_MODE_WRITEONCE, "pintool", "-persistent-inputs", "", "Specify the file listing the inputs analyzed in persistent mode. Each line contains the path of an input and the path of its binary report, separated by a tab", "");
+KNOB<string> KnobPersistentInputFile(KNOB_MODE_WRITEONCE, "pintool", "-persistent-input-file", "", "Specify the file read by the persistent routine. Before each iteration, the content of the current input is copied into it", "");
+KNOB<string> KnobForkServer(KNOB_MODE_WRITEONCE, "pintool", "-fork-server", "OFF", "Specify where the application becomes a fork server (see ForkServer.h): OFF, ENTRY (first system call after the entry point) or READ (first read from the input file descriptor)", "");
+KNOB<int> KnobForkServerFd(KNOB_MODE_WRITEONCE, "pintool", "-fork-server-fd", "0", "Specify the file descriptor the application reads its input from in fork server mode", "");
+KNOB<string> KnobIncludeImage(KNOB_MODE_APPEND, "pintool", "-include-img", "", "Only analyze the instructions of the given image (full path or file name). May be repeated", "");
+KNOB<string> KnobExcludeImage(KNOB_MODE_APPEND, "pintool", "-exclude-img", "", "Do not analyze the instructions of the given image (full path or file name). May be repeated", "");
+KNOB<string> KnobIncludeRoutine(KNOB_MODE_APPEND, "pintool", "-include-rtn", "", "Only analyze the instructions of the given routine. May be repeated", "");
+KNOB<UINT64> KnobMaxInstructions(KNOB_MODE_WRITEONCE, "pintool", "-max-instructions", "0", "Stop the analysis after the given number of executed instructions. If 0, there is no limit", "");
+KNOB<UINT32> KnobMaxTime(KNOB_MODE_WRITEONCE, "pintool", "-max-time", "0", "Stop the analysis after the given number of seconds. If 0, there is no limit", "");
+KNOB<UINT64> KnobMaxAccesses(KNOB_MODE_WRITEONCE, "pintool", "-max-accesses", "0", "Stop the analysis after the given number of traced memory accesses. If 0, there is no limit", "");
+KNOB<string> KnobBudgetAction(KNOB_MODE_WRITEONCE, "pintool", "-budget-action", "EXIT", "Specify what to do once the report has been written because a budget is exhausted: EXIT (terminate the application) or DETACH (let it go on without instrumentation)", "");
+KNOB<string> KnobRange(KNOB_MODE_APPEND, "pintool", "-range", "", "Only analyze the instructions in the given range, specified as [<image>:]<start>-<end> (offsets from the image load address if the image is specified). May be repeated", "");
+KNOB<UINT64> KnobMemBudget(KNOB_MODE_WRITEONCE, "pintool", "-mem-budget", "0", "Specify the maximum size (in MB) of the traced accesses kept in memory. Above it, the least recently updated ones are moved to files in the directory of the report until the end of the execution. If 0, there is no limit", "");
+KNOB<UINT32> KnobMaxReadContexts(KNOB_MODE_WRITEONCE, "pintool", "-max-read-contexts", "1024", "Specify the maximum number of distinct contexts (i.e. last writes to the memory read) in which the uninitialized reads of an instruction are stored. Reads in further contexts are only counted. If 0, there is no limit", "");
+KNOB<bool> KnobAdaptive(KNOB_MODE_WRITEONCE, "pintool", "-adaptive", "false", "If enabled, instructions which reached the maximum number of contexts of their uninitialized reads (see --max-read-contexts) are instrumented again with a cheaper routine which only keeps the shadow memory consistent", "");
+KNOB<string> KnobShadowHugePages(KNOB_MODE_WRITEONCE, "pintool", "-shadow-huge-pages", "OFF", "Specify whether the shadow memory is backed by huge pages: OFF, THP (transparent huge pages) or HUGETLB (huge pages reserved by the system, falling back to THP if they are not available)", "");
+KNOB<bool> KnobAnalyzeMemRoutines(KNOB_MODE_WRITEONCE, "pintool", "-analyze-mem-routines", "false", "If enabled, the instructions of the libc routines copying or setting memory (memcpy, memmove, memset, bzero and their variants) are analyzed one by one, rather than replacing each call with a single update of the shadow memory", "");
+KNOB<bool> KnobAnalyzeStrRoutines(KNOB_MODE_WRITEONCE, "pintool", "-analyze-str-routines", "false", "If enabled, the reads performed by the libc routines operating on strings (str*, stp* and wcs* routines and their variants) are analyzed as any other read, and are subject to the string optimization heuristic", "");
+KNOB<string> KnobStats(KNOB_MODE_WRITEONCE, "pintool", "-stats", "", "Specify the path of the JSON file where statistics about the analysis (counters, sizes of the data structures and timings) are written. If empty, statistics are not written", "");
 
 /* ===================================================================== */
 // Utilities
@@ -259,6 +389,17 @@ bool isStackAddress(THREADID tid, ADDRINT addr, ADDRINT currentSp, OPCODE opcode
     return addr >= currentSp - STACK_REDZONE_SIZE && addr <= threadInfos[tid];
 }
 
+// Returns the shadow memory keeping the status of |addr|, or NULL if it is neither a stack nor a heap address
+ShadowBase* getShadowMemoryOf(THREADID tid, ADDRINT addr, ADDRINT currentSp){
+    if(isStackAddress(tid, addr, currentSp, XED_ICLASS_INVALID, AccessType::READ))
+        return stack.getPtr();
+
+    if(HeapType heapType = isHeapAddress(addr))
+        return heapType.isNormal() ? heap.getPtr() : getMmapShadowMemory(heapType.getShadowMemoryIndex());
+
+    return NULL;
+}
+
 // Returns true if the set |s| contains at least a full overlap for AccessIndex |targetAI| which is also an
 // uninitialized read access.
 // NOTE: this differs from function "containsReadIns" as here the set passed as argument may contain also
@@ -282,129 +423,6 @@ bool containsReadIns(const AccessIndex& ai){
     return containsUninitializedRead.find(ai) != containsUninitializedRead.end();
 }
 
-// The returned pair contains the bounds of the interval of bytes written
-// by the access pointed to by |v_it| which overlap with the access represented by |currentSetAI|.
-// Note that this function allocates dynamically the new pair and returns its pointer.
-// This allocation will be deleted afterwards, when the tool writes the binary report.
-std::pair<unsigned, unsigned>* getOverlappingWriteInterval(const AccessIndex& currentSetAI, set<PartialOverlapAccess>::iterator& v_it){
-    int overlapBeginning = v_it->getAddress() - currentSetAI.getFirst();
-    if(overlapBeginning < 0)
-        overlapBeginning = 0;
-    int overlapEnd = min(v_it->getAddress() + v_it->getSize() - 1 - currentSetAI.getFirst(), currentSetAI.getSecond() - 1);
-    return new pair<unsigned, unsigned>(overlapBeginning, overlapEnd);
-}
-
-// Returns true if the write access pointed to by |writeAccess| writes at least 1 byte that is later read
-// by the uninitialized read pointed to by |readAccess|.
-// The function is quite complex (linear w.r.t. the number of accesses stored), as it requires to scan every access starting from |writeAccess| until |readAccess| (note that they
-// are in execution order). 
-// As soon as we find out the write has been completely overwritten before the read is reached, the function returns false.
-// If when we reach the read, it reads at least 1 byte written by the write and never overwritten, it returns true.
-// If the read only reads bytes that have been overwritten, but the write is not completely overwritten, false is returned anyway.
-bool isReadByUninitializedRead(set<PartialOverlapAccess>::iterator& writeAccess, set<PartialOverlapAccess>::iterator& readAccess){
-    ADDRINT writeStart = writeAccess->getAddress();
-    UINT32 writeSize = writeAccess->getSize();
-
-    // Determine the portion of the write access that overlaps with the considered set
-    int overlapBeginning = readAccess->getAddress() - writeStart;
-    if(overlapBeginning < 0)
-        overlapBeginning = 0;
-    int overlapEnd = min(readAccess->getAddress() + readAccess->getSize() - 1 - writeStart, writeSize - 1);
-
-    // Update writeStart, writeEnd and writeSize to consider only the portion of the write that
-    // overlaps the considered set
-    writeStart += overlapBeginning;
-    writeSize = overlapEnd - overlapBeginning + 1;
-    ADDRINT writeEnd = writeStart + writeSize - 1;
-
-    #ifdef DEBUG
-        isReadLogger << "[LOG]: 0x" << std::hex << readAccess->getAddress() << " - " << std::dec << readAccess->getSize() << endl;
-        isReadLogger << "[LOG]: " << std::hex << writeAccess->getDisasm() << " writes " << std::dec << writeSize << " B @ 0x" << std::hex << writeStart << endl;
-    #endif
-
-    set<PartialOverlapAccess>::iterator following = writeAccess;
-    ++following;
-
-    unsigned int numOverwrittenBytes = 0;
-    bool* overwrittenBytes = new bool[writeSize];
-
-    for(UINT32 i = 0; i < writeSize; ++i){
-        overwrittenBytes[i] = false;
-    }
-
-    set<PartialOverlapAccess>::iterator end = readAccess;
-    ++end;
-    while(following != end){
-
-        ADDRINT folStart = following->getAddress();
-        ADDRINT folEnd = folStart + following->getSize() - 1;
-
-        // Following access bounds are outside write access bounds. It can't overlap, skip it.
-        if(folStart > writeEnd || folEnd < writeStart){
-            ++following;
-            continue;
-        }
-
-        overlapBeginning = folStart - writeStart;
-        if(overlapBeginning < 0)
-            overlapBeginning = 0;
-
-        overlapEnd = min(folEnd - writeStart, writeSize - 1);
-
-        // If |following| is the uninitialized read access, check if it reads at least a not overwritten byte of 
-        // |writeAccess|
-        if(following == readAccess){
-            #ifdef DEBUG
-                isReadLogger << "[LOG]: " << following->getDisasm() << " reads bytes [" << std::dec << overlapBeginning << " ~ " << overlapEnd << "]" << endl;
-            #endif
-
-            // Check if the read access reads any byte that is not overwritten
-            // by any other write access
-            for(int i = overlapBeginning; i <= overlapEnd; ++i){
-                if(!overwrittenBytes[i]){
-                    #ifdef DEBUG
-                        isReadLogger << "[LOG]: " << following->getDisasm() << " reads a byte of the write" << endl;
-                    #endif
-                    // Read access reads a not overwritten byte.
-                    delete[] overwrittenBytes;
-                    return true;
-                }
-            }
-        }
-
-        // If |following| is a write access, update the byte map overwrittenBytes to true where needed.
-        // If |writeAccess| has been completely overwritten, it can't be read by any other access, so return false.
-        if(following->getType() == AccessType::WRITE){
-            #ifdef DEBUG
-                isReadLogger << "[LOG]: " << following->getDisasm() << " overwrites bytes [" << std::dec << overlapBeginning << " ~ " << overlapEnd << "]" << endl;
-            #endif
-
-            for(int i = overlapBeginning; i <= overlapEnd; ++i){
-                if(!overwrittenBytes[i])
-                    ++numOverwrittenBytes;
-                overwrittenBytes[i] = true;
-            }
-            // The write access bytes have been completely overwritten by another write access
-            // before any read access could read them.
-            if(numOverwrittenBytes == writeSize){
-                #ifdef DEBUG
-                    isReadLogger << "[LOG]: write access completely overwritten" << endl << endl << endl;
-                #endif
-                delete[] overwrittenBytes;
-                return false;
-            }
-        }
-        
-        ++ following;
-    }
-    // |writeAccess| has not been completely overwritten, but no uninitialized read access reads its bytes.
-    #ifdef DEBUG
-        isReadLogger << "[LOG]: write access not completely overwritten, but never read" << endl << endl << endl;
-    #endif
-    delete[] overwrittenBytes;
-    return false;
-}
-
 // Utility function that dumps all the memory accesses recorded during application's execution
 // to a file named memtrace.log
 void dumpMemTrace(map<AccessIndex, set<MemoryAccess>> fullOverlaps){
@@ -440,17 +458,40 @@ void print_profile(std::ostream& stream, const char* msg){
         << " - " << msg << endl;
 }
 
+/*
+Move the least recently updated groups of accesses to a spill segment, as the access store exceeds its budget.
+If the segment can't be written, the access store is kept in memory from now on.
+*/
+void spillAccessStore(){
+    long long spilledGroups = accessSpill.spill(memAccesses);
+    if(spilledGroups < 0){
+        *out << "Can't write spill segment: memory budget disabled" << endl;
+        accessSpill.disable();
+        return;
+    }
+
+    stats.add(Stats::SPILLED_GROUPS, spilledGroups);
+}
+
 void storeMemoryAccess(const AccessIndex& ai, const MemoryAccess& ma){
     static MemoryAccess::MAHasher hasher;
+    bool inserted = true;
     const auto& overlapSet = memAccesses.find(ai);
-    if(overlapSet != memAccesses.end()){
-        overlapSet->second.insert(ma);
+    bool isNewGroup = overlapSet == memAccesses.end();
+    if(!isNewGroup){
+        inserted = overlapSet->second.insert(ma).second;
     }
     else{
         unordered_set<MemoryAccess, MemoryAccess::MAHasher> v;
         v.insert(ma);
         memAccesses[ai] = v;
     }
+
+    if(inserted){
+        accessSpill.accessStored(ma, isNewGroup);
+        if(accessSpill.isOverBudget())
+            spillAccessStore();
+    }
 }
 
 void storeMemoryAccess(set<tag_t>& tags){
@@ -521,6 +562,7 @@ VOID CallocBefore(ADDRINT nmemb, ADDRINT size){
         return;
 
     mallocRequestedSize = nmemb * size;
+    callocRequestedSize = nmemb * size;
     mallocCalled = true;
 }
 
@@ -589,7 +631,12 @@ VOID FreeAfter(ADDRINT ptr){
     ADDRINT page_start = ptr & ~(PAGE_SIZE - 1);
     if(freeBlockSize == mmapMallocated[page_start]){
         mmapMallocated[page_start] = 0;
-        mmapShadows.erase(page_start);
+        // Shadow pages are given back to the pool, to be reused by the next allocations
+        auto shadowIter = mmapShadows.find(page_start);
+        if(shadowIter != mmapShadows.end()){
+            shadowIter->second.freeMemory();
+            mmapShadows.erase(shadowIter);
+        }
     }
 
     if(!removedThroughBrk){
@@ -633,15 +680,51 @@ VOID ReallocBefore(ADDRINT ptr, ADDRINT size){
     freeBlockSize = malloc_get_block_size(malloc_get_block_beginning(oldReallocPtr));
 }
 
+// Saves the status of the bytes copied by realloc from the old block to |reallocShadow|. Must be called before the old block is freed.
+void saveReallocCopy(){
+    HeapType type = isHeapAddress(reallocCopySrc);
+    if(reallocCopySize == 0 || !type.isValid())
+        return;
+
+    ShadowBase* srcShadow = type.isNormal() ? heap.getPtr() : getMmapShadowMemory(type.getShadowMemoryIndex());
+    if(reallocShadow == NULL)
+        reallocShadow = new HeapShadow(HeapEnum::MMAP);
+    reallocShadow->setBaseAddr(reallocCopySrc);
+    reallocShadow->copyRange(reallocCopySrc, *srcShadow, reallocCopySrc, reallocCopySize);
+    reallocCopySaved = true;
+
+    // Pending reads are kept by address, so they can be moved at once
+    copyStoredPendingReads(reallocCopySrc, reallocCopyDst, reallocCopySize);
+}
+
+void clearReallocCopy(){
+    if(reallocCopySaved)
+        reallocShadow->freeMemory();
+    reallocCopySaved = false;
+    reallocCopySize = 0;
+}
+
+// Copies the status saved by |saveReallocCopy| to the new block, whose shadow memory is |dstShadow|
+void applyReallocCopy(ShadowBase* dstShadow){
+    if(reallocCopySaved)
+        dstShadow->copyRange(reallocCopyDst, *reallocShadow, reallocCopySrc, reallocCopySize);
+    clearReallocCopy();
+}
+
 // Called right after malloc or calloc or realloc is executed
 VOID MallocAfter(ADDRINT ret)
 {   
     if(ret == 0)
         return;
 
+    // Pointer returned to the application (|ret| is moved to the beginning of the block below)
+    ADDRINT userPtr = ret;
+
     // If this is a malloc performed by a call to realloc and the returned ptr
     // is different from the previous ptr, the previous ptr has been freed.
     if(oldReallocPtr != 0 && oldReallocPtr != ret){
+        saveReallocCopy();
+
         // Increasing nestedCalls allows to avoid clearing |mallocTemporaryWriteStorage| during the 
         // call to |FreeAfter|, so that we won't remove from the map writes to be stored 
         // performed during the call to Malloc/Realloc
@@ -688,6 +771,7 @@ VOID MallocAfter(ADDRINT ret)
         // at least to create the corresponding shadow memory page, if it does not exist yet, but we'll
         // set the allocated areas to be ignored as initialized, and we'll never reset them.
         if(!entryPointExecuted && isSingleChunk){
+            newShadowMem.freeMemory();
             mallocTemporaryWriteStorage.clear();
             return;
         }
@@ -763,7 +847,9 @@ VOID MallocAfter(ADDRINT ret)
         const AccessIndex& ai = iter->first;
         const MemoryAccess& ma = iter->second;
         if(HeapType type = isHeapAddress(ai.getFirst())){
-            lastWriteInstruction[ai] = ma;
+            // Writes of excluded instructions (see |excludedWrite|) have no disassembly and are never tracked as last writes
+            if(ma.getDisasmPtr() != NULL)
+                lastWriteInstruction[ai] = ma;
             if(type.isNormal()){
                 currentShadow = heap.getPtr();
             }
@@ -774,6 +860,16 @@ VOID MallocAfter(ADDRINT ret)
         }
     }
     mallocTemporaryWriteStorage.clear();
+
+    // Memory returned by calloc is zeroed, but the allocator skips writing it when it comes from fresh pages (e.g.
+    // a block allocated through mmap), so it is set as initialized at once
+    if(callocRequestedSize != 0){
+        currentShadow = heapShadow;
+        AccessIndex ai(userPtr, callocRequestedSize);
+        insHandler.handle(ai);
+    }
+
+    applyReallocCopy(heapShadow);
 }
 
 VOID MemalignAfter(){
@@ -812,7 +908,9 @@ VOID mallocRet(CONTEXT* ctxt){
     }
 
     oldReallocPtr = 0;
+    clearReallocCopy();
     mallocCalled = false;
+    callocRequestedSize = 0;
     memalignCalled = false;
     memalignPtr = NULL;
     mmapMallocCalled = false;
@@ -826,10 +924,36 @@ VOID mallocNestedCall(){
     ++nestedCalls;
 }
 
+// Used as an If analysis routine, so that it can be inlined
+ADDRINT isAllocatorRunning(){
+    return mallocCalled || freeCalled || memalignCalled;
+}
+
+/*
+    Code executed before the entry point (i.e. the loader and the initialization routines of the libraries) is only
+    instrumented to keep track of allocations (see |InstrumentPreEntryInstruction|).
+    As soon as the application starts, that instrumentation is discarded, so that the same code is fully instrumented
+    the next time it is executed.
+*/
+VOID setEntryPointExecuted(){
+    entryPointExecuted = true;
+    PIN_RemoveInstrumentation();
+}
+
+// Discards the instrumentation of the instruction at |ip|, so that the next time it is executed it is instrumented
+// again as an excluded instruction (see |adaptiveInstrumentation|). The trace being executed is not affected.
+VOID saturateInstruction(ADDRINT ip){
+    if(!saturatedInstructions.insert(ip).second)
+        return;
+
+    stats.increment(Stats::SATURATED_INSTRUCTIONS);
+    PIN_RemoveInstrumentationInRange(ip, ip);
+}
+
 // STRING OPTIMIZATION REMOVAL HEURISTIC CONDITION EVALUATION FUNCTIONS:
 // The following 2 functions compute the conditions to which the uninitialized read access is considered
 // to be a consequence of a string optimization and is, therefore, ignored
-bool hasOnlyEvenIntervals(set<std::pair<unsigned, unsigned>> intervals){
+bool hasOnlyEvenIntervals(const set<std::pair<unsigned, unsigned>>& intervals){
     for(const auto& interval : intervals){
         if((interval.second - interval.first + 1) % 2 != 0)
             return false;
@@ -837,7 +961,7 @@ bool hasOnlyEvenIntervals(set<std::pair<unsigned, unsigned>> intervals){
     return true;
 }
 
-bool initUpToNullByte(unsigned nulIndex, set<std::pair<unsigned, unsigned>> intervals){
+bool initUpToNullByte(unsigned nulIndex, const set<std::pair<unsigned, unsigned>>& intervals){
     auto firstInterval = intervals.begin();
 
     if(firstInterval->first > nulIndex)
@@ -904,6 +1028,29 @@ bool maybeStackClashMitigation(ADDRINT addr){
 }
 
 
+// Samples the sizes of the main data structures of the analysis (see Stats.h)
+void sampleStats(){
+    stats.sample(Stats::MEM_ACCESSES, memAccesses.size());
+    stats.sample(Stats::LAST_WRITES, lastWriteInstruction.size());
+    stats.sample(Stats::PENDING_READS, pendingUninitializedReads.size());
+    stats.sample(Stats::USED_TAGS, TagManager::getInstance().getUsedTagsCount());
+    stats.sample(Stats::FREE_TAGS, TagManager::getInstance().getFreeTagsCount());
+
+    size_t shadowPages = stack.getAllocatedPages() + heap.getAllocatedPages();
+    for(auto iter = mmapShadows.begin(); iter != mmapShadows.end(); ++iter){
+        shadowPages += iter->second.getAllocatedPages();
+    }
+    stats.sample(Stats::SHADOW_PAGES, shadowPages);
+    stats.sample(Stats::ACCESS_STORE_BYTES, accessSpill.getStoreBytes());
+
+    ShadowPagePool& pagePool = ShadowPagePool::getInstance();
+    size_t residentPages = pagePool.getMappedPages() - pagePool.getPooledPages() - stack.getTrimmedPages();
+    stats.sample(Stats::SHADOW_POOLED_PAGES, pagePool.getPooledPages());
+    stats.sample(Stats::SHADOW_RESIDENT_BYTES, residentPages * pagePool.getPageSize());
+    stats.sample(Stats::CONTEXT_FILTERS, readContextFilter.getTrackedInstructions());
+}
+
+
 VOID memtrace(  THREADID tid, CONTEXT* ctxt, AccessType type, ADDRINT ip, ADDRINT addr, UINT32 size, VOID* disasm_ptr,
                 UINT32 opcode_arg, VOID* srcRegsPtr, VOID* dstRegsPtr)
 {
@@ -958,7 +1105,7 @@ VOID memtrace(  THREADID tid, CONTEXT* ctxt, AccessType type, ADDRINT ip, ADDRIN
     // This is an application instruction
     if(ip >= textStart && ip <= textEnd){
         if(!entryPointExecuted){
-            entryPointExecuted = true;
+            setEntryPointExecuted();
         }
 
         // Compute the last executed application ip. This is useless when application code is executed, but may be useful
@@ -986,6 +1133,11 @@ VOID memtrace(  THREADID tid, CONTEXT* ctxt, AccessType type, ADDRINT ip, ADDRIN
     MemoryAccess ma(opcode, executedAccesses++, lastExecutedInstruction, ip, addr, spOffset, bpOffset, size, type, ins_disasm, currentShadow);
     AccessIndex ai(addr, size);
 
+    stats.increment(isWrite ? Stats::MEMORY_WRITES : Stats::MEMORY_READS);
+    if(stats.isEnabled() && (executedAccesses & (STATS_SAMPLE_INTERVAL - 1)) == 0){
+        sampleStats();
+    }
+
     #ifdef DEBUG
         mtrace <<
             "0x" << std::hex << ma.getIP() <<
@@ -996,12 +1148,11 @@ VOID memtrace(  THREADID tid, CONTEXT* ctxt, AccessType type, ADDRINT ip, ADDRIN
             "0x" << ma.getAddress() << endl;
     #endif
 
-    // The following static variables are used in order to verify if a read access has already been tracked with the same
-    // conditions (the same writes precedes it in an already tracked read accesses).
+    // The following variables are used in order to verify if a read access has already been tracked with the same
+    // conditions (the same writes precedes it in an already tracked read accesses, see ReadContextFilter).
     // If that's the case, we probably are inside a loop performing the very same read access more than once.
     // Note that this is enough to remove most of the duplicated groups of accesses. However, it is possible that some of them
     // are not deleted. We will perform a similar, more precise task after the program's execution terminated.
-    static unordered_map<MemoryAccess, unordered_set<size_t>, MemoryAccess::NoOrderHasher, MemoryAccess::Comparator> reportedGroups;
     static MemoryAccess::NoOrderHasher maHasher;
     list<REG>* dstRegs = static_cast<list<REG>*>(dstRegsPtr);
     list<REG>* srcRegs = static_cast<list<REG>*>(srcRegsPtr);
@@ -1056,10 +1207,12 @@ VOID memtrace(  THREADID tid, CONTEXT* ctxt, AccessType type, ADDRINT ip, ADDRIN
 
         // If the memory read is not an uninitialized read, simply propagate registers status
         if(uninitializedInterval == NULL){
-            if(pendingReadsExist)
+            if(pendingReadsExist){
+                stats.increment(Stats::PENDING_READ_PROPAGATIONS);
                 // If memory is fully initialized, this handler avoids considering memory at all, thus
                 // optimizing performance
                 InstructionHandler::getInstance().handle(opcode, srcRegs, dstRegs);
+            }
             lastStackAllocation.unsetRequiresProbeFlag();
         }
         else{
@@ -1069,6 +1222,7 @@ VOID memtrace(  THREADID tid, CONTEXT* ctxt, AccessType type, ADDRINT ip, ADDRIN
                 return;
             }
 
+            stats.increment(Stats::UNINITIALIZED_READS);
             ma.setUninitializedRead();
             ma.setUninitializedInterval(uninitializedInterval);
 
@@ -1123,13 +1277,30 @@ VOID memtrace(  THREADID tid, CONTEXT* ctxt, AccessType type, ADDRINT ip, ADDRIN
                 }
             }
 
+            // Reads performed by string routines usually load whole aligned blocks, extending outside of the string they
+            // operate on. Uninitialized bytes outside of the string are not relevant: the status of the read bytes is still
+            // propagated to the destination registers, but the read is not reported.
+            if(stringReadKind != StringRoutines::NONE){
+                uint8_t content[STRING_READ_MAX_SIZE];
+                StringRoutines::Frame* frame = stringRoutines.getFrame(sp);
+                if(
+                    frame != NULL && size <= STRING_READ_MAX_SIZE && PIN_SafeCopy(content, (void*) addr, size) == size &&
+                    StringRoutines::isOverRead(addr, content, ma.computeIntervals(), stringReadKind, *frame)
+                ){
+                    ma.setAsInitialized();
+                    InstructionHandler::getInstance().handle(opcode, ma, srcRegs, dstRegs);
+                    free(uninitializedInterval);
+                    stats.increment(Stats::STRING_OVERREAD_DROPS);
+                    return;
+                }
+            }
             // This is an heuristics applied in order to reduce the number of reported uninitialized reads
             // by avoiding reporting those not very significant.
             // More specifically, this is done to try and avoid reporting those uninitialized read
             // accesses performed due to the optimization of strings operations.
             // Being an heuristics, this is not always precise, and may lead to false negatives (e.g. if memcpy is 
             // is implemented using SIMD extensions as well, memcpys may be lost).
-            if(heuristicEnabled && size >= 16 && opcode != XED_ICLASS_SYSCALL_AMD && (!heuristicLibsOnly || ip < textStart || ip > textEnd)){
+            else if(heuristicEnabled && size >= 16 && opcode != XED_ICLASS_SYSCALL_AMD && (!heuristicLibsOnly || ip < textStart || ip > textEnd)){
                 set<std::pair<unsigned, unsigned>> intervals = ma.computeIntervals();
 
                 if(intervals.size() == 1){
@@ -1137,148 +1308,103 @@ VOID memtrace(  THREADID tid, CONTEXT* ctxt, AccessType type, ADDRINT ip, ADDRIN
                     bool isCompletelyUninitialized = (interval.first == 0 && interval.second == size - 1);
 
                     if(isCompletelyUninitialized && heuristicAlreadyApplied){
+                        stats.increment(Stats::HEURISTIC_DROPS);
                         return;
                     }
                 }
 
                 heuristicAlreadyApplied = false;
 
-                char* content = (char*) malloc(sizeof(char) * size);
-                PIN_SafeCopy(content, (void*) addr, size);
-
                 // Look for an initialized nul byte in the access. If there's no initialized nul byte ('\0'), we
                 // will report the access, as it is possible that either this is not a string operation or the 
                 // string has not been initialized or a buffer overflow may be happening (e.g. the absence of '\0' in an 
                 // uninitialized read may imply the fact that a string terminator is missing, and we are reading 
                 // something more than the intended string).
-                char* nulPtr = strchr(content, '\0');
+                // The access is scanned one block at a time: the mask of its nul bytes is compared against the mask of
+                // its uninitialized bytes, so that the first nul byte which is also initialized is found at once.
+                uint8_t content[NUL_SCAN_BLOCK_SIZE];
+                bool nulFound = false;
                 unsigned nulIndex = 0;
-                set<uint8_t*> toFree;
-            
-                while(nulPtr != NULL){
-                    nulIndex = nulPtr - content;
 
-                    // A null byte has been found outside the boundaries of the considered access
-                    if(nulIndex >= size){
-                        nulPtr = NULL;
-                        break;
-                    }
-                    uint8_t* byteShadowCopy = getUninitializedInterval(addr + nulIndex, 1);
-                    toFree.insert(byteShadowCopy);
-                    
-                    // The null byte has been found and has been proven to be initialized
-                    if(byteShadowCopy == NULL){
-                        break;
-                    }
-                    nulPtr = strchr(nulPtr + 1, '\0');
-                }
+                for(unsigned blockStart = 0; blockStart < size && !nulFound; blockStart += NUL_SCAN_BLOCK_SIZE){
+                    unsigned blockSize = size - blockStart < NUL_SCAN_BLOCK_SIZE ? size - blockStart : NUL_SCAN_BLOCK_SIZE;
+                    PIN_SafeCopy(content, (void*) (addr + blockStart), blockSize);
 
-                // Free all unused allocated memory
-                for(uint8_t* ptr : toFree){
-                    free(ptr);
+                    uint64_t initializedNulBytes = zeroBytesMask(content, blockSize) & ~intervalsMask(intervals, blockStart, blockSize);
+                    if(initializedNulBytes != 0){
+                        nulFound = true;
+                        nulIndex = blockStart + __builtin_ctzll(initializedNulBytes);
+                    }
                 }
 
-                // At this point, nulPtr points to the first occurrence of '\0' that is also initialized,
-                // and nulIndex is the index of that character from the beginning of the considered access
-                if(nulPtr != NULL){
+                // At this point, nulIndex is the index of the first occurrence of '\0' that is also initialized
+                // from the beginning of the considered access
+                if(nulFound){
                     // If any of these conditions evaluated to true, it is likely to be executin some operation on a string
                     if(
                         !hasOnlyEvenIntervals(intervals) || // There's at least 1 interval with an odd number of uninitialized bytes (note that every other numeric type has at least 2 bytes in C)
                         initUpToNullByte(nulIndex, intervals) // Everything is initialized up to the first initialized null byte '\0'
                     ){
-                        free(content);
                         free(uninitializedInterval);
                         heuristicAlreadyApplied = true;
+                        stats.increment(Stats::HEURISTIC_DROPS);
                         return;
                     }
                 }
-                free(content);
             }
 
             containsUninitializedRead.insert(ai);
 
 
             size_t hash = maHasher(ma);
-            auto overlapGroup = reportedGroups.find(ma);
-
-            if(overlapGroup == reportedGroups.end()){
-                // Store the read access
-                storeOrLeavePending(opcode, ai, ma, srcRegs, dstRegs);
-
-                auto iter = lastWriteInstruction.lower_bound(AccessIndex(ma.getAddress(), 0));
-                ADDRINT iterFirstAccessedByte = iter->first.getFirst();
-                ADDRINT maFirstAccessedByte = ma.getAddress();
-                ADDRINT maLastAccessedByte = maFirstAccessedByte + ma.getSize() - 1;
-
-                while(iter != lastWriteInstruction.end()){
-                    
-                    // NOTE: according to how the map is sorted, it is not possible that |iterLastAccessedByte| < |maFirstAccessedByte|
-                    // However, we still need to check whether |iterFirstAccessedByte| is higher than |maLastAccessedByte|
-                    if(iterFirstAccessedByte > maLastAccessedByte){
-                        ++iter;
-                        iterFirstAccessedByte = iter->first.getFirst();
-                        continue;
-                    }
+            vector<std::pair<AccessIndex, MemoryAccess>> writes;
 
-                    const auto& lastWrite = iter->second;
+            auto iter = lastWriteInstruction.lower_bound(AccessIndex(ma.getAddress(), 0));
+            ADDRINT iterFirstAccessedByte = iter->first.getFirst();
+            ADDRINT maFirstAccessedByte = ma.getAddress();
+            ADDRINT maLastAccessedByte = maFirstAccessedByte + ma.getSize() - 1;
 
-                    // If the considered uninitialized read access reads any byte of this write,
-                    // use it to compute the hash representing the context where the read is happening
-                    hash = maHasher.lrot(hash, 4) ^ maHasher(lastWrite);
-                    // Store the write accesses permanently
-                    storeMemoryAccess(iter->first, iter->second);
+            while(iter != lastWriteInstruction.end()){
 
+                // NOTE: according to how the map is sorted, it is not possible that |iterLastAccessedByte| < |maFirstAccessedByte|
+                // However, we still need to check whether |iterFirstAccessedByte| is higher than |maLastAccessedByte|
+                if(iterFirstAccessedByte > maLastAccessedByte){
                     ++iter;
                     iterFirstAccessedByte = iter->first.getFirst();
+                    continue;
                 }
 
-                unordered_set<size_t> s;
-                s.insert(hash);
-                reportedGroups[ma] = s;
-            }
-            else{
-                vector<std::pair<AccessIndex, MemoryAccess>> writes;
-
-                auto iter = lastWriteInstruction.lower_bound(AccessIndex(ma.getAddress(), 0));
-                ADDRINT iterFirstAccessedByte = iter->first.getFirst();
-                ADDRINT maFirstAccessedByte = ma.getAddress();
-                ADDRINT maLastAccessedByte = maFirstAccessedByte + ma.getSize() - 1;
-
-                while(iter != lastWriteInstruction.end()){
-
-                    // NOTE: according to how the map is sorted, it is not possible that |iterLastAccessedByte| < |maFirstAccessedByte|
-                    // However, we still need to check whether |iterFirstAccessedByte| is higher than |maLastAccessedByte|
-                    if(iterFirstAccessedByte > maLastAccessedByte){
-                        ++iter;
-                        iterFirstAccessedByte = iter->first.getFirst();
-                        continue;
-                    }
-
-                    const auto& lastWrite = iter->second;
-
-                    // Compute the context hash
-                    hash = maHasher.lrot(hash, 4) ^ maHasher(lastWrite);
-                    // It is not sure yet we need to insert the read access, we must verify if 
-                    // it has already been stored with the same context
-                    writes.push_back(std::pair<AccessIndex, MemoryAccess>(iter->first, iter->second));
+                const auto& lastWrite = iter->second;
 
-                    ++iter;
-                    iterFirstAccessedByte = iter->first.getFirst();
-                }
+                // If the considered uninitialized read access reads any byte of this write,
+                // use it to compute the hash representing the context where the read is happening
+                hash = maHasher.lrot(hash, 4) ^ maHasher(lastWrite);
+                // It is not sure yet we need to insert the read access, we must verify if
+                // it has already been stored with the same context
+                writes.push_back(std::pair<AccessIndex, MemoryAccess>(iter->first, iter->second));
 
-                unordered_set<size_t>&  reportedHashes = overlapGroup->second;
+                ++iter;
+                iterFirstAccessedByte = iter->first.getFirst();
+            }
 
+            switch(readContextFilter.insert(ma.getActualIP(), hash)){
                 // If this is the first time this read access is happening within this context, store it
-                if(reportedHashes.find(hash) == reportedHashes.end()){
-                    // Store read access
+                case ReadContextFilter::NEW:
                     storeOrLeavePending(opcode, ai, ma, srcRegs, dstRegs);
 
+                    // Store the write accesses permanently
                     for(std::pair<AccessIndex, MemoryAccess>& write_access : writes){
                         storeMemoryAccess(write_access.first, write_access.second);
                     }
-
-                    reportedHashes.insert(hash);
-                }
+                    break;
+                case ReadContextFilter::DUPLICATE:
+                    stats.increment(Stats::DUPLICATED_READS);
+                    break;
+                case ReadContextFilter::LIMIT_REACHED:
+                    stats.increment(Stats::CONTEXT_LIMIT_DROPS);
+                    if(adaptiveInstrumentation)
+                        saturateInstruction(ma.getActualIP());
+                    break;
             }
         }
     }
@@ -1323,6 +1449,21 @@ VOID XrstorAnalysis( THREADID tid, CONTEXT* ctxt, ADDRINT ip, ADDRINT addr, UINT
     }
 }
 
+// Reads performed by the string routines (see StringRoutines.h) are analyzed by |memtrace| knowing the kind of strings
+// they operate on, rather than through the string optimization heuristic
+// Records the strings passed to a string routine (see StringRoutines::enterRoutine)
+VOID stringRoutineEntry(ADDRINT sp, ADDRINT firstArg, ADDRINT secondArg, UINT32 strings){
+    stringRoutines.enterRoutine(sp, firstArg, secondArg, strings);
+}
+
+VOID stringRoutineRead(THREADID tid, CONTEXT* ctxt, AccessType type, ADDRINT ip, ADDRINT addr, UINT32 size, VOID* disasm_ptr,
+                        UINT32 opcode, VOID* srcRegs, VOID* dstRegs, UINT32 kind)
+{
+    stringReadKind = (StringRoutines::Kind) kind;
+    memtrace(tid, ctxt, type, ip, addr, size, disasm_ptr, opcode, srcRegs, dstRegs);
+    stringReadKind = StringRoutines::NONE;
+}
+
 // Procedure call instruction pushes the return address on the stack. In order to insert it as initialized memory
 // for the callee frame, we need to first initialize a new frame and then insert the write access into its context.
 VOID procCallTrace( THREADID tid, CONTEXT* ctxt, AccessType type, ADDRINT ip, ADDRINT addr, UINT32 size, VOID* disasm_ptr,
@@ -1359,13 +1500,19 @@ VOID retTrace(  THREADID tid, CONTEXT* ctxt, AccessType type, ADDRINT ip, ADDRIN
 }
 
 
-// Given a set of SyscallMemAccess objects, generated by the SyscallHandler on system calls,
+// Given the SyscallMemAccess objects generated by the SyscallHandler on system calls,
 // add them to the recorded memory accesses
-void addSyscallToAccesses(THREADID tid, CONTEXT* ctxt, set<SyscallMemAccess>& v){
+void addSyscallToAccesses(THREADID tid, CONTEXT* ctxt, const SyscallEffects& effects){
+    if(effects.size() == 0)
+        return;
+
     #ifdef DEBUG
-        string* disasm = new string("syscall");
-        // Constant complexity insertion
-        disasmPtrs.insert(disasmPtrs.end(), disasm);
+        // Shared by every system call access, and released with the other disassembly strings
+        static string* disasm = NULL;
+        if(disasm == NULL){
+            disasm = new string("syscall");
+            disasmPtrs.insert(disasmPtrs.end(), disasm);
+        }
     #else
         string* disasm = NULL;
     #endif
@@ -1374,8 +1521,15 @@ void addSyscallToAccesses(THREADID tid, CONTEXT* ctxt, set<SyscallMemAccess>& v)
     // but opcode is simply used to be compared to the push opcode, so 
     // does not make any difference
     OPCODE opcode = XED_ICLASS_SYSCALL_AMD;
-    for(auto i = v.begin(); i != v.end(); ++i){
-        memtrace(tid, ctxt, i->getType(), syscallIP, i->getAddress(), i->getSize(), disasm, opcode, NULL, NULL);    
+    // A system call reads its input buffers before writing its output ones: replay reads first, so that a buffer
+    // which is both read and written (e.g. the length of an address in accept) is checked before being initialized
+    for(auto i = effects.begin(); i != effects.end(); ++i){
+        if(i->getType() == AccessType::READ)
+            memtrace(tid, ctxt, i->getType(), syscallIP, i->getAddress(), i->getSize(), disasm, opcode, NULL, NULL);
+    }
+    for(auto i = effects.begin(); i != effects.end(); ++i){
+        if(i->getType() == AccessType::WRITE)
+            memtrace(tid, ctxt, i->getType(), syscallIP, i->getAddress(), i->getSize(), disasm, opcode, NULL, NULL);
     }
 }
 
@@ -1576,6 +1730,69 @@ void removeDeletedMemoryWrites(ADDRINT addr, ADDRINT oldAddr){
 
 }
 
+void resetBudget();
+
+/*
+Return true if the system call about to be executed is the one the application must become a fork server at
+*/
+bool isForkServerSnapshotPoint(CONTEXT* ctxt, SYSCALL_STANDARD std, ADDRINT sysNum){
+    if(forkServerMode == ForkServerMode::OFF || forkServerStarted || !entryPointExecuted)
+        return false;
+
+    if(forkServerMode == ForkServerMode::ENTRY)
+        return true;
+
+    return sysNum == READ_NUM && PIN_GetSyscallArgument(ctxt, std, 0) == (ADDRINT) KnobForkServerFd.Value();
+}
+
+/*
+Wait for the next request from the fork server client and turn the current system call into a fork.
+If the client closed the control pipe, terminate the fork server.
+*/
+VOID forkServerNextChild(CONTEXT* ctxt, SYSCALL_STANDARD std){
+    std::string requestedReportPath;
+    if(!ForkServer::getInstance().nextRequest(forkServerInputPath, requestedReportPath)){
+        *out << "Fork server: no more requests" << endl;
+        PIN_ExitApplication(0);
+    }
+
+    if(!requestedReportPath.empty())
+        reportPath = requestedReportPath;
+
+    forkServerForking = true;
+    PIN_SetSyscallNumber(ctxt, std, FORK_NUM);
+}
+
+/*
+Called when the fork replacing the system call at the snapshot point returns.
+The child redirects the input file descriptor to the requested input, while the parent waits for it and notifies the client.
+Both of them re-execute the original system call: the parent will replace it by a new fork at the next request.
+*/
+VOID forkServerAfterFork(CONTEXT* ctxt, SYSCALL_STANDARD std){
+    forkServerForking = false;
+    INT64 pid = (INT64) PIN_GetSyscallReturn(ctxt, std);
+
+    ForkServer& forkServer = ForkServer::getInstance();
+    if(pid == 0){
+        forkServerParent = false;
+        resetBudget();
+        stats.restart(PIN_GetPid());
+        accessSpill.restart();
+        if(!forkServer.setupChild(forkServerInputPath, KnobForkServerFd.Value())){
+            *out << "Fork server: can't open input " << forkServerInputPath << endl;
+            // Nothing has been analyzed yet: terminate the child without running the application's exit handlers
+            // and the Fini callbacks
+            PIN_ExitProcess(1);
+        }
+    }
+    else{
+        forkServer.waitChild((pid_t) pid);
+    }
+
+    PIN_SetContextReg(ctxt, REG_INST_PTR, forkServerSyscallIP);
+    PIN_SetContextReg(ctxt, REG_GAX, forkServerSyscallNum);
+}
+
 VOID onSyscallEntry(THREADID threadIndex, CONTEXT* ctxt, SYSCALL_STANDARD std, VOID* v){
     if(std == SYSCALL_STANDARD_INVALID){
         *out << "Invalid syscall standard. This syscall won't be traced." << endl;
@@ -1587,6 +1804,27 @@ VOID onSyscallEntry(THREADID threadIndex, CONTEXT* ctxt, SYSCALL_STANDARD std, V
     syscallIP = actualIp;
     ADDRINT sysNum = PIN_GetSyscallNumber(ctxt, std);
 
+    // The system call at the snapshot point is not traced in the fork server (parent) process:
+    // the children will trace it when they re-execute it
+    if(forkServerParent){
+        forkServerNextChild(ctxt, std);
+        return;
+    }
+
+    if(isForkServerSnapshotPoint(ctxt, std, sysNum)){
+        forkServerStarted = true;
+        if(!ForkServer::getInstance().sendHello()){
+            *out << "Fork server: no client found. Going on with a single execution" << endl;
+        }
+        else{
+            forkServerSyscallNum = sysNum;
+            forkServerSyscallIP = actualIp;
+            forkServerParent = true;
+            forkServerNextChild(ctxt, std);
+            return;
+        }
+    }
+
     // If this is a call to mmap and a malloc has been called, but not returned yet,
     // this mmap is part of the malloc itself, which is allocating memory pages,
     // probably because the requested size is very high.
@@ -1630,17 +1868,23 @@ VOID onSyscallEntry(THREADID threadIndex, CONTEXT* ctxt, SYSCALL_STANDARD std, V
         }
     }
 
+    // syscallArgRegs[i] holds the registers of the first i arguments of a system call
+    static list<REG> syscallArgRegs[SYSCALL_MAX_ARGS + 1];
+    if(syscallArgRegs[SYSCALL_MAX_ARGS].empty()){
+        for(int i = 1; i <= SYSCALL_MAX_ARGS; ++i){
+            syscallArgRegs[i] = syscallArgRegs[i - 1];
+            syscallArgRegs[i].push_back(syscall_args[i - 1]);
+        }
+    }
+
     unsigned short argsCount = SyscallHandler::getInstance().getSyscallArgsCount(sysNum);
-    vector<ADDRINT> actualArgs;
-    list<REG> argRegs;
+    ADDRINT actualArgs[SYSCALL_MAX_ARGS];
     for(int i = 0; i < argsCount; ++i){
-        ADDRINT arg = PIN_GetSyscallArgument(ctxt, std, i);
-        actualArgs.push_back(arg);
-        argRegs.push_back(syscall_args[i]);
+        actualArgs[i] = PIN_GetSyscallArgument(ctxt, std, i);
     }
 
     // Check if any of the syscall argument registers contain a pending uninitialized read
-    checkSourceRegisters(&argRegs);
+    checkSourceRegisters(&syscallArgRegs[argsCount]);
 
     #ifdef DEBUG
         bool lastSyscallReturned = !SyscallHandler::getInstance().init();
@@ -1651,7 +1895,7 @@ VOID onSyscallEntry(THREADID threadIndex, CONTEXT* ctxt, SYSCALL_STANDARD std, V
         SyscallHandler::getInstance().init();
     #endif
 
-    SyscallHandler::getInstance().setSysArgs((unsigned short) sysNum, actualArgs);
+    SyscallHandler::getInstance().setSysArgs((unsigned short) sysNum, actualArgs, argsCount);
 }
 
 VOID onSyscallExit(THREADID threadIndex, CONTEXT* ctxt, SYSCALL_STANDARD std, VOID* v){
@@ -1661,6 +1905,11 @@ VOID onSyscallExit(THREADID threadIndex, CONTEXT* ctxt, SYSCALL_STANDARD std, VO
         return;
     }
 
+    if(forkServerForking){
+        forkServerAfterFork(ctxt, std);
+        return;
+    }
+
     ADDRINT sysRet = PIN_GetSyscallReturn(ctxt, std);
     #ifdef DEBUG
         *out << "Setting return value of the syscall" << endl;
@@ -1669,7 +1918,7 @@ VOID onSyscallExit(THREADID threadIndex, CONTEXT* ctxt, SYSCALL_STANDARD std, VO
     #ifdef DEBUG
         *out << "Getting system call memory accesses and resetting state" << endl << endl;
     #endif
-    set<SyscallMemAccess> accesses = SyscallHandler::getInstance().getReadsWrites();
+    const SyscallEffects& accesses = SyscallHandler::getInstance().getReadsWrites();
     addSyscallToAccesses(threadIndex, ctxt, accesses);
 }
 
@@ -1705,6 +1954,7 @@ VOID propagateRegisterStatus(UINT32 opcodeArg, VOID* srcRegsPtr, VOID* dstRegsPt
     list<REG>* dstRegs = static_cast<list<REG>*>(dstRegsPtr);
     OPCODE opcode = static_cast<OPCODE>(opcodeArg);
 
+    stats.increment(Stats::PENDING_READ_PROPAGATIONS);
     InstructionHandler::getInstance().handle(opcode, srcRegs, dstRegs);
 }
 
@@ -1733,11 +1983,133 @@ VOID incrementFpuStackIndex(){
     ShadowRegisterFile::getInstance().incrementFpuStackIndex();
 }
 
+/*
+    Analysis routines of the instructions excluded by the instrumentation filter (see InstrumentationFilter.h).
+    Their accesses are never reported, but the memory they write must still be marked as initialized, and the
+    stack frames they free must still be reset, otherwise the analyzed code would report false positives.
+*/
+VOID excludedWrite(THREADID tid, ADDRINT ip, ADDRINT sp, ADDRINT addr, UINT32 size, UINT32 opcode){
+    if(ip >= textStart && ip <= textEnd){
+        if(!entryPointExecuted)
+            setEntryPointExecuted();
+        lastExecutedInstruction = ip - loadOffset;
+    }
+
+    if(size == 0 || !entryPointExecuted)
+        return;
+
+    AccessIndex ai(addr, size);
+    bool isStackWrite = isStackAddress(tid, addr, sp, (OPCODE) opcode, AccessType::WRITE);
+    if(isStackWrite){
+        currentShadow = stack.getPtr();
+    }
+    else if(HeapType heapType = isHeapAddress(addr)){
+        currentShadow = heapType.isNormal() ? heap.getPtr() : getMmapShadowMemory(heapType.getShadowMemoryIndex());
+    }
+    // As in |memtrace|, writes performed by malloc outside of the known heap are stored until it completes
+    else if(mallocCalled || memalignCalled){
+        currentShadow = heap.getPtr();
+        mallocTemporaryWriteStorage[ai] = MemoryAccess((OPCODE) opcode, executedAccesses, lastExecutedInstruction, ip, addr, addr - sp, 0, size, AccessType::WRITE, NULL, currentShadow);
+        return;
+    }
+    else{
+        return;
+    }
+
+    stats.increment(Stats::EXCLUDED_WRITES);
+    InstructionHandler::getInstance().handle(ai);
+
+    // Heap writes performed by free must be re-executed after |FreeAfter| resets the freed block (see |memtrace|)
+    if((oldReallocPtr != 0 || freeCalled || memalignCalled) && !isStackWrite){
+        mallocTemporaryWriteStorage[ai] = MemoryAccess((OPCODE) opcode, executedAccesses, lastExecutedInstruction, ip, addr, addr - sp, 0, size, AccessType::WRITE, NULL, currentShadow);
+    }
+}
+
+VOID excludedRet(ADDRINT addr){
+    if(entryPointExecuted)
+        stack.reset(addr);
+}
+
+/*
+    Summary of a call to a routine copying or setting memory (see RoutineSummaries.h), applied when the routine is entered.
+    |dst|, |arg1| and |arg2| are the first 3 arguments of the routine, whose meaning depends on |kind|.
+    The status of the destination is updated at once, together with the pending reads stored in it. Memory which is neither
+    on the stack nor on the heap is considered initialized, so copying it initializes the destination.
+*/
+VOID summarizeRoutine(THREADID tid, ADDRINT sp, UINT32 kind, ADDRINT dst, ADDRINT arg1, ADDRINT arg2){
+    if(!entryPointExecuted)
+        return;
+
+    if(summaryRunning && sp == summarySp && dst == summaryArgs[0] && arg1 == summaryArgs[1] && arg2 == summaryArgs[2])
+        return;
+    summaryRunning = true;
+    summarySp = sp;
+    summaryArgs[0] = dst;
+    summaryArgs[1] = arg1;
+    summaryArgs[2] = arg2;
+
+    stats.increment(Stats::SUMMARIZED_CALLS);
+    pendingDirectMemoryCopy.setAsInvalid();
+
+    size_t size;
+    switch((RoutineSummaries::Kind) kind){
+        case RoutineSummaries::ZERO:
+            size = arg1;
+            break;
+        case RoutineSummaries::WIDE_SET:
+            size = arg2 * sizeof(wchar_t);
+            break;
+        default:
+            size = arg2;
+    }
+
+    if(size == 0)
+        return;
+
+    if(kind == RoutineSummaries::COPY && oldReallocPtr != 0 && isAllocatorRunning()){
+        reallocCopySrc = arg1;
+        reallocCopyDst = dst;
+        reallocCopySize = size;
+        return;
+    }
+
+    ShadowBase* dstShadow = getShadowMemoryOf(tid, dst, sp);
+    if(dstShadow == NULL)
+        return;
+
+    if(kind == RoutineSummaries::COPY){
+        copyStoredPendingReads(arg1, dst, size);
+
+        ShadowBase* srcShadow = getShadowMemoryOf(tid, arg1, sp);
+        if(srcShadow != NULL){
+            dstShadow->copyRange(dst, *srcShadow, arg1, size);
+            return;
+        }
+    }
+    else{
+        updateStoredPendingReads(dst, size);
+    }
+
+    dstShadow->initializeRange(dst, size);
+}
+
+VOID summarizedRet(ADDRINT addr){
+    summaryRunning = false;
+    excludedRet(addr);
+}
+
 /* ===================================================================== */
 // Instrumentation callbacks
 /* ===================================================================== */
 
+VOID PersistentRoutineEntry(CONTEXT* ctxt);
+VOID PersistentRoutineExit();
+
 VOID Image(IMG img, VOID* v){
+    StatsTimer timer(Stats::INSTRUMENTATION);
+
+    InstrumentationFilter::getInstance().onImageLoad(img);
+
     if(IMG_IsMainExecutable(img)){
         *out << "Main executable: " << IMG_Name(img) << endl;
         *out << "Entry Point: 0x" << std::hex << IMG_EntryAddress(img) << endl;
@@ -1832,6 +2204,63 @@ VOID Image(IMG img, VOID* v){
                        IARG_END);
         RTN_Close(freeRtn);
     }
+
+    // Instrument the routines copying or setting memory with their summaries, and record the routines operating on
+    // strings (whose reads are instrumented by |Instruction|) together with the strings passed to them
+    for(SEC sec = IMG_SecHead(img); SEC_Valid(sec); sec = SEC_Next(sec)){
+        for(RTN rtn = SEC_RtnHead(sec); RTN_Valid(rtn); rtn = RTN_Next(rtn)){
+            unsigned strings;
+            if(stringRoutines.addRoutine(rtn, strings) != StringRoutines::NONE){
+                RTN_Open(rtn);
+                RTN_InsertCall(rtn, IPOINT_BEFORE, (AFUNPTR) stringRoutineEntry,
+                                IARG_REG_VALUE, REG_STACK_PTR,
+                                IARG_FUNCARG_ENTRYPOINT_VALUE, 0,
+                                IARG_FUNCARG_ENTRYPOINT_VALUE, 1,
+                                IARG_UINT32, strings,
+                                IARG_END);
+                RTN_Close(rtn);
+                continue;
+            }
+
+            RoutineSummaries::Kind kind = routineSummaries.addRoutine(rtn);
+            if(kind == RoutineSummaries::NONE)
+                continue;
+
+            RTN_Open(rtn);
+            RTN_InsertCall(rtn, IPOINT_BEFORE, (AFUNPTR) summarizeRoutine,
+                            IARG_THREAD_ID,
+                            IARG_REG_VALUE, REG_STACK_PTR,
+                            IARG_UINT32, kind,
+                            IARG_FUNCARG_ENTRYPOINT_VALUE, 0,
+                            IARG_FUNCARG_ENTRYPOINT_VALUE, 1,
+                            IARG_FUNCARG_ENTRYPOINT_VALUE, 2,
+                            IARG_END);
+            RTN_Close(rtn);
+        }
+    }
+
+    // Find the routine to be executed in persistent mode. Only its first definition (usually the one in the main executable) is considered
+    static bool persistentRtnFound = false;
+    if(!persistentInputs.empty() && !persistentRtnFound){
+        RTN persistentRtn = RTN_FindByName(img, KnobPersistentFunction.Value().c_str());
+        if(RTN_Valid(persistentRtn)){
+            persistentRtnFound = true;
+            *out << "Persistent routine " << KnobPersistentFunction.Value() << " found in " << name << endl;
+            RTN_Open(persistentRtn);
+            RTN_InsertCall(persistentRtn, IPOINT_BEFORE, (AFUNPTR) PersistentRoutineEntry,
+                            IARG_CONTEXT,
+                            IARG_END);
+            RTN_InsertCall(persistentRtn, IPOINT_AFTER, (AFUNPTR) PersistentRoutineExit,
+                            IARG_END);
+            RTN_Close(persistentRtn);
+        }
+    }
+}
+
+VOID ImageUnload(IMG img, VOID* v){
+    InstrumentationFilter::getInstance().onImageUnload(img);
+    routineSummaries.onImageUnload(img);
+    stringRoutines.onImageUnload(img);
 }
 
 VOID OnThreadStart(THREADID tid, CONTEXT* ctxt, INT32 flags, VOID* v){
@@ -1974,8 +2403,129 @@ bool isStackAlloc(OPCODE opcode, list<REG>* dstRegs){
 }
 
 
-VOID Instruction(INS ins, VOID* v){
-    OPCODE opcode = INS_Opcode(ins);
+// Returns the registers explicitly written by |ins| (flags and the rep count register excluded), or NULL if there are none
+list<REG>* getWrittenRegisters(INS ins){
+    list<REG>* dstRegs = NULL;
+    REG repCountRegister = INS_RepCountRegister(ins);
+    for(UINT32 op = 0; op < INS_OperandCount(ins); ++op){
+        if(!INS_OperandIsReg(ins, op) || !INS_OperandWritten(ins, op))
+            continue;
+
+        REG reg = INS_OperandReg(ins, op);
+        if(REG_is_flags(reg) || (REG_valid(repCountRegister) && reg == repCountRegister))
+            continue;
+
+        if(dstRegs == NULL){
+            dstRegs = new list<REG>();
+            regsPtrs.push_back(dstRegs);
+        }
+        dstRegs->push_back(reg);
+    }
+
+    return dstRegs;
+}
+
+/*
+    Inserts the instrumentation shared by the instructions which are not fully analyzed (see the routines below):
+        - the FPU stack index is kept up to date;
+        - if |trackRegisters| is true, pending uninitialized reads are dropped from the overwritten registers;
+        - calls and returns of a running allocator are tracked, so that the allocation completes (see |mallocRet|).
+    If |retRoutine| is not NULL, it is called with the address of the return address before a return, and before the
+    end of the allocator is handled.
+*/
+VOID InstrumentLightweightInstruction(INS ins, OPCODE opcode, bool trackRegisters, AFUNPTR retRoutine){
+    if(isFpuPushInstruction(opcode)){
+        INS_InsertPredicatedCall(ins, IPOINT_BEFORE, (AFUNPTR) decrementFpuStackIndex, IARG_END);
+    }
+
+    list<REG>* dstRegs = trackRegisters ? getWrittenRegisters(ins) : NULL;
+    if(dstRegs != NULL){
+        INS_InsertPredicatedCall(
+            ins,
+            IPOINT_BEFORE,
+            (AFUNPTR) checkDestRegistersAnalysis,
+            IARG_UINT32, opcode,
+            IARG_PTR, dstRegs,
+            IARG_END
+        );
+    }
+
+    if(INS_IsProcedureCall(ins)){
+        INS_InsertIfPredicatedCall(ins, IPOINT_BEFORE, (AFUNPTR) isAllocatorRunning, IARG_END);
+        INS_InsertThenPredicatedCall(ins, IPOINT_BEFORE, (AFUNPTR) mallocNestedCall, IARG_END);
+    }
+
+    if(INS_IsRet(ins)){
+        if(retRoutine != NULL){
+            INS_InsertPredicatedCall(ins, IPOINT_BEFORE, retRoutine, IARG_MEMORYREAD_EA, IARG_END);
+        }
+        INS_InsertIfPredicatedCall(ins, IPOINT_BEFORE, (AFUNPTR) isAllocatorRunning, IARG_END);
+        INS_InsertThenPredicatedCall(ins, IPOINT_BEFORE, (AFUNPTR) mallocRet, IARG_CONTEXT, IARG_END);
+    }
+
+    if(isFpuPopInstruction(opcode)){
+        INS_InsertPredicatedCall(ins, IPOINT_BEFORE, (AFUNPTR) incrementFpuStackIndex, IARG_END);
+        if(opcode == XED_ICLASS_FUCOMPP || opcode == XED_ICLASS_FCOMPP){
+            INS_InsertPredicatedCall(ins, IPOINT_BEFORE, (AFUNPTR) incrementFpuStackIndex, IARG_END);
+        }
+    }
+}
+
+/*
+    Instruments an instruction excluded by the instrumentation filter. Only the updates required to keep the shadow
+    memory and the shadow registers consistent for the analyzed code are performed:
+        - written memory is marked as initialized;
+        - stack frames are reset on return;
+        - the updates shared with the other lightweight instrumentations (see |InstrumentLightweightInstruction|).
+    Allocators may be excluded too (e.g. --exclude-img libc.so.6), so their end is still tracked.
+*/
+VOID InstrumentExcludedInstruction(INS ins, OPCODE opcode){
+    InstrumentLightweightInstruction(ins, opcode, true, (AFUNPTR) excludedRet);
+
+    ADDRINT ip = INS_Address(ins);
+    if(INS_IsBranch(ins) && ip >= textStart && ip <= textEnd){
+        INS_InsertPredicatedCall(ins, IPOINT_BEFORE, (AFUNPTR) updateLastExecutedInstruction, IARG_INST_PTR, IARG_END);
+    }
+
+    if(INS_IsMemoryWrite(ins)){
+        INS_InsertPredicatedCall(
+            ins,
+            IPOINT_BEFORE,
+            (AFUNPTR) excludedWrite,
+            IARG_THREAD_ID,
+            IARG_INST_PTR,
+            IARG_REG_VALUE, REG_STACK_PTR,
+            IARG_MEMORYWRITE_EA,
+            IARG_MEMORYWRITE_SIZE,
+            IARG_UINT32, opcode,
+            IARG_END
+        );
+    }
+}
+
+/*
+    Instruments an instruction of a summarized routine (see RoutineSummaries.h). Its memory accesses are covered by the summary
+    applied when the routine is entered, so only registers, the FPU stack and the stack frames it frees are tracked, together
+    with the end of the routine itself and of the allocator calling it (e.g. realloc calling memcpy).
+*/
+VOID InstrumentSummarizedInstruction(INS ins, OPCODE opcode){
+    InstrumentLightweightInstruction(ins, opcode, true, (AFUNPTR) summarizedRet);
+}
+
+/*
+    Instruments an instruction executed before the entry point. Any memory access performed before the entry point
+    is ignored by the analysis routines, so it is enough to track the end of the allocations (whose heap blocks are
+    considered initialized) and the FPU stack index.
+*/
+VOID InstrumentPreEntryInstruction(INS ins, OPCODE opcode){
+    InstrumentLightweightInstruction(ins, opcode, false, NULL);
+}
+
+VOID Instruction(INS ins, VOID* v){
+    StatsTimer timer(Stats::INSTRUMENTATION);
+    stats.increment(Stats::INSTRUMENTED_INSTRUCTIONS);
+
+    OPCODE opcode = INS_Opcode(ins);
     INT32 ext = INS_Extension(ins);
     if(isSSEInstruction(ext)){
         sseInstructions.insert(opcode);
@@ -1988,6 +2538,29 @@ VOID Instruction(INS ins, VOID* v){
     if(INS_IsPrefetch(ins) || isEndbrInstruction(opcode) || INS_IsNop(ins))
         return;
 
+    ADDRINT insAddr = INS_Address(ins);
+    bool isApplicationInstruction = insAddr >= textStart && insAddr <= textEnd;
+    if(!entryPointExecuted && !isApplicationInstruction){
+        InstrumentPreEntryInstruction(ins, opcode);
+        return;
+    }
+
+    if(routineSummaries.isSummarized(insAddr)){
+        InstrumentSummarizedInstruction(ins, opcode);
+        return;
+    }
+
+    // Accesses performed by the loader are not reported (unless --keep-ld is used), so it is enough to keep
+    // the shadow memory consistent. The same holds for saturated instructions (see |adaptiveInstrumentation|).
+    if(
+        (ignoreLdInstructions && isLoaderInstruction(insAddr)) ||
+        !InstrumentationFilter::getInstance().isInstrumented(insAddr) ||
+        (adaptiveInstrumentation && saturatedInstructions.count(insAddr) != 0)
+    ){
+        InstrumentExcludedInstruction(ins, opcode);
+        return;
+    }
+
     /*
         If it is an XSAVE instruction (or one of its variants), it must be specifically handled,
         as Intel PIN won't tell us which registers are stored in memory.
@@ -2181,6 +2754,7 @@ VOID Instruction(INS ins, VOID* v){
 
         set<UINT32> readMemOperands;
         set<UINT32> writtenMemOperands;
+        StringRoutines::Kind stringKind = stringRoutines.getKind(ip);
 
         for(UINT32 memop = 0; memop < memoperands; memop++){ 
             // Read memory access
@@ -2221,6 +2795,25 @@ VOID Instruction(INS ins, VOID* v){
                     IARG_END
                 );
             }
+            else if(stringKind != StringRoutines::NONE){
+                INS_InsertPredicatedCall(
+                    ins,
+                    IPOINT_BEFORE,
+                    (AFUNPTR) stringRoutineRead,
+                    IARG_THREAD_ID,
+                    IARG_CONTEXT,
+                    IARG_UINT32, AccessType::READ,
+                    IARG_INST_PTR,
+                    IARG_MEMORYREAD_EA,
+                    IARG_MEMORYREAD_SIZE,
+                    IARG_PTR, disassembly,
+                    IARG_UINT32, opcode,
+                    IARG_PTR, explicitSrcRegs,
+                    IARG_PTR, dstRegs,
+                    IARG_UINT32, stringKind,
+                    IARG_END
+                );
+            }
             else{
                 INS_InsertPredicatedCall(
                     ins, 
@@ -2313,226 +2906,87 @@ VOID Instruction(INS ins, VOID* v){
     }
 }
 
-// Given an unordered_map containing all the traced memory accesses, obtain an ordered copy whose order is useful
-// to detect partial overlaps
-map<AccessIndex, set<MemoryAccess>> getOrderedCopy(unordered_map<AccessIndex, unordered_set<MemoryAccess, MemoryAccess::MAHasher>, AccessIndex::AIHasher> unorderedMap){
-    map<AccessIndex, set<MemoryAccess>> ret;
-
-    for(auto iter = unorderedMap.begin(); iter != unorderedMap.end(); ++iter){
-        set<MemoryAccess> orderedSet;
-        orderedSet.insert(iter->second.begin(), iter->second.end());
-        ret[iter->first] = orderedSet;
-    }
-
-    return ret;
-}
-
-/*!
- * Generate overlap reports.
- * This function is called when the application exits.
- */
-VOID Fini(INT32 code, VOID *v)
-{   
-    std::string reportPath = KnobOutputFile.Value();
-    std::ofstream memOverlaps(reportPath.c_str(), std::ios_base::binary);
-
-    map<AccessIndex, set<MemoryAccess>> fullOverlaps = getOrderedCopy(memAccesses);
+/*
+Write the binary report of the accesses currently held by the access store into |reportPath|
+*/
+void writeReport(const std::string& reportPath){
+    // Accesses still in memory. Groups moved to spill segments (if any) are merged with them by AccessStream.
+    vector<OrderedAccessEntry> inMemory = getOrderedView(memAccesses);
+    vector<SpillSegment>& segments = accessSpill.getSegments();
 
     #ifdef DEBUG
-        print_profile(applicationTiming, "Application exited");
         std::ofstream partialOverlapsLog("partialOverlaps.dbg");
     #endif
 
-    // We take the size of any register, as they have the same size (excluding SIMD extension registers)
-    int regSize = REG_Size(REG_STACK_PTR);
-    memOverlaps.write("\x00\x00\x00\x00", 4);
-    memOverlaps << regSize << ";";
-    for(auto iter = imgs_base.begin(); iter != imgs_base.end(); ++iter){
-        memOverlaps << iter->first << ";";
-        memOverlaps.write(reinterpret_cast<const char*>(&(iter->second)), regSize);
-    }
-    // End of loaded libraries base addresses
-    memOverlaps.write("\x00\x00\x00\x05", 4);
-    memOverlaps.write(reinterpret_cast<const char*>(&threadInfos[0]), regSize);
+    ReportWriter memOverlaps(reportPath, imgs_base, threadInfos[0], budgetExhausted ? ReportFormat::TRUNCATED : 0);
+    // In persistent mode, the following iterations are analyzed from the beginning
+    budgetExhausted = false;
 
     #ifdef DEBUG
         print_profile(analysisProfiling, "Starting writing full overlaps report");
     #endif
 
-    /*
-    The following iterator, and the boolean flag right inside the next "for" loop scope, are
-    used in order to optimize the search of partially overlapping accesses happening at an address lower than the
-    address of an access set (denoted as "it" in the loop). Without using these 2 values, we would have
-    needed to restart the search from fullOverlaps.begin(), which may require more time.
-    */
-    std::map<AccessIndex, set<MemoryAccess>>::iterator firstPartiallyOverlappingIterator = fullOverlaps.begin();
-    for(std::map<AccessIndex, set<MemoryAccess>>::iterator it = fullOverlaps.begin(); it != fullOverlaps.end(); ++it){
+    AccessStream fullOverlaps(inMemory, segments);
+    StreamedGroup group;
+    // Accesses of the set, ordered by execution order
+    OrderedAccessGroup v;
+    while(fullOverlaps.next(group, v)){
         #ifdef DEBUG
             print_profile(analysisProfiling, "\tConsidering new set");
         #endif
 
-        bool firstPartiallyOverlappingIteratorUpdated = false;
-        // Copy all elements in another set ordered by execution order
-        set<MemoryAccess, MemoryAccess::ExecutionComparator> v(it->second.begin(), it->second.end());
+        const AccessIndex& ai = group.ai;
 
         // If the set contains at least 1 uninitialized read, write it into the binary report
 
-        // NOTE: the report is written in a binary format, as it should be faster than writing a well formatted
+        // NOTE: the report is written in a binary format (see ReportFormat.h), as it should be faster than writing a well formatted
         // textual report. Textual human-readable reports are generated from the binary reports
         // through an external parser.
-        if(containsReadIns(it->first)){
-            // |tmp| is used as a temporary ADDRINT copy of ADDRINT values we need to copy in the binary report.
-            // This is needed because we need to pass a pointer to the write method.
-            ADDRINT tmp = it->first.getFirst();
-            memOverlaps.write(reinterpret_cast<const char*>(&tmp), regSize);
-            memOverlaps << it->first.getSecond() << ";";
-
-            for(set<MemoryAccess>::iterator v_it = v.begin(); v_it != v.end(); v_it++){
+        if(containsReadIns(ai)){
+            memOverlaps.beginSet(ai);
+
+            for(const MemoryAccess* ma : v){
                 // Do not report instructions coming from the loader's library
-                if(ignoreLdInstructions && isLoaderInstruction(v_it->getActualIP()))
+                if(ignoreLdInstructions && isLoaderInstruction(ma->getActualIP()))
                     continue;
                 
-                memOverlaps.write((v_it->getIsUninitializedRead() ? "\x0a" : "\x0b"), 1);
-                tmp = v_it->getIP();
-                memOverlaps.write(reinterpret_cast<const char*>(&tmp), regSize);
-                tmp = v_it->getActualIP();
-                memOverlaps.write(reinterpret_cast<const char*>(&tmp), regSize);
-                memOverlaps << v_it->getDisasm() << ";";
-                memOverlaps.write((v_it->getType() == AccessType::WRITE ? "\x1a" :"\x1b"), 1);
-                memOverlaps << v_it->getSize() << ";";
-                memOverlaps.write(v_it->isStackAccess() ? "\x1c" : "\x1d", 1);
-                memOverlaps << v_it->getSPOffset() << ";";
-                memOverlaps << v_it->getBPOffset() << ";";
-                if(v_it->getIsUninitializedRead()){
-                    set<std::pair<unsigned, unsigned>> intervals = v_it->computeIntervals();
-
-                    memOverlaps << intervals.size() << ";";
-                    for(const std::pair<unsigned, unsigned>& p : intervals){
-                        memOverlaps << p.first << ";";
-                        memOverlaps << p.second << ";";
-                    }
+                // Intervals are reported only for uninitialized reads
+                set<std::pair<unsigned, unsigned>> intervals;
+                if(ma->getIsUninitializedRead()){
+                    intervals = ma->computeIntervals();
                 }
-            }
-
-            // End of full overlap entries
-            memOverlaps.write("\x00\x00\x00\x01", 4);
-
-            #ifdef DEBUG
-                print_profile(analysisProfiling, "\tFilling set's partial overlaps");
-            #endif
 
-            // Fill the partial overlaps map
-
-            // Always create a set to any set in the fullOverlaps map. We will add to the set at least all the
-            // instructions contained in the fullOverlaps[it->first] set
-            set<MemoryAccess>& vect = partialOverlaps[it->first];
-
-            // Insert backward AccessIndex partially overlapping
-            std::map<AccessIndex, set<MemoryAccess>>::iterator partialOverlapIterator = firstPartiallyOverlappingIterator;
-            ADDRINT accessedAddress = it->first.getFirst();
-            ADDRINT lastAccessedByte = partialOverlapIterator->first.getFirst() + partialOverlapIterator->first.getSecond() - 1;
-            while(partialOverlapIterator->first != it->first){
-                if(lastAccessedByte >= accessedAddress){
-                    vect.insert(partialOverlapIterator->second.begin(), partialOverlapIterator->second.end());
-                    if(!firstPartiallyOverlappingIteratorUpdated){
-                        firstPartiallyOverlappingIteratorUpdated = true;
-                        firstPartiallyOverlappingIterator = partialOverlapIterator;
-                    }
-                }
-                ++partialOverlapIterator;
-                lastAccessedByte = partialOverlapIterator->first.getFirst() + partialOverlapIterator->first.getSecond() - 1;
+                memOverlaps.addEntry(*ma, false, intervals);
             }
 
-            // Insert forward AccessIndex partially overlapping
-            ++partialOverlapIterator;
-            accessedAddress = partialOverlapIterator->first.getFirst();
-            lastAccessedByte = it->first.getFirst() + it->first.getSecond() - 1;
-            while(partialOverlapIterator != fullOverlaps.end() && accessedAddress <= lastAccessedByte){
-                vect.insert(partialOverlapIterator->second.begin(), partialOverlapIterator->second.end());
-
-                ++partialOverlapIterator;
-                accessedAddress = partialOverlapIterator->first.getFirst();
-            }
+            memOverlaps.endSet();
         }
     }
-    // End of full overlaps
-    memOverlaps.write("\x00\x00\x00\x02", 4);
+    memOverlaps.endFullOverlaps();
 
     #ifdef DEBUG
         print_profile(analysisProfiling, "Starting writing partial overlaps report");
     #endif
 
     // Write binary report for partial overlaps
-    for(std::map<AccessIndex, set<MemoryAccess>>::iterator it = partialOverlaps.begin(); it != partialOverlaps.end(); ++it){
+    OverlapWindow partialOverlaps(inMemory, segments);
+    while(partialOverlaps.next()){
         #ifdef DEBUG
             print_profile(analysisProfiling, "\tNew set considered");
         #endif
 
-        if(!containsReadIns(it->first)){
+        const AccessIndex& ai = partialOverlaps.getAccessIndex();
+        if(!containsReadIns(ai)){
             continue;
         }
         
-        set<PartialOverlapAccess> tempSet = PartialOverlapAccess::convertToPartialOverlaps(it->second, true);
-        PartialOverlapAccess::addToSet(tempSet, fullOverlaps[it->first]);
-
-        set<PartialOverlapAccess> v;
-        unordered_map<MemoryAccess, unordered_set<size_t>, MemoryAccess::NoOrderHasher, MemoryAccess::Comparator> reportedGroups;
-        MemoryAccess::NoOrderHasher maHasher;
-
-        // Scan tempSet, and insert in set v the uninitializd read accesses with the write accesses they read from
-        // only if the whole group (uninitialized read + write) has not been already inserted yet.
-        // NOTE: this is quite similar to what we have done during analysis in |memtrace| when an uninitialized read is found.
-        // However, in order to avoid slowing down the analysis itself, we didn't check which write accesses are actually read by
-        // the uninitialized read. While that is enough to remove most of the duplicated groups of accesses,
-        // it is possible that some are not removed. This way, we are also removing from the set of partial overlaps all those write accesses
-        // that are never read by any uninitialized read access.
-        for(set<PartialOverlapAccess>::iterator v_it = tempSet.begin(); v_it != tempSet.end(); ++v_it){
-            if(v_it->getType() == AccessType::READ && v_it->getIsUninitializedRead() && !v_it->getIsPartialOverlap()){
-                set<PartialOverlapAccess> writes;
-                
-                const MemoryAccess& ma = v_it->getAccess();
-                size_t hash = maHasher(ma);
-                for(set<PartialOverlapAccess>::iterator writeIt = tempSet.begin(); writeIt != v_it; ++writeIt){
-                    if(writeIt->getType() == AccessType::WRITE && isReadByUninitializedRead(writeIt, v_it)){
-                        hash = maHasher.lrot(hash, 4) ^ maHasher(writeIt->getAccess());
-                        writes.insert(*writeIt);
-                    }
-                }
-
-                auto overlapGroup = reportedGroups.find(ma);
-
-                if(overlapGroup == reportedGroups.end()){
-                    unordered_set<size_t> s;
-                    s.insert(hash);
-                    reportedGroups[ma] = s;
-                }
-                else{
-                     unordered_set<size_t>&  reportedHashes = overlapGroup->second;
-
-                    // If this is the first time this read access is happening within this context, store it
-                    if(reportedHashes.find(hash) == reportedHashes.end()){
-                        reportedHashes.insert(hash);
-                    }
-                    else{
-                        continue;
-                    }
-                }
-
-                v.insert(*v_it);
-                for(const PartialOverlapAccess& write : writes){
-                    v.insert(write);
-                }
-            }
-        }
+        set<PartialOverlapAccess> v = partialOverlaps.getPartialOverlapGroup();
 
-        ADDRINT tmp = it->first.getFirst();
-        
-        memOverlaps.write(reinterpret_cast<const char*>(&tmp), regSize);
-        memOverlaps << it->first.getSecond() << ";";
+        memOverlaps.beginSet(ai);
 
         #ifdef DEBUG
             partialOverlapsLog << "===============================================" << endl;
-            partialOverlapsLog << "0x" << std::hex << it->first.getFirst() << " - " << std::dec << it->first.getSecond() << endl;
+            partialOverlapsLog << "0x" << std::hex << ai.getFirst() << " - " << std::dec << ai.getSecond() << endl;
             partialOverlapsLog << "===============================================" << endl;
         #endif
         
@@ -2542,7 +2996,7 @@ VOID Fini(INT32 code, VOID *v)
             }
             
             void* uninitializedOverlap = NULL;
-            int overlapBeginning = v_it->getAddress() - it->first.getFirst();
+            int overlapBeginning = v_it->getAddress() - ai.getFirst();
             if(overlapBeginning < 0)
                 overlapBeginning = 0;
 
@@ -2551,7 +3005,7 @@ VOID Fini(INT32 code, VOID *v)
             // Moreover, uninitializedOverlap can't be NULL. Every write partially overlaps thi set, and every remained read access is an uninitialized
             // read fully overlapping with the considered set (and so its field |uninitializedInterval| can't be NULL)
             if(v_it->getType() == AccessType::WRITE){
-                uninitializedOverlap = getOverlappingWriteInterval(it->first, v_it);
+                uninitializedOverlap = getOverlappingWriteInterval(ai, v_it);
             }
             else{
                 uninitializedOverlap = v_it->getUninitializedInterval();
@@ -2582,22 +3036,6 @@ VOID Fini(INT32 code, VOID *v)
                 partialOverlapsLog << endl;
             #endif
             
-            memOverlaps.write(v_it->getIsUninitializedRead() ? "\x0a" : "\x0b", 1);
-            tmp = v_it->getIP();
-            memOverlaps.write(reinterpret_cast<const char*>(&tmp), regSize);
-            tmp = v_it->getActualIP();
-            memOverlaps.write(reinterpret_cast<const char*>(&tmp), regSize);
-            memOverlaps << v_it->getDisasm() << ";";
-            memOverlaps.write((v_it->getType() == AccessType::WRITE ? "\x1a" : "\x1b"), 1);
-            memOverlaps << v_it->getSize() << ";";
-            memOverlaps.write(v_it->isStackAccess() ? "\x1c" : "\x1d", 1);
-            memOverlaps << v_it->getSPOffset() << ";";
-            memOverlaps << v_it->getBPOffset() << ";";
-
-            if(v_it->getIsPartialOverlap()){
-                memOverlaps.write("\xab\xcd\xef\xff", 4);
-            }
-
             set<std::pair<unsigned, unsigned>> intervals;
 
             if(v_it->getType() == AccessType::WRITE){
@@ -2612,14 +3050,10 @@ VOID Fini(INT32 code, VOID *v)
                 intervals = v_it->computeIntervals();
             }
 
-            memOverlaps << intervals.size() << ";";
-            for(const std::pair<unsigned, unsigned>& p : intervals){
-                memOverlaps << p.first << ";";
-                memOverlaps << p.second << ";";
-            }
+            memOverlaps.addEntry(v_it->getAccess(), v_it->getIsPartialOverlap(), intervals);
         }
 
-        memOverlaps.write("\x00\x00\x00\x03", 4);
+        memOverlaps.endSet();
 
         #ifdef DEBUG
             partialOverlapsLog << "===============================================" << endl;
@@ -2627,14 +3061,269 @@ VOID Fini(INT32 code, VOID *v)
         #endif
     }
 
+    // Groups of the segments which can't be read are missing from the report
+    if(!fullOverlaps.isComplete() || !partialOverlaps.isComplete()){
+        *out << "Can't read the spilled accesses: the report is incomplete" << endl;
+        memOverlaps.addFlags(ReportFormat::TRUNCATED);
+    }
+
+    memOverlaps.close();
+
     #ifdef DEBUG
         print_profile(analysisProfiling, "Finished");
-        analysisProfiling.close();
+        partialOverlapsLog.close();
     #endif
+}
 
-    memOverlaps.write("\x00\x00\x00\x04", 4);
+/*
+Empty the access store, freeing all shadow memory copies stored in MemoryAccess objects
+*/
+void clearAccessStore(){
+    for(auto aiIter = memAccesses.begin(); aiIter != memAccesses.end(); ++aiIter){
+        auto& aiSet = aiIter->second;
+        for(auto iter = aiSet.begin(); iter != aiSet.end(); ++iter){
+            iter->freeMemory();
+        }
+    }
 
-    memOverlaps.close();
+    memAccesses.clear();
+    accessSpill.clear();
+    containsUninitializedRead.clear();
+    mallocTemporaryWriteStorage.clear();
+}
+
+/*
+Bring the analysis back to the status saved when the persistent routine has been entered for the first time.
+Accesses performed by previous iterations are discarded, so that each iteration is analyzed as if the routine
+was executed only once, right after the code preceding its first invocation.
+*/
+void resetPersistentIteration(){
+    clearAccessStore();
+    clearPendingReads();
+    pendingDirectMemoryCopy.setAsInvalid();
+    lastWriteInstruction = persistentLastWrites;
+    lastStackAllocation = persistentStackAllocation;
+
+    stack.restoreCheckpoint();
+    heap.restoreCheckpoint();
+    for(auto iter = mmapShadows.begin(); iter != mmapShadows.end(); ++iter){
+        iter->second.restoreCheckpoint();
+    }
+    ShadowRegisterFile::getInstance().restoreCheckpoint();
+
+    // Reads already reported by the previous iteration must be reported again for the new input, and the instructions
+    // saturated by it (see |saturateInstruction|) must be fully instrumented again
+    readContextFilter.clear();
+    if(!saturatedInstructions.empty()){
+        saturatedInstructions.clear();
+        PIN_RemoveInstrumentation();
+    }
+}
+
+/*
+Copy the content of the input analyzed by the current iteration into the file read by the persistent routine
+*/
+void loadPersistentInput(){
+    const std::string& inputFile = KnobPersistentInputFile.Value();
+    if(inputFile.empty())
+        return;
+
+    const std::string& inputPath = persistentInputs[persistentIteration].first;
+    std::ifstream src(inputPath, std::ios::binary);
+    std::ofstream dst(inputFile, std::ios::binary | std::ios::trunc);
+    if(!src || !dst){
+        *out << "Can't copy input " << inputPath << " to " << inputFile << endl;
+        return;
+    }
+    dst << src.rdbuf();
+}
+
+VOID PersistentRoutineEntry(CONTEXT* ctxt){
+    if(persistentStatus == PersistentStatus::RUNNING){
+        // Either a recursive call or the beginning of a new iteration (restarted by |PersistentRoutineExit|)
+        ++persistentDepth;
+        return;
+    }
+
+    if(persistentStatus == PersistentStatus::DONE)
+        return;
+
+    // First invocation: everything executed up to now is just the setup of the routine.
+    // Save the context the routine is invoked with and the current initialization status, as each iteration restarts from them.
+    clearAccessStore();
+    clearPendingReads();
+    pendingDirectMemoryCopy.setAsInvalid();
+    readContextFilter.clear();
+    persistentLastWrites = lastWriteInstruction;
+    persistentStackAllocation = lastStackAllocation;
+
+    stack.checkpoint();
+    heap.checkpoint();
+    for(auto iter = mmapShadows.begin(); iter != mmapShadows.end(); ++iter){
+        iter->second.checkpoint();
+    }
+    ShadowRegisterFile::getInstance().checkpoint();
+
+    PIN_SaveContext(ctxt, &persistentContext);
+    persistentStatus = PersistentStatus::RUNNING;
+    persistentIteration = 0;
+    persistentDepth = 1;
+    resetBudget();
+    loadPersistentInput();
+
+    *out << "Persistent mode: analyzing " << persistentInputs[persistentIteration].first << endl;
+}
+
+VOID PersistentRoutineExit(){
+    if(persistentStatus != PersistentStatus::RUNNING || --persistentDepth > 0)
+        return;
+
+    writeReport(persistentInputs[persistentIteration].second);
+
+    if(++persistentIteration == persistentInputs.size()){
+        // Let the application go on normally
+        persistentStatus = PersistentStatus::DONE;
+        clearAccessStore();
+        return;
+    }
+
+    resetPersistentIteration();
+    resetBudget();
+    loadPersistentInput();
+    *out << "Persistent mode: analyzing " << persistentInputs[persistentIteration].first << endl;
+
+    // Never returns
+    PIN_ExecuteAt(&persistentContext);
+}
+
+/*
+Write the report of the execution being analyzed, if any.
+In persistent mode, if the application exits during an iteration (e.g. it crashed), the report of that iteration
+is written. If every iteration has already been completed, there's nothing left to write.
+The fork server itself does not write any report: each child writes its own.
+*/
+void writeFinalReport(){
+    stats.endExecution();
+    if(stats.isEnabled())
+        sampleStats();
+
+    {
+        StatsTimer timer(Stats::FINI);
+        if(persistentStatus == PersistentStatus::RUNNING)
+            writeReport(persistentInputs[persistentIteration].second);
+        else if(persistentStatus == PersistentStatus::WAITING && !forkServerParent)
+            writeReport(reportPath);
+    }
+    // Spill segments are only needed to write the report
+    accessSpill.clear();
+
+    if(stats.isEnabled() && !stats.write())
+        *out << "Can't write statistics to " << KnobStats.Value() << endl;
+}
+
+void scheduleBudgetCheck(){
+    nextBudgetCheck = executedInstructions + BUDGET_CHECK_INTERVAL;
+    if(instructionBudget > executedInstructions && instructionBudget < nextBudgetCheck)
+        nextBudgetCheck = instructionBudget;
+}
+
+// Budgets are counted from the beginning of the analyzed execution (i.e. of each persistent iteration or fork server child)
+void resetBudget(){
+    executedInstructions = 0;
+    budgetStartTime = time(NULL);
+    budgetStartAccesses = executedAccesses;
+    scheduleBudgetCheck();
+}
+
+// Used as an If analysis routine, so that it can be inlined
+ADDRINT countInstructions(UINT32 count){
+    executedInstructions += count;
+    return executedInstructions >= nextBudgetCheck;
+}
+
+VOID checkBudget(){
+    const char* exhausted = NULL;
+    // The fork server itself is never stopped: budgets only apply to its children
+    if(forkServerParent)
+        exhausted = NULL;
+    else if(instructionBudget != 0 && executedInstructions >= instructionBudget)
+        exhausted = "instructions";
+    else if(timeBudget != 0 && time(NULL) - budgetStartTime >= timeBudget)
+        exhausted = "time";
+    else if(accessBudget != 0 && executedAccesses - budgetStartAccesses >= accessBudget)
+        exhausted = "accesses";
+
+    if(exhausted == NULL){
+        scheduleBudgetCheck();
+        return;
+    }
+
+    *out << "Execution budget exhausted (" << exhausted << "): writing the report" << endl;
+    budgetExhausted = true;
+
+    // In persistent mode, only the current iteration is stopped: its report is written and the next one is started
+    if(persistentStatus == PersistentStatus::RUNNING){
+        persistentDepth = 1;
+        resetBudget();
+        // Only returns after the last iteration
+        PersistentRoutineExit();
+    }
+
+    // Never check the budget again (the application may still execute some instructions before detaching)
+    nextBudgetCheck = (UINT64) -1;
+
+    if(budgetAction == BudgetAction::DETACH){
+        // Fini is not called when detaching
+        writeFinalReport();
+        PIN_Detach();
+    }
+    else{
+        // The report is written by Fini
+        PIN_ExitApplication(0);
+    }
+}
+
+VOID Trace(TRACE trace, VOID* v){
+    StatsTimer timer(Stats::INSTRUMENTATION);
+
+    for(BBL bbl = TRACE_BblHead(trace); BBL_Valid(bbl); bbl = BBL_Next(bbl)){
+        INS_InsertIfCall(BBL_InsHead(bbl), IPOINT_BEFORE, (AFUNPTR) countInstructions, IARG_UINT32, BBL_NumIns(bbl), IARG_END);
+        INS_InsertThenCall(BBL_InsHead(bbl), IPOINT_BEFORE, (AFUNPTR) checkBudget, IARG_END);
+    }
+}
+
+/*
+Load the list of inputs analyzed in persistent mode. Each line contains the path of an input and the path of
+its binary report, separated by a tab.
+*/
+bool loadPersistentInputs(const std::string& listPath){
+    std::ifstream inputsList(listPath);
+    if(!inputsList)
+        return false;
+
+    std::string line;
+    while(std::getline(inputsList, line)){
+        size_t separator = line.find('\t');
+        if(line.empty() || separator == std::string::npos)
+            continue;
+
+        persistentInputs.push_back(std::pair<std::string, std::string>(line.substr(0, separator), line.substr(separator + 1)));
+    }
+
+    return !persistentInputs.empty();
+}
+
+VOID Fini(INT32 code, VOID *v)
+{   
+    #ifdef DEBUG
+        print_profile(applicationTiming, "Application exited");
+    #endif
+
+    writeFinalReport();
+
+    #ifdef DEBUG
+        analysisProfiling.close();
+    #endif
 
     // Free every shadow memory
     stack.freeMemory();
@@ -2643,13 +3332,7 @@ VOID Fini(INT32 code, VOID *v)
         iter->second.freeMemory();
     }
 
-    // Free all shadow memory copies stored in MemoryAccess objects
-    for(auto aiIter = memAccesses.begin(); aiIter != memAccesses.end(); ++aiIter){
-        auto& aiSet = aiIter->second;
-        for(auto iter = aiSet.begin(); iter != aiSet.end(); ++iter){
-            iter->freeMemory();
-        }
-    }
+    clearAccessStore();
 
     // Free all ptrs allocated to pass data structures to analysis functions
     for(auto iter = disasmPtrs.begin(); iter != disasmPtrs.end(); ++iter){
@@ -2661,7 +3344,6 @@ VOID Fini(INT32 code, VOID *v)
     }
 
     #ifdef DEBUG
-        partialOverlapsLog.close();
         isReadLogger.close();
     #endif
 }
@@ -2686,6 +3368,15 @@ int main(int argc, char *argv[])
     std::string heuristicKnob = KnobHeuristicStatus.Value();
     HeuristicStatus::Status heuristicStatus = HeuristicStatus::fromString(heuristicKnob);
     ignoreLdInstructions = !KnobKeepLoader.Value();
+    reportPath = KnobOutputFile.Value();
+
+    std::string forkServerKnob = KnobForkServer.Value();
+    forkServerMode = ForkServerMode::fromString(forkServerKnob);
+
+    if(!KnobPersistentFunction.Value().empty() && !loadPersistentInputs(KnobPersistentInputs.Value())){
+        cerr << "Persistent mode requires a non-empty list of inputs (see knob --persistent-inputs)" << endl;
+        return Usage();
+    }
 
     // If heuristiStatus is LIBS, both the flags are set; if it is ON, only heuristicEnabled is set.
     // If it is OFF (last possible case), nothing is done.
@@ -2699,10 +3390,56 @@ int main(int argc, char *argv[])
             {}
     }
 
+    instructionBudget = KnobMaxInstructions.Value();
+    timeBudget = KnobMaxTime.Value();
+    accessBudget = KnobMaxAccesses.Value();
+    std::string budgetActionKnob = KnobBudgetAction.Value();
+    budgetAction = BudgetAction::fromString(budgetActionKnob);
+    budgetEnabled = instructionBudget != 0 || timeBudget != 0 || accessBudget != 0;
+    resetBudget();
+
+    if(!KnobStats.Value().empty())
+        stats.enable(KnobStats.Value());
+
+    if(KnobMemBudget.Value() != 0){
+        // Spill segments are written next to the report
+        size_t lastSlash = reportPath.rfind('/');
+        std::string spillDirectory = lastSlash == std::string::npos ? "." : reportPath.substr(0, lastSlash);
+        accessSpill.enable(spillDirectory.empty() ? "/" : spillDirectory, KnobMemBudget.Value() << 20);
+    }
+
+    readContextFilter.setMaxContexts(KnobMaxReadContexts.Value());
+    adaptiveInstrumentation = KnobAdaptive.Value();
+    routineSummaries.enable(!KnobAnalyzeMemRoutines.Value());
+    stringRoutines.enable(!KnobAnalyzeStrRoutines.Value());
+
+    std::string shadowHugePagesKnob = KnobShadowHugePages.Value();
+    ShadowPagePool::getInstance().enableHugePages(ShadowHugePages::fromString(shadowHugePagesKnob));
+
+    InstrumentationFilter& instrumentationFilter = InstrumentationFilter::getInstance();
+    for(UINT32 i = 0; i < KnobIncludeImage.NumberOfValues(); ++i){
+        instrumentationFilter.includeImage(KnobIncludeImage.Value(i));
+    }
+    for(UINT32 i = 0; i < KnobExcludeImage.NumberOfValues(); ++i){
+        instrumentationFilter.excludeImage(KnobExcludeImage.Value(i));
+    }
+    for(UINT32 i = 0; i < KnobIncludeRoutine.NumberOfValues(); ++i){
+        instrumentationFilter.includeRoutine(KnobIncludeRoutine.Value(i));
+    }
+    for(UINT32 i = 0; i < KnobRange.NumberOfValues(); ++i){
+        if(!instrumentationFilter.includeRange(KnobRange.Value(i))){
+            cerr << "Invalid range " << KnobRange.Value(i) << " (expected format: [<image>:]<start>-<end>)" << endl;
+            return Usage();
+        }
+    }
+
     // Add required instrumentation routines
     IMG_AddInstrumentFunction(Image, 0);
+    IMG_AddUnloadFunction(ImageUnload, 0);
     PIN_AddThreadStartFunction(OnThreadStart, 0);
     INS_AddInstrumentFunction(Instruction, 0);
+    if(budgetEnabled)
+        TRACE_AddInstrumentFunction(Trace, 0);
     PIN_AddFiniFunction(Fini, 0);
 
     // Add system call handling routines
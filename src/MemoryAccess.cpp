@@ -25,7 +25,7 @@ MemoryAccess::MemoryAccess(const MemoryAccess& other, UINT32 size, ADDRINT acces
     this->accessAddress = accessAddress;
 }
 
-OPCODE MemoryAccess::getOpcode(){
+OPCODE MemoryAccess::getOpcode() const{
     return opcode;
 }
 
@@ -61,6 +61,10 @@ std::string MemoryAccess::getDisasm() const{
     return instructionDisasm != NULL ? *instructionDisasm : std::string();
 }
 
+std::string* MemoryAccess::getDisasmPtr() const{
+    return instructionDisasm;
+}
+
 bool MemoryAccess::getIsUninitializedRead() const{
     return isUninitializedRead;
 }
@@ -154,6 +158,10 @@ bool MemoryAccess::ExecutionComparator::operator()(const MemoryAccess& ma1, cons
     return ma1.executionOrder < ma2.executionOrder;
 }
 
+bool MemoryAccess::ExecutionComparator::operator()(const MemoryAccess* ma1, const MemoryAccess* ma2){
+    return ma1->executionOrder < ma2->executionOrder;
+}
+
 
 // Implementation of PartialOverlapAccess methods
 
@@ -162,94 +170,94 @@ void PartialOverlapAccess::flagAsPartial(){
 }
 
 const MemoryAccess& PartialOverlapAccess::getAccess() const{
-    return ma;
+    return *ma;
 }
 
 bool PartialOverlapAccess::getIsPartialOverlap() const{
     return isPartialOverlap;
 }
 
-set<PartialOverlapAccess> PartialOverlapAccess::convertToPartialOverlaps(set<MemoryAccess>& s, bool arePartialOverlaps){
+set<PartialOverlapAccess> PartialOverlapAccess::convertToPartialOverlaps(const std::vector<const MemoryAccess*>& s, bool arePartialOverlaps){
     set<PartialOverlapAccess> ret;
-    for(const MemoryAccess& ma : s){
-        ret.insert(PartialOverlapAccess(ma, arePartialOverlaps));
+    for(const MemoryAccess* ma : s){
+        ret.insert(ret.end(), PartialOverlapAccess(ma, arePartialOverlaps));
     }
     return ret;
 }
 
-set<PartialOverlapAccess> PartialOverlapAccess::convertToPartialOverlaps(set<MemoryAccess>& s){
+set<PartialOverlapAccess> PartialOverlapAccess::convertToPartialOverlaps(const std::vector<const MemoryAccess*>& s){
     return convertToPartialOverlaps(s, false);
 }
 
-void PartialOverlapAccess::addToSet(set<PartialOverlapAccess>& ps, set<MemoryAccess>& s, bool arePartialOverlaps){
-    set<PartialOverlapAccess> toAdd = convertToPartialOverlaps(s, arePartialOverlaps);
-    ps.insert(toAdd.begin(), toAdd.end());
+void PartialOverlapAccess::addToSet(set<PartialOverlapAccess>& ps, const std::vector<const MemoryAccess*>& s, bool arePartialOverlaps){
+    for(const MemoryAccess* ma : s){
+        ps.insert(PartialOverlapAccess(ma, arePartialOverlaps));
+    }
 }
 
-void PartialOverlapAccess::addToSet(set<PartialOverlapAccess>& ps, set<MemoryAccess>& s){
-    set<PartialOverlapAccess> toAdd = convertToPartialOverlaps(s);
-    ps.insert(toAdd.begin(), toAdd.end());
+void PartialOverlapAccess::addToSet(set<PartialOverlapAccess>& ps, const std::vector<const MemoryAccess*>& s){
+    addToSet(ps, s, false);
 }
 
 bool PartialOverlapAccess::operator<(const PartialOverlapAccess& other) const{
     MemoryAccess::ExecutionComparator comp;
-    return comp(this->ma, other.ma);
+    return comp(*this->ma, *other.ma);
 }
 
 // Contained MemoryAccess structure delegation methods
 
-OPCODE PartialOverlapAccess::getOpcode(){
-    return ma.getOpcode();
+OPCODE PartialOverlapAccess::getOpcode() const{
+    return ma->getOpcode();
 }
 
 ADDRINT PartialOverlapAccess::getIP() const{
-    return ma.getIP();
+    return ma->getIP();
 }
 
 ADDRINT PartialOverlapAccess::getActualIP() const{
-    return ma.getActualIP();
+    return ma->getActualIP();
 }
 
 ADDRINT PartialOverlapAccess::getAddress() const{
-    return ma.getAddress();
+    return ma->getAddress();
 }
 
 long long int PartialOverlapAccess::getSPOffset() const{
-    return ma.getSPOffset();
+    return ma->getSPOffset();
 }
 
 long long int PartialOverlapAccess::getBPOffset() const{
-    return ma.getBPOffset();
+    return ma->getBPOffset();
 }
 
 UINT32 PartialOverlapAccess::getSize() const{
-    return ma.getSize();
+    return ma->getSize();
 }
 
 AccessType PartialOverlapAccess::getType() const{
-    return ma.getType();
+    return ma->getType();
 }
 
 std::string PartialOverlapAccess::getDisasm() const{
-    return ma.getDisasm();
+    return ma->getDisasm();
 }
 
 bool PartialOverlapAccess::getIsUninitializedRead() const{
-    return ma.getIsUninitializedRead();
+    return ma->getIsUninitializedRead();
 }
 
 uint8_t* PartialOverlapAccess::getUninitializedInterval() const{
-    return ma.getUninitializedInterval();
+    return ma->getUninitializedInterval();
 }
 
 ShadowBase* PartialOverlapAccess::getShadowMemory() const{
-    return ma.getShadowMemory();
+    return ma->getShadowMemory();
 }
 
 bool PartialOverlapAccess::isStackAccess() const{
-    return ma.isStackAccess();
+    return ma->isStackAccess();
 }
 
 set<std::pair<unsigned, unsigned>> PartialOverlapAccess::computeIntervals() const{
-    return ma.computeIntervals();
+    return ma->computeIntervals();
 }
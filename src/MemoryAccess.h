@@ -1,12 +1,13 @@
 #ifndef MEMORYACCESS
 #define MEMORYACCESS
 
-#include "pin.H"
+#include "PinTypes.h"
 #include <set>
 #include <string.h>
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <vector>
 
 #include "ShadowMemory.h"
 
@@ -77,7 +78,7 @@ class MemoryAccess{
 
         MemoryAccess(const MemoryAccess& other, UINT32 size, ADDRINT accessAddress);
 
-        OPCODE getOpcode();
+        OPCODE getOpcode() const;
         
         ADDRINT getIP() const;
 
@@ -95,6 +96,9 @@ class MemoryAccess{
 
         std::string getDisasm() const;
 
+        // Disassembled instructions are allocated once, and never released while the tool is running
+        std::string* getDisasmPtr() const;
+
         bool getIsUninitializedRead() const;
 
         uint8_t* getUninitializedInterval() const;
@@ -142,6 +146,8 @@ class MemoryAccess{
         // Define a functor class which allows to order MemoryAccess objects according to their execution order
         struct ExecutionComparator{
             bool operator()(const MemoryAccess& ma1, const MemoryAccess& ma2);
+
+            bool operator()(const MemoryAccess* ma1, const MemoryAccess* ma2);
         };
 
 
@@ -240,23 +246,20 @@ class MemoryAccess{
         };
 };
 
+// Lightweight view over a MemoryAccess stored in the access store. It only keeps a pointer
+// to the referenced access, so building sets of partial overlaps while writing the report never
+// copies the accesses themselves.
 class PartialOverlapAccess{
     private:
-        MemoryAccess ma;
+        const MemoryAccess* ma;
         bool isPartialOverlap;
 
-        PartialOverlapAccess(MemoryAccess& ma, bool isPartialOverlap) :
-            ma(ma),
-            isPartialOverlap(isPartialOverlap){}
-
-        PartialOverlapAccess(const MemoryAccess& ma, bool isPartialOverlap) :
+        PartialOverlapAccess(const MemoryAccess* ma, bool isPartialOverlap) :
             ma(ma),
             isPartialOverlap(isPartialOverlap){}
 
     public:
-        PartialOverlapAccess(MemoryAccess& ma) : ma(ma), isPartialOverlap(false){}
-
-        PartialOverlapAccess(const MemoryAccess&ma) : ma(ma), isPartialOverlap(false){}
+        PartialOverlapAccess(const MemoryAccess* ma) : ma(ma), isPartialOverlap(false){}
 
         void flagAsPartial();
 
@@ -264,19 +267,19 @@ class PartialOverlapAccess{
 
         bool getIsPartialOverlap() const;
 
-        static set<PartialOverlapAccess> convertToPartialOverlaps(set<MemoryAccess>& s, bool arePartialOverlaps);
+        static set<PartialOverlapAccess> convertToPartialOverlaps(const std::vector<const MemoryAccess*>& s, bool arePartialOverlaps);
 
-        static set<PartialOverlapAccess> convertToPartialOverlaps(set<MemoryAccess>& s);
+        static set<PartialOverlapAccess> convertToPartialOverlaps(const std::vector<const MemoryAccess*>& s);
 
-        static void addToSet(set<PartialOverlapAccess>& ps, set<MemoryAccess>& s, bool arePartialOverlaps);
+        static void addToSet(set<PartialOverlapAccess>& ps, const std::vector<const MemoryAccess*>& s, bool arePartialOverlaps);
 
-        static void addToSet(set<PartialOverlapAccess>& ps, set<MemoryAccess>& s);
+        static void addToSet(set<PartialOverlapAccess>& ps, const std::vector<const MemoryAccess*>& s);
 
         bool operator<(const PartialOverlapAccess& other) const;
 
         // Contained MemoryAccess structure delegation methods
 
-        OPCODE getOpcode();
+        OPCODE getOpcode() const;
         
         ADDRINT getIP() const;
 
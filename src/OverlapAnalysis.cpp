@@ -0,0 +1,246 @@
+#include "OverlapAnalysis.h"
+
+#include <algorithm>
+
+using std::endl;
+using std::pair;
+
+#ifdef DEBUG
+    std::ofstream isReadLogger("isReadLog.log");
+#endif
+
+static UINT32 min(UINT32 x, UINT32 y){
+    return x <= y ? x : y;
+}
+
+vector<OrderedAccessEntry> getOrderedView(const AccessStore& unorderedMap){
+    vector<OrderedAccessEntry> ret;
+    ret.reserve(unorderedMap.size());
+    MemoryAccess::ExecutionComparator execComparator;
+
+    for(auto iter = unorderedMap.begin(); iter != unorderedMap.end(); ++iter){
+        ret.push_back(OrderedAccessEntry(&iter->first, OrderedAccessGroup()));
+        OrderedAccessGroup& group = ret.back().second;
+        group.reserve(iter->second.size());
+        for(const MemoryAccess& ma : iter->second){
+            group.push_back(&ma);
+        }
+        std::sort(group.begin(), group.end(), execComparator);
+    }
+
+    std::sort(ret.begin(), ret.end(), OrderedEntryComparator());
+
+    return ret;
+}
+
+/*
+The index |firstPartiallyOverlappingIndex| is used in order to optimize the search of partially overlapping accesses happening
+at an address lower than the address of the considered set. Without it, we would need to restart the search from the
+beginning of |fullOverlaps|, which may require more time.
+*/
+void findPartialOverlaps(const vector<OrderedAccessEntry>& fullOverlaps, size_t index, size_t& firstPartiallyOverlappingIndex, vector<size_t>& overlapping){
+    bool firstPartiallyOverlappingIndexUpdated = false;
+    const AccessIndex& ai = *fullOverlaps[index].first;
+
+    // Insert backward AccessIndex partially overlapping
+    ADDRINT accessedAddress = ai.getFirst();
+    for(size_t j = firstPartiallyOverlappingIndex; j < index; ++j){
+        ADDRINT lastAccessedByte = fullOverlaps[j].first->getFirst() + fullOverlaps[j].first->getSecond() - 1;
+        if(lastAccessedByte >= accessedAddress){
+            overlapping.push_back(j);
+            if(!firstPartiallyOverlappingIndexUpdated){
+                firstPartiallyOverlappingIndexUpdated = true;
+                firstPartiallyOverlappingIndex = j;
+            }
+        }
+    }
+
+    // Insert forward AccessIndex partially overlapping
+    ADDRINT lastAccessedByte = ai.getFirst() + ai.getSecond() - 1;
+    for(size_t j = index + 1; j < fullOverlaps.size() && fullOverlaps[j].first->getFirst() <= lastAccessedByte; ++j){
+        overlapping.push_back(j);
+    }
+}
+
+set<PartialOverlapAccess> getPartialOverlapGroup(const vector<OrderedAccessEntry>& fullOverlaps, size_t index, const vector<size_t>& overlapping){
+    set<PartialOverlapAccess> tempSet;
+    for(size_t j : overlapping){
+        PartialOverlapAccess::addToSet(tempSet, fullOverlaps[j].second, true);
+    }
+    PartialOverlapAccess::addToSet(tempSet, fullOverlaps[index].second);
+
+    set<PartialOverlapAccess> v;
+    unordered_map<MemoryAccess, unordered_set<size_t>, MemoryAccess::NoOrderHasher, MemoryAccess::Comparator> reportedGroups;
+    MemoryAccess::NoOrderHasher maHasher;
+
+    // Scan tempSet, and insert in set v the uninitializd read accesses with the write accesses they read from
+    // only if the whole group (uninitialized read + write) has not been already inserted yet.
+    // NOTE: this is quite similar to what we have done during analysis in |memtrace| when an uninitialized read is found.
+    // However, in order to avoid slowing down the analysis itself, we didn't check which write accesses are actually read by
+    // the uninitialized read. While that is enough to remove most of the duplicated groups of accesses,
+    // it is possible that some are not removed. This way, we are also removing from the set of partial overlaps all those write accesses
+    // that are never read by any uninitialized read access.
+    for(set<PartialOverlapAccess>::iterator v_it = tempSet.begin(); v_it != tempSet.end(); ++v_it){
+        if(v_it->getType() == AccessType::READ && v_it->getIsUninitializedRead() && !v_it->getIsPartialOverlap()){
+            set<PartialOverlapAccess> writes;
+            
+            const MemoryAccess& ma = v_it->getAccess();
+            size_t hash = maHasher(ma);
+            for(set<PartialOverlapAccess>::iterator writeIt = tempSet.begin(); writeIt != v_it; ++writeIt){
+                if(writeIt->getType() == AccessType::WRITE && isReadByUninitializedRead(writeIt, v_it)){
+                    hash = maHasher.lrot(hash, 4) ^ maHasher(writeIt->getAccess());
+                    writes.insert(*writeIt);
+                }
+            }
+
+            auto overlapGroup = reportedGroups.find(ma);
+
+            if(overlapGroup == reportedGroups.end()){
+                unordered_set<size_t> s;
+                s.insert(hash);
+                reportedGroups[ma] = s;
+            }
+            else{
+                 unordered_set<size_t>&  reportedHashes = overlapGroup->second;
+
+                // If this is the first time this read access is happening within this context, store it
+                if(reportedHashes.find(hash) == reportedHashes.end()){
+                    reportedHashes.insert(hash);
+                }
+                else{
+                    continue;
+                }
+            }
+
+            v.insert(*v_it);
+            for(const PartialOverlapAccess& write : writes){
+                v.insert(write);
+            }
+        }
+    }
+
+    return v;
+}
+
+// The returned pair contains the bounds of the interval of bytes written
+// by the access pointed to by |v_it| which overlap with the access represented by |currentSetAI|.
+// Note that this function allocates dynamically the new pair and returns its pointer.
+// This allocation will be deleted afterwards, when the tool writes the binary report.
+std::pair<unsigned, unsigned>* getOverlappingWriteInterval(const AccessIndex& currentSetAI, set<PartialOverlapAccess>::iterator& v_it){
+    int overlapBeginning = v_it->getAddress() - currentSetAI.getFirst();
+    if(overlapBeginning < 0)
+        overlapBeginning = 0;
+    int overlapEnd = min(v_it->getAddress() + v_it->getSize() - 1 - currentSetAI.getFirst(), currentSetAI.getSecond() - 1);
+    return new pair<unsigned, unsigned>(overlapBeginning, overlapEnd);
+}
+
+// Returns true if the write access pointed to by |writeAccess| writes at least 1 byte that is later read
+// by the uninitialized read pointed to by |readAccess|.
+// The function is quite complex (linear w.r.t. the number of accesses stored), as it requires to scan every access starting from |writeAccess| until |readAccess| (note that they
+// are in execution order). 
+// As soon as we find out the write has been completely overwritten before the read is reached, the function returns false.
+// If when we reach the read, it reads at least 1 byte written by the write and never overwritten, it returns true.
+// If the read only reads bytes that have been overwritten, but the write is not completely overwritten, false is returned anyway.
+bool isReadByUninitializedRead(set<PartialOverlapAccess>::iterator& writeAccess, set<PartialOverlapAccess>::iterator& readAccess){
+    ADDRINT writeStart = writeAccess->getAddress();
+    UINT32 writeSize = writeAccess->getSize();
+
+    // Determine the portion of the write access that overlaps with the considered set
+    int overlapBeginning = readAccess->getAddress() - writeStart;
+    if(overlapBeginning < 0)
+        overlapBeginning = 0;
+    int overlapEnd = min(readAccess->getAddress() + readAccess->getSize() - 1 - writeStart, writeSize - 1);
+
+    // Update writeStart, writeEnd and writeSize to consider only the portion of the write that
+    // overlaps the considered set
+    writeStart += overlapBeginning;
+    writeSize = overlapEnd - overlapBeginning + 1;
+    ADDRINT writeEnd = writeStart + writeSize - 1;
+
+    #ifdef DEBUG
+        isReadLogger << "[LOG]: 0x" << std::hex << readAccess->getAddress() << " - " << std::dec << readAccess->getSize() << endl;
+        isReadLogger << "[LOG]: " << std::hex << writeAccess->getDisasm() << " writes " << std::dec << writeSize << " B @ 0x" << std::hex << writeStart << endl;
+    #endif
+
+    set<PartialOverlapAccess>::iterator following = writeAccess;
+    ++following;
+
+    unsigned int numOverwrittenBytes = 0;
+    bool* overwrittenBytes = new bool[writeSize];
+
+    for(UINT32 i = 0; i < writeSize; ++i){
+        overwrittenBytes[i] = false;
+    }
+
+    set<PartialOverlapAccess>::iterator end = readAccess;
+    ++end;
+    while(following != end){
+
+        ADDRINT folStart = following->getAddress();
+        ADDRINT folEnd = folStart + following->getSize() - 1;
+
+        // Following access bounds are outside write access bounds. It can't overlap, skip it.
+        if(folStart > writeEnd || folEnd < writeStart){
+            ++following;
+            continue;
+        }
+
+        overlapBeginning = folStart - writeStart;
+        if(overlapBeginning < 0)
+            overlapBeginning = 0;
+
+        overlapEnd = min(folEnd - writeStart, writeSize - 1);
+
+        // If |following| is the uninitialized read access, check if it reads at least a not overwritten byte of 
+        // |writeAccess|
+        if(following == readAccess){
+            #ifdef DEBUG
+                isReadLogger << "[LOG]: " << following->getDisasm() << " reads bytes [" << std::dec << overlapBeginning << " ~ " << overlapEnd << "]" << endl;
+            #endif
+
+            // Check if the read access reads any byte that is not overwritten
+            // by any other write access
+            for(int i = overlapBeginning; i <= overlapEnd; ++i){
+                if(!overwrittenBytes[i]){
+                    #ifdef DEBUG
+                        isReadLogger << "[LOG]: " << following->getDisasm() << " reads a byte of the write" << endl;
+                    #endif
+                    // Read access reads a not overwritten byte.
+                    delete[] overwrittenBytes;
+                    return true;
+                }
+            }
+        }
+
+        // If |following| is a write access, update the byte map overwrittenBytes to true where needed.
+        // If |writeAccess| has been completely overwritten, it can't be read by any other access, so return false.
+        if(following->getType() == AccessType::WRITE){
+            #ifdef DEBUG
+                isReadLogger << "[LOG]: " << following->getDisasm() << " overwrites bytes [" << std::dec << overlapBeginning << " ~ " << overlapEnd << "]" << endl;
+            #endif
+
+            for(int i = overlapBeginning; i <= overlapEnd; ++i){
+                if(!overwrittenBytes[i])
+                    ++numOverwrittenBytes;
+                overwrittenBytes[i] = true;
+            }
+            // The write access bytes have been completely overwritten by another write access
+            // before any read access could read them.
+            if(numOverwrittenBytes == writeSize){
+                #ifdef DEBUG
+                    isReadLogger << "[LOG]: write access completely overwritten" << endl << endl << endl;
+                #endif
+                delete[] overwrittenBytes;
+                return false;
+            }
+        }
+        
+        ++ following;
+    }
+    // |writeAccess| has not been completely overwritten, but no uninitialized read access reads its bytes.
+    #ifdef DEBUG
+        isReadLogger << "[LOG]: write access not completely overwritten, but never read" << endl << endl << endl;
+    #endif
+    delete[] overwrittenBytes;
+    return false;
+}
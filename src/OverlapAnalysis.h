@@ -0,0 +1,59 @@
+#ifndef OVERLAPANALYSIS
+#define OVERLAPANALYSIS
+
+#include <vector>
+#include <fstream>
+#include <set>
+#include <utility>
+#include <unordered_map>
+#include <unordered_set>
+#include "PinTypes.h"
+#include "AccessIndex.h"
+#include "MemoryAccess.h"
+
+using std::vector;
+using std::set;
+using std::unordered_map;
+using std::unordered_set;
+
+/*
+    Algorithms computing, at the end of the analysis, the sets of fully and partially overlapping accesses written
+    into the binary report (see |writeReport| in MemTrace.cpp).
+*/
+
+// Traced memory accesses, grouped by accessed memory area
+typedef unordered_map<AccessIndex, unordered_set<MemoryAccess, MemoryAccess::MAHasher>, AccessIndex::AIHasher> AccessStore;
+
+// A group of memory accesses sharing the same AccessIndex. Accesses are not copied: the group
+// only points to the elements stored in |memAccesses|, ordered by execution order.
+typedef vector<const MemoryAccess*> OrderedAccessGroup;
+typedef std::pair<const AccessIndex*, OrderedAccessGroup> OrderedAccessEntry;
+
+struct OrderedEntryComparator{
+    bool operator()(const OrderedAccessEntry& e1, const OrderedAccessEntry& e2) const{
+        return *e1.first < *e2.first;
+    }
+};
+
+// Given an unordered_map containing all the traced memory accesses, obtain an ordered view whose order is useful
+// to detect partial overlaps.
+// NOTE: the returned view references keys and elements of |unorderedMap|, which must not be modified while the view is in use.
+vector<OrderedAccessEntry> getOrderedView(const AccessStore& unorderedMap);
+
+// Appends to |overlapping| the indexes (in |fullOverlaps|) of the sets partially overlapping with the set at |index|.
+// |firstPartiallyOverlappingIndex| must be 0 on the first call, and sets must be considered in increasing order of index.
+void findPartialOverlaps(const vector<OrderedAccessEntry>& fullOverlaps, size_t index, size_t& firstPartiallyOverlappingIndex, vector<size_t>& overlapping);
+
+// Returns the accesses reported for the partial overlaps of the set at |index|: each uninitialized read of the set,
+// together with the partially overlapping write accesses it reads from, unless the same group has already been included.
+set<PartialOverlapAccess> getPartialOverlapGroup(const vector<OrderedAccessEntry>& fullOverlaps, size_t index, const vector<size_t>& overlapping);
+
+std::pair<unsigned, unsigned>* getOverlappingWriteInterval(const AccessIndex& currentSetAI, set<PartialOverlapAccess>::iterator& v_it);
+
+bool isReadByUninitializedRead(set<PartialOverlapAccess>::iterator& writeAccess, set<PartialOverlapAccess>::iterator& readAccess);
+
+#ifdef DEBUG
+    extern std::ofstream isReadLogger;
+#endif
+
+#endif // OVERLAPANALYSIS
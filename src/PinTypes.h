@@ -0,0 +1,12 @@
+#ifndef PINTYPES
+#define PINTYPES
+
+// The core modules of the tool (shadow memories, shadow registers, tags and pending reads) only depend on the
+// types defined by Intel PIN. When built as a native library (see native/Makefile) those types are provided by a shim.
+#ifdef MEMTRACE_NATIVE
+    #include "native/PinShim.h"
+#else
+    #include "pin.H"
+#endif
+
+#endif // PINTYPES
@@ -3,7 +3,7 @@
 
 #include <list>
 #include <unistd.h>
-#include "pin.H"
+#include "PinTypes.h"
 
 using std::list;
 
@@ -23,6 +23,8 @@ static const unsigned long pagesize = sysconf(_SC_PAGESIZE);
     #define MMAP_NUM 9
     #define MREMAP_NUM 25
     #define BRK_NUM 12
+    #define READ_NUM 0
+    #define FORK_NUM 57
     #define STACK_SHADOW_INIT 0xff
     const REG syscall_args[] = {REG_RDI, REG_RSI, REG_RDX, REG_R10, REG_R8, REG_R9};
 #elif defined(__i386__) || defined(_M_IX86)
@@ -30,6 +32,8 @@ static const unsigned long pagesize = sysconf(_SC_PAGESIZE);
     #define MMAP_NUM 90
     #define MREMAP_NUM 163
     #define BRK_NUM 45
+    #define READ_NUM 3
+    #define FORK_NUM 2
     #define STACK_SHADOW_INIT 0xf0
     const REG syscall_args[] = {REG_EBX, REG_ECX, REG_EDX, REG_ESI, REG_EDI, REG_EBP};
 #else
@@ -0,0 +1,146 @@
+#include "ReadContextFilter.h"
+
+#include <utility>
+
+ContextFilter::ContextFilter(size_t capacity) : capacity(capacity), bucketsMask(0), count(0), victim(0), victimBucket(0), kickSeed(0){}
+
+void ContextFilter::allocateBuckets(){
+    // Buckets are sized so that the filter is half full when it holds |capacity| fingerprints
+    size_t buckets = 1;
+    while(buckets * CONTEXT_FILTER_BUCKET_SIZE < capacity * 2){
+        buckets <<= 1;
+    }
+    bucketsMask = buckets - 1;
+    slots.assign(buckets * CONTEXT_FILTER_BUCKET_SIZE, 0);
+
+    // The filter is almost empty, so these insertions always succeed
+    for(size_t hash : exactHashes){
+        insertFingerprint(hash);
+    }
+    unordered_set<size_t>().swap(exactHashes);
+}
+
+uint16_t ContextFilter::getFingerprint(size_t hash){
+    // Low bits of the hash select the bucket, so the fingerprint is taken from the high ones
+    uint16_t ret = (uint16_t) (hash >> (sizeof(size_t) * 8 - 16));
+    return ret != 0 ? ret : 1;
+}
+
+size_t ContextFilter::getAlternateBucket(size_t bucket, uint16_t fingerprint) const{
+    return (bucket ^ (fingerprint * 0x5bd1e995UL)) & bucketsMask;
+}
+
+bool ContextFilter::bucketContains(size_t bucket, uint16_t fingerprint) const{
+    const uint16_t* slot = &slots[bucket * CONTEXT_FILTER_BUCKET_SIZE];
+    for(unsigned i = 0; i < CONTEXT_FILTER_BUCKET_SIZE; ++i){
+        if(slot[i] == fingerprint)
+            return true;
+    }
+    return false;
+}
+
+bool ContextFilter::bucketInsert(size_t bucket, uint16_t fingerprint){
+    uint16_t* slot = &slots[bucket * CONTEXT_FILTER_BUCKET_SIZE];
+    for(unsigned i = 0; i < CONTEXT_FILTER_BUCKET_SIZE; ++i){
+        if(slot[i] == 0){
+            slot[i] = fingerprint;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ContextFilter::contains(size_t hash) const{
+    if(slots.empty())
+        return exactHashes.count(hash) != 0;
+
+    uint16_t fingerprint = getFingerprint(hash);
+    size_t bucket = hash & bucketsMask;
+    size_t alternateBucket = getAlternateBucket(bucket, fingerprint);
+
+    if(bucketContains(bucket, fingerprint) || bucketContains(alternateBucket, fingerprint))
+        return true;
+
+    return victim == fingerprint && (victimBucket == bucket || victimBucket == alternateBucket);
+}
+
+bool ContextFilter::insert(size_t hash){
+    if(slots.empty()){
+        if(capacity == 0 || exactHashes.size() < CONTEXT_FILTER_EXACT_SIZE){
+            exactHashes.insert(hash);
+            ++count;
+            return true;
+        }
+
+        allocateBuckets();
+    }
+
+    if(victim != 0)
+        return false;
+
+    ++count;
+    return insertFingerprint(hash);
+}
+
+bool ContextFilter::insertFingerprint(size_t hash){
+    uint16_t fingerprint = getFingerprint(hash);
+    size_t bucket = hash & bucketsMask;
+    size_t alternateBucket = getAlternateBucket(bucket, fingerprint);
+
+    if(bucketInsert(bucket, fingerprint) || bucketInsert(alternateBucket, fingerprint))
+        return true;
+
+    // Both buckets are full: relocate fingerprints to their alternate bucket until a free slot is found
+    bucket = (kickSeed & 1) ? bucket : alternateBucket;
+    for(unsigned i = 0; i < CONTEXT_FILTER_MAX_KICKS; ++i){
+        kickSeed = kickSeed * 1103515245 + 12345;
+        std::swap(fingerprint, slots[bucket * CONTEXT_FILTER_BUCKET_SIZE + (kickSeed >> 16) % CONTEXT_FILTER_BUCKET_SIZE]);
+        bucket = getAlternateBucket(bucket, fingerprint);
+        if(bucketInsert(bucket, fingerprint))
+            return true;
+    }
+
+    // The last evicted fingerprint can't be placed anywhere: keep it aside, and consider the filter full from now on
+    victim = fingerprint;
+    victimBucket = bucket;
+    return true;
+}
+
+size_t ContextFilter::size() const{
+    return count;
+}
+
+ReadContextFilter::ReadContextFilter() : maxContexts(DEFAULT_MAX_READ_CONTEXTS){}
+
+ReadContextFilter& ReadContextFilter::getInstance(){
+    static ReadContextFilter instance;
+
+    return instance;
+}
+
+void ReadContextFilter::setMaxContexts(size_t maxContexts){
+    this->maxContexts = maxContexts;
+}
+
+ReadContextFilter::Result ReadContextFilter::insert(ADDRINT ip, size_t hash){
+    auto iter = filters.find(ip);
+    if(iter == filters.end())
+        iter = filters.insert(std::make_pair(ip, ContextFilter(maxContexts))).first;
+
+    ContextFilter& filter = iter->second;
+    if(filter.contains(hash))
+        return DUPLICATE;
+
+    if((maxContexts != 0 && filter.size() >= maxContexts) || !filter.insert(hash))
+        return LIMIT_REACHED;
+
+    return NEW;
+}
+
+void ReadContextFilter::clear(){
+    filters.clear();
+}
+
+size_t ReadContextFilter::getTrackedInstructions() const{
+    return filters.size();
+}
@@ -0,0 +1,109 @@
+#ifndef READCONTEXTFILTER
+#define READCONTEXTFILTER
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "PinTypes.h"
+
+using std::vector;
+using std::unordered_map;
+using std::unordered_set;
+
+// Default maximum number of distinct contexts tracked for each instruction performing uninitialized reads
+#define DEFAULT_MAX_READ_CONTEXTS 1024
+// Number of fingerprints held by a bucket of a ContextFilter
+#define CONTEXT_FILTER_BUCKET_SIZE 4
+// Maximum number of fingerprints relocated while inserting a new one in a full bucket
+#define CONTEXT_FILTER_MAX_KICKS 256
+// Maximum number of hashes stored exactly by a ContextFilter before its buckets are allocated
+#define CONTEXT_FILTER_EXACT_SIZE 8
+
+/*
+    Cuckoo filter of context hashes (i.e. hashes of an uninitialized read together with the last writes to the memory
+    it reads, see |memtrace| in MemTrace.cpp).
+    Only a 16-bit fingerprint of each hash is stored, in one of two candidate buckets, so a filter uses a fixed amount of
+    memory, sized to hold |capacity| hashes at half of its load. As a consequence, a hash may rarely be reported as contained
+    even if it has never been inserted (with probability lower than 2 * CONTEXT_FILTER_BUCKET_SIZE / 2^16).
+    Most instructions only read in a few contexts: the first CONTEXT_FILTER_EXACT_SIZE hashes are stored exactly, and the
+    buckets are only allocated when more hashes are inserted. If |capacity| is 0, hashes are always stored exactly, without
+    any limit.
+*/
+class ContextFilter{
+    private:
+        size_t capacity;
+        // Hashes inserted before the buckets are allocated
+        unordered_set<size_t> exactHashes;
+        // CONTEXT_FILTER_BUCKET_SIZE fingerprints for each bucket. Empty slots are 0. Empty until the buckets are allocated.
+        vector<uint16_t> slots;
+        size_t bucketsMask;
+        size_t count;
+        // Fingerprint evicted by the last failed insertion, if any
+        uint16_t victim;
+        size_t victimBucket;
+        unsigned kickSeed;
+
+        static uint16_t getFingerprint(size_t hash);
+        size_t getAlternateBucket(size_t bucket, uint16_t fingerprint) const;
+        bool bucketContains(size_t bucket, uint16_t fingerprint) const;
+        bool bucketInsert(size_t bucket, uint16_t fingerprint);
+        bool insertFingerprint(size_t hash);
+        // Allocates the buckets and moves |exactHashes| into them
+        void allocateBuckets();
+
+    public:
+        // If |capacity| is 0, the number of hashes is not limited
+        ContextFilter(size_t capacity);
+
+        bool contains(size_t hash) const;
+        // Returns false if the filter is full (in which case |hash| is not inserted)
+        bool insert(size_t hash);
+        size_t size() const;
+};
+
+/*
+    Keeps track of the contexts in which uninitialized reads have already been reported, so that reads executed again and again
+    in the same context (e.g. inside a loop) are only stored once.
+    Contexts are tracked by a ContextFilter for each instruction, up to a maximum number of distinct contexts: once it is reached,
+    the uninitialized reads of that instruction in new contexts are not stored anymore, and only counted.
+*/
+class ReadContextFilter{ // Singleton
+    public:
+        enum Result{
+            // First time the read is executed in this context
+            NEW,
+            // The read has already been executed in this context
+            DUPLICATE,
+            // The instruction already reached the maximum number of contexts
+            LIMIT_REACHED
+        };
+
+    private:
+        unordered_map<ADDRINT, ContextFilter> filters;
+        size_t maxContexts;
+
+        ReadContextFilter();
+
+    public:
+        ReadContextFilter(ReadContextFilter const& other) = delete;
+        void operator=(ReadContextFilter const& other) = delete;
+
+        static ReadContextFilter& getInstance();
+
+        // If |maxContexts| is 0, the number of contexts is not limited
+        void setMaxContexts(size_t maxContexts);
+
+        // Records that the uninitialized read performed by the instruction at |ip| has been executed in the context identified by |hash|
+        Result insert(ADDRINT ip, size_t hash);
+
+        // Forgets every tracked context (e.g. before a new iteration of the persistent mode)
+        void clear();
+
+        // Number of instructions whose contexts are tracked
+        size_t getTrackedInstructions() const;
+};
+
+#endif // READCONTEXTFILTER
@@ -0,0 +1,143 @@
+#ifndef REPORTFORMAT
+#define REPORTFORMAT
+
+#include <stdint.h>
+
+/*
+Layout of the binary report (version 4).
+The file starts with a fixed-size |Header|, followed by a set of sections. The header stores the offset
+and the number of records of each section, so that readers can mmap the report and directly jump to any
+of them. Every section is an array of fixed-width little-endian records, except for the string table,
+which is a sequence of NUL-terminated strings referenced by their offset inside the section.
+Sections are written in the following order: entries, intervals, full overlaps, partial overlaps,
+instructions, images, strings. All the records have a size multiple of 8 bytes, so every section
+(but the string table) is 8 bytes aligned.
+Version 3 adds the fingerprint of every entry, which allows tools merging many reports to find identical
+access sets through a hash index instead of comparing them pairwise.
+Version 4 adds the flags of the report (see |HeaderFlags|) to the header.
+NOTE: this header is intentionally independent of Intel PIN, as it is shared with the tools reading the reports.
+*/
+namespace ReportFormat{
+    const char MAGIC[8] = {'M', 'T', 'R', 'E', 'P', 'O', 'R', 'T'};
+    const uint32_t VERSION = 4;
+
+    // Value used as image index by instructions not belonging to any known image
+    const uint32_t NO_IMAGE = 0xffffffff;
+
+    enum Section{
+        ENTRIES,
+        INTERVALS,
+        FULL_OVERLAPS,
+        PARTIAL_OVERLAPS,
+        INSTRUCTIONS,
+        IMAGES,
+        STRINGS,
+        SECTIONS_NUM
+    };
+
+    // Flags of an entry (field |flags| of |EntryRecord|)
+    enum EntryFlags{
+        UNINITIALIZED_READ = 1,
+        WRITE = 1 << 1,
+        STACK = 1 << 2,
+        PARTIAL_OVERLAP = 1 << 3
+    };
+
+    // Flags of the report (field |flags| of |Header|)
+    enum HeaderFlags{
+        // The analysis has been stopped because an execution budget was exhausted (e.g. --max-time), so the report
+        // only contains the accesses traced up to that point, or some of the accesses spilled because of the memory
+        // budget (see AccessSpill.h) can't be read back
+        TRUNCATED = 1
+    };
+
+    // NOTE: for the string table, |count| is the size of the section in bytes
+    struct SectionDescriptor{
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    struct Header{
+        char magic[8];
+        uint32_t version;
+        uint32_t regSize;
+        uint64_t stackBase;
+        uint32_t flags;
+        uint32_t reserved;
+        SectionDescriptor sections[SECTIONS_NUM];
+    };
+
+    struct ImageRecord{
+        uint64_t baseAddress;
+        uint32_t nameOffset;
+        uint32_t reserved;
+    };
+
+    // Instructions are stored only once, and referenced by entries through their index
+    struct InstructionRecord{
+        uint64_t ip;
+        uint64_t actualIp;
+        uint32_t disasmOffset;
+        uint32_t imageIndex;
+    };
+
+    // A set of accesses overlapping with the same AccessIndex. Its entries are the |entriesCount|
+    // records of the entries section starting from index |firstEntry|
+    struct AccessSetRecord{
+        uint64_t address;
+        uint32_t size;
+        uint32_t entriesCount;
+        uint64_t firstEntry;
+    };
+
+    // |fingerprint| identifies the entry independently of the address its image has been loaded at:
+    // it is computed by |entryFingerprint| from the ip, the offset of the actual ip from the base address of
+    // its image (or the actual ip itself, if it does not belong to any image), flags, size and intervals.
+    // Entries considered identical when merging reports always have the same fingerprint.
+    struct EntryRecord{
+        uint32_t instructionIndex;
+        uint32_t size;
+        int64_t spOffset;
+        int64_t bpOffset;
+        uint32_t flags;
+        uint32_t intervalsCount;
+        uint64_t firstInterval;
+        uint64_t fingerprint;
+    };
+
+    struct IntervalRecord{
+        uint32_t lowerBound;
+        uint32_t upperBound;
+    };
+
+    const uint64_t FINGERPRINT_SEED = 0xcbf29ce484222325ULL;
+
+    // Adds |value| to |hash| (64 bits FNV-1a)
+    inline uint64_t addToFingerprint(uint64_t hash, uint64_t value){
+        for(int i = 0; i < 8; ++i){
+            hash ^= (value >> (i * 8)) & 0xff;
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    inline uint64_t entryFingerprint(uint64_t ip, uint64_t imageOffset, const EntryRecord& entry, const IntervalRecord* intervals){
+        uint64_t hash = FINGERPRINT_SEED;
+        hash = addToFingerprint(hash, ip);
+        hash = addToFingerprint(hash, imageOffset);
+        hash = addToFingerprint(hash, ((uint64_t) entry.flags << 32) | entry.size);
+        for(uint32_t i = 0; i < entry.intervalsCount; ++i){
+            hash = addToFingerprint(hash, ((uint64_t) intervals[i].lowerBound << 32) | intervals[i].upperBound);
+        }
+        return hash;
+    }
+
+    static_assert(sizeof(Header) == 32 + SECTIONS_NUM * sizeof(SectionDescriptor), "Unexpected padding in report header");
+    static_assert(sizeof(ImageRecord) == 16, "Unexpected padding in image records");
+    static_assert(sizeof(InstructionRecord) == 24, "Unexpected padding in instruction records");
+    static_assert(sizeof(AccessSetRecord) == 24, "Unexpected padding in access set records");
+    static_assert(sizeof(EntryRecord) == 48, "Unexpected padding in entry records");
+    static_assert(sizeof(IntervalRecord) == 8, "Unexpected padding in interval records");
+}
+
+#endif // REPORTFORMAT
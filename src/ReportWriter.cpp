@@ -0,0 +1,144 @@
+#include "ReportWriter.h"
+
+ReportWriter::ReportWriter(const std::string& path, const std::map<std::string, ADDRINT>& imagesBase, ADDRINT stackBase, uint32_t flags) :
+    report(path.c_str(), std::ios_base::binary),
+    writingFullOverlaps(true),
+    entriesCount(0)
+{
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ReportFormat::MAGIC, sizeof(header.magic));
+    header.version = ReportFormat::VERSION;
+    header.regSize = sizeof(ADDRINT);
+    header.stackBase = stackBase;
+    header.flags = flags;
+
+    for(auto iter = imagesBase.begin(); iter != imagesBase.end(); ++iter){
+        ReportFormat::ImageRecord image;
+        image.baseAddress = iter->second;
+        image.nameOffset = getStringOffset(iter->first);
+        image.reserved = 0;
+        imagesByAddress[iter->second] = images.size();
+        images.push_back(image);
+    }
+
+    // The header is written again by |close|, once all the offsets are known
+    report.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    header.sections[ReportFormat::ENTRIES].offset = sizeof(header);
+}
+
+uint32_t ReportWriter::getStringOffset(const std::string& s){
+    auto iter = stringsIndex.find(s);
+    if(iter != stringsIndex.end())
+        return iter->second;
+
+    uint32_t offset = strings.size();
+    strings.append(s);
+    strings.push_back('\0');
+    stringsIndex[s] = offset;
+    return offset;
+}
+
+uint32_t ReportWriter::getInstructionIndex(const MemoryAccess& ma){
+    std::pair<ADDRINT, ADDRINT> key(ma.getIP(), ma.getActualIP());
+    auto iter = instructionsIndex.find(key);
+    if(iter != instructionsIndex.end())
+        return iter->second;
+
+    ReportFormat::InstructionRecord instruction;
+    instruction.ip = key.first;
+    instruction.actualIp = key.second;
+    instruction.disasmOffset = getStringOffset(ma.getDisasm());
+
+    // The instruction belongs to the image with the highest load address lower than or equal to its address
+    auto image = imagesByAddress.upper_bound(key.second);
+    instruction.imageIndex = image == imagesByAddress.begin() ? ReportFormat::NO_IMAGE : (--image)->second;
+
+    uint32_t index = instructions.size();
+    instructions.push_back(instruction);
+    instructionsIndex[key] = index;
+    return index;
+}
+
+void ReportWriter::beginSet(const AccessIndex& ai){
+    currentSet.address = ai.getFirst();
+    currentSet.size = ai.getSecond();
+    currentSet.entriesCount = 0;
+    currentSet.firstEntry = entriesCount;
+}
+
+void ReportWriter::addEntry(const MemoryAccess& ma, bool isPartialOverlap, const set<std::pair<unsigned, unsigned>>& accessIntervals){
+    ReportFormat::EntryRecord entry;
+    entry.instructionIndex = getInstructionIndex(ma);
+    entry.size = ma.getSize();
+    entry.spOffset = ma.getSPOffset();
+    entry.bpOffset = ma.getBPOffset();
+    entry.flags = 0;
+    if(ma.getIsUninitializedRead())
+        entry.flags |= ReportFormat::UNINITIALIZED_READ;
+    if(ma.getType() == AccessType::WRITE)
+        entry.flags |= ReportFormat::WRITE;
+    if(ma.isStackAccess())
+        entry.flags |= ReportFormat::STACK;
+    if(isPartialOverlap)
+        entry.flags |= ReportFormat::PARTIAL_OVERLAP;
+    entry.intervalsCount = accessIntervals.size();
+    entry.firstInterval = intervals.size();
+
+    for(const std::pair<unsigned, unsigned>& p : accessIntervals){
+        ReportFormat::IntervalRecord interval;
+        interval.lowerBound = p.first;
+        interval.upperBound = p.second;
+        intervals.push_back(interval);
+    }
+
+    const ReportFormat::InstructionRecord& instruction = instructions[entry.instructionIndex];
+    uint64_t imageOffset = instruction.actualIp;
+    if(instruction.imageIndex != ReportFormat::NO_IMAGE)
+        imageOffset -= images[instruction.imageIndex].baseAddress;
+    entry.fingerprint = ReportFormat::entryFingerprint(instruction.ip, imageOffset, entry, intervals.data() + entry.firstInterval);
+
+    report.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    ++entriesCount;
+    ++currentSet.entriesCount;
+}
+
+void ReportWriter::endSet(){
+    // Sets whose entries have all been discarded are not worth reporting
+    if(currentSet.entriesCount == 0)
+        return;
+
+    if(writingFullOverlaps)
+        fullOverlaps.push_back(currentSet);
+    else
+        partialOverlaps.push_back(currentSet);
+}
+
+void ReportWriter::endFullOverlaps(){
+    writingFullOverlaps = false;
+}
+
+void ReportWriter::writeSection(ReportFormat::Section section, const void* data, uint64_t size, uint64_t count){
+    header.sections[section].offset = report.tellp();
+    header.sections[section].count = count;
+    if(size > 0)
+        report.write(reinterpret_cast<const char*>(data), size);
+}
+
+void ReportWriter::addFlags(uint32_t flags){
+    header.flags |= flags;
+}
+
+void ReportWriter::close(){
+    header.sections[ReportFormat::ENTRIES].count = entriesCount;
+
+    writeSection(ReportFormat::INTERVALS, intervals.data(), intervals.size() * sizeof(ReportFormat::IntervalRecord), intervals.size());
+    writeSection(ReportFormat::FULL_OVERLAPS, fullOverlaps.data(), fullOverlaps.size() * sizeof(ReportFormat::AccessSetRecord), fullOverlaps.size());
+    writeSection(ReportFormat::PARTIAL_OVERLAPS, partialOverlaps.data(), partialOverlaps.size() * sizeof(ReportFormat::AccessSetRecord), partialOverlaps.size());
+    writeSection(ReportFormat::INSTRUCTIONS, instructions.data(), instructions.size() * sizeof(ReportFormat::InstructionRecord), instructions.size());
+    writeSection(ReportFormat::IMAGES, images.data(), images.size() * sizeof(ReportFormat::ImageRecord), images.size());
+    writeSection(ReportFormat::STRINGS, strings.data(), strings.size(), strings.size());
+
+    report.seekp(0);
+    report.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    report.close();
+}
@@ -0,0 +1,63 @@
+#ifndef REPORTWRITER
+#define REPORTWRITER
+
+#include "pin.H"
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_map>
+
+#include "ReportFormat.h"
+#include "AccessIndex.h"
+#include "MemoryAccess.h"
+
+// Writes the binary report (see ReportFormat.h).
+// Entries are directly streamed to the file, while the (much smaller) tables are kept in memory
+// and written by |close|, which also fills the header with the offsets of every section.
+class ReportWriter{
+    private:
+        std::ofstream report;
+        ReportFormat::Header header;
+        bool writingFullOverlaps;
+
+        uint64_t entriesCount;
+        std::vector<ReportFormat::IntervalRecord> intervals;
+        std::vector<ReportFormat::AccessSetRecord> fullOverlaps;
+        std::vector<ReportFormat::AccessSetRecord> partialOverlaps;
+        std::vector<ReportFormat::InstructionRecord> instructions;
+        std::vector<ReportFormat::ImageRecord> images;
+        std::string strings;
+
+        std::map<std::pair<ADDRINT, ADDRINT>, uint32_t> instructionsIndex;
+        std::unordered_map<std::string, uint32_t> stringsIndex;
+        // Images load addresses, ordered, mapped to their index inside |images|
+        std::map<ADDRINT, uint32_t> imagesByAddress;
+
+        ReportFormat::AccessSetRecord currentSet;
+
+        uint32_t getStringOffset(const std::string& s);
+        uint32_t getInstructionIndex(const MemoryAccess& ma);
+        void writeSection(ReportFormat::Section section, const void* data, uint64_t size, uint64_t count);
+
+    public:
+        // |flags| is a combination of ReportFormat::HeaderFlags
+        ReportWriter(const std::string& path, const std::map<std::string, ADDRINT>& imagesBase, ADDRINT stackBase, uint32_t flags);
+
+        void beginSet(const AccessIndex& ai);
+
+        void addEntry(const MemoryAccess& ma, bool isPartialOverlap, const set<std::pair<unsigned, unsigned>>& accessIntervals);
+
+        void endSet();
+
+        // Every set added after this call is written in the partial overlaps section
+        void endFullOverlaps();
+
+        // Adds |flags| (a combination of ReportFormat::HeaderFlags) to the ones passed to the constructor
+        void addFlags(uint32_t flags);
+
+        void close();
+};
+
+#endif // REPORTWRITER
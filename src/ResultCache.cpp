@@ -0,0 +1,311 @@
+#include "ResultCache.h"
+#include "ReportFormat.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <elf.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// FNV-1a 128 bits parameters
+#define FNV128_OFFSET_BASIS ((((unsigned __int128) 0x6c62272e07bb0142ULL) << 64) | 0x62b821756295c58dULL)
+#define FNV128_PRIME ((((unsigned __int128) 1) << 88) | 0x13bULL)
+
+ContentHash::ContentHash() : state(FNV128_OFFSET_BASIS){}
+
+void ContentHash::update(const void* data, size_t len){
+    const uint8_t* bytes = (const uint8_t*) data;
+    for(size_t i = 0; i < len; ++i){
+        state ^= bytes[i];
+        state *= FNV128_PRIME;
+    }
+}
+
+void ContentHash::update(const std::string& s){
+    update((uint64_t) s.size());
+    update(s.data(), s.size());
+}
+
+void ContentHash::update(uint64_t value){
+    update(&value, sizeof(value));
+}
+
+bool ContentHash::updateFile(const std::string& path){
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return false;
+
+    bool ret = updateFile(fd);
+    close(fd);
+    return ret;
+}
+
+bool ContentHash::updateFile(int fd){
+    char buffer[1 << 16];
+    off_t offset = 0;
+    ssize_t len;
+
+    // pread does not move the file offset: if |fd| is stdin, the application still reads it from the beginning
+    while((len = pread(fd, buffer, sizeof(buffer), offset)) != 0){
+        if(len < 0){
+            if(errno == EINTR)
+                continue;
+            return false;
+        }
+
+        update(buffer, len);
+        offset += len;
+    }
+
+    update((uint64_t) offset);
+    return true;
+}
+
+std::string ContentHash::hexDigest() const{
+    char ret[33];
+    snprintf(ret, sizeof(ret), "%016llx%016llx", (unsigned long long) (state >> 64), (unsigned long long) state);
+    return std::string(ret);
+}
+
+template<typename Ehdr, typename Phdr>
+static bool findBuildId(const uint8_t* image, size_t size, std::string& buildId){
+    if(size < sizeof(Ehdr))
+        return false;
+
+    const Ehdr* ehdr = (const Ehdr*) image;
+    if(ehdr->e_phentsize != sizeof(Phdr) || ehdr->e_phoff + (uint64_t) ehdr->e_phnum * sizeof(Phdr) > size)
+        return false;
+
+    const Phdr* phdrs = (const Phdr*) (image + ehdr->e_phoff);
+    for(unsigned i = 0; i < ehdr->e_phnum; ++i){
+        if(phdrs[i].p_type != PT_NOTE || phdrs[i].p_offset + phdrs[i].p_filesz > size)
+            continue;
+
+        // Notes have the same layout in 32 and 64 bits executables
+        const uint8_t* note = image + phdrs[i].p_offset;
+        const uint8_t* end = note + phdrs[i].p_filesz;
+        while(note + sizeof(Elf32_Nhdr) <= end){
+            const Elf32_Nhdr* nhdr = (const Elf32_Nhdr*) note;
+            const uint8_t* name = note + sizeof(Elf32_Nhdr);
+            const uint8_t* desc = name + ((nhdr->n_namesz + 3) & ~3U);
+            const uint8_t* next = desc + ((nhdr->n_descsz + 3) & ~3U);
+            if(next > end || next < note)
+                break;
+
+            if(nhdr->n_type == NT_GNU_BUILD_ID && nhdr->n_namesz == 4 && memcmp(name, "GNU", 4) == 0 && nhdr->n_descsz > 0){
+                buildId.assign((const char*) desc, nhdr->n_descsz);
+                return true;
+            }
+
+            note = next;
+        }
+    }
+
+    return false;
+}
+
+ResultCache::ResultCache(const std::string& cacheDir) : cacheDir(cacheDir){}
+
+bool ResultCache::hashExecutable(ContentHash& hash, const std::string& path){
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return false;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)){
+        close(fd);
+        return false;
+    }
+
+    std::string buildId;
+    void* image = st.st_size > 0 ? mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    if(image != MAP_FAILED){
+        const uint8_t* bytes = (const uint8_t*) image;
+        if((size_t) st.st_size > EI_CLASS && memcmp(bytes, ELFMAG, SELFMAG) == 0){
+            if(bytes[EI_CLASS] == ELFCLASS64)
+                findBuildId<Elf64_Ehdr, Elf64_Phdr>(bytes, st.st_size, buildId);
+            else if(bytes[EI_CLASS] == ELFCLASS32)
+                findBuildId<Elf32_Ehdr, Elf32_Phdr>(bytes, st.st_size, buildId);
+        }
+        munmap(image, st.st_size);
+    }
+
+    bool ret = true;
+    if(!buildId.empty()){
+        hash.update(std::string("build-id"));
+        hash.update(buildId);
+    }
+    else{
+        // Executables without a build-id (e.g. scripts or binaries linked with --build-id=none) are identified by their content
+        hash.update(std::string("content"));
+        ret = hash.updateFile(fd);
+    }
+
+    close(fd);
+    return ret;
+}
+
+bool ResultCache::computeKey(const std::string& toolPath, char** args, char** envp){
+    ContentHash hash;
+    hash.update((uint64_t) RESULT_CACHE_VERSION);
+
+    if(!hash.updateFile(toolPath))
+        return false;
+
+    // Knobs of the tool
+    char** arg = args;
+    reportPath = "overlaps.bin";
+    for(; *arg != NULL && strcmp(*arg, "--") != 0; ++arg){
+        // Those modes generate a report for each iteration, whose paths are not known here
+        if(strcmp(*arg, "--persistent-fn") == 0 || (strcmp(*arg, "--fork-server") == 0 && (*(arg + 1) == NULL || strcmp(*(arg + 1), "OFF") != 0)))
+            return false;
+
+        if(strcmp(*arg, "-o") == 0 && *(arg + 1) != NULL){
+            reportPath = *(++arg);
+            continue;
+        }
+
+        // Statistics don't affect the report, and their path usually changes with each execution
+        if(strcmp(*arg, "--stats") == 0 && *(arg + 1) != NULL){
+            ++arg;
+            continue;
+        }
+
+        hash.update(std::string(*arg));
+    }
+
+    if(*arg == NULL || *(arg + 1) == NULL)
+        return false;
+    ++arg;
+
+    // The executable and its arguments
+    if(!hashExecutable(hash, *arg))
+        return false;
+    hash.update(std::string(*arg));
+
+    for(++arg; *arg != NULL; ++arg){
+        // Files are identified by their content only, as the same input may be analyzed from different directories
+        // (e.g. a copy in the folder of each testcase)
+        struct stat st;
+        if(stat(*arg, &st) == 0 && S_ISREG(st.st_mode)){
+            hash.update(std::string("file"));
+            hash.update((uint64_t) st.st_size);
+            if(!hash.updateFile(*arg))
+                return false;
+        }
+        else{
+            hash.update(std::string(*arg));
+        }
+    }
+
+    hash.update(std::string("environ"));
+    for(char** env = envp; *env != NULL; ++env){
+        hash.update(std::string(*env));
+    }
+
+    char* cwd = getcwd(NULL, 0);
+    if(cwd == NULL)
+        return false;
+    hash.update(std::string(cwd));
+    free(cwd);
+
+    // If stdin is a pipe or a terminal, its content can't be known in advance
+    struct stat st;
+    if(fstat(STDIN_FILENO, &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+    hash.update(std::string("stdin"));
+    if(!hash.updateFile(STDIN_FILENO))
+        return false;
+
+    key = hash.hexDigest();
+    return true;
+}
+
+std::string ResultCache::entryPath() const{
+    return cacheDir + "/" + key + ".bin";
+}
+
+bool ResultCache::copyFile(const std::string& src, const std::string& dst){
+    int in = open(src.c_str(), O_RDONLY | O_CLOEXEC);
+    if(in < 0)
+        return false;
+
+    int out = open(dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(out < 0){
+        close(in);
+        return false;
+    }
+
+    char buffer[1 << 16];
+    ssize_t len;
+    bool ret = true;
+    while(ret && (len = read(in, buffer, sizeof(buffer))) != 0){
+        if(len < 0){
+            ret = errno == EINTR;
+            continue;
+        }
+
+        for(ssize_t written = 0; written < len;){
+            ssize_t chunk = write(out, buffer + written, len - written);
+            if(chunk < 0 && errno == EINTR)
+                continue;
+            if(chunk <= 0){
+                ret = false;
+                break;
+            }
+            written += chunk;
+        }
+    }
+
+    close(in);
+    return close(out) == 0 && ret;
+}
+
+bool ResultCache::restore() const{
+    if(key.empty() || access(entryPath().c_str(), R_OK) != 0)
+        return false;
+
+    if(!copyFile(entryPath(), reportPath)){
+        unlink(reportPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool ResultCache::isReportTruncated() const{
+    ReportFormat::Header header;
+    int fd = open(reportPath.c_str(), O_RDONLY);
+    if(fd < 0)
+        return true;
+
+    bool isValid = read(fd, &header, sizeof(header)) == (ssize_t) sizeof(header) &&
+        memcmp(header.magic, ReportFormat::MAGIC, sizeof(header.magic)) == 0 && header.version == ReportFormat::VERSION;
+    close(fd);
+
+    return !isValid || (header.flags & ReportFormat::TRUNCATED) != 0;
+}
+
+bool ResultCache::store() const{
+    if(key.empty())
+        return false;
+
+    mkdir(cacheDir.c_str(), 0755);
+
+    // Many tracer processes may store the same entry concurrently: write a private copy and atomically rename it
+    std::string tmpPath = entryPath() + ".tmp." + std::to_string(getpid());
+    if(!copyFile(reportPath, tmpPath) || rename(tmpPath.c_str(), entryPath().c_str()) != 0){
+        unlink(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+const std::string& ResultCache::getKey() const{
+    return key;
+}
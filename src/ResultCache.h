@@ -0,0 +1,77 @@
+#ifndef RESULTCACHE
+#define RESULTCACHE
+
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+
+// Version of the key layout. Bump it whenever |computeKey| changes, so that stale entries are never returned.
+#define RESULT_CACHE_VERSION 2
+
+// Incremental FNV-1a (128 bits) hash, used to compute the keys of the cache
+class ContentHash{
+    private:
+        unsigned __int128 state;
+
+    public:
+        ContentHash();
+
+        void update(const void* data, size_t len);
+        // Hashes the string together with its length, so that consecutive strings can't be confused
+        void update(const std::string& s);
+        void update(uint64_t value);
+        // Hashes the whole content of the file at |path| (or of the file |fd| refers to).
+        // Returns false if the file can't be read.
+        bool updateFile(const std::string& path);
+        bool updateFile(int fd);
+
+        std::string hexDigest() const;
+};
+
+/*
+    Content-addressed cache of the binary reports generated by the tool.
+    A report is identified by:
+        - the build-id of the analyzed executable (or the hash of its content, if it has none);
+        - the hash of the tool library, so that a new version of the tool never uses old results;
+        - the knobs passed to the tool (except the paths of the files it writes, i.e. the report and the statistics);
+        - the command line arguments of the executable. Arguments which are the path of a regular file (i.e. the input
+          file generated by the fuzzer) are identified by their content only, wherever the file is;
+        - the environment variables and the current working directory;
+        - the content of stdin.
+    Executions whose result can't be determined by the key (e.g. stdin is a pipe or the tool runs in persistent or
+    fork server mode, generating many reports) are not cached.
+*/
+class ResultCache{
+    private:
+        std::string cacheDir;
+        std::string key;
+        std::string reportPath;
+
+        std::string entryPath() const;
+
+        static bool copyFile(const std::string& src, const std::string& dst);
+        static bool hashExecutable(ContentHash& hash, const std::string& path);
+
+    public:
+        ResultCache(const std::string& cacheDir);
+
+        // |args| is the NULL terminated list of arguments passed to the launcher: the knobs of the tool,
+        // followed by '--' and by the command line of the executable.
+        // Returns false if the execution can't be cached.
+        bool computeKey(const std::string& toolPath, char** args, char** envp);
+
+        // If the report has already been generated, copies it to the output path of the tool and returns true
+        bool restore() const;
+
+        // Returns true if the report generated by the tool is flagged as truncated (i.e. the analysis has been stopped
+        // because an execution budget was exhausted), or if its header can't be read. Such reports depend on the timing
+        // of the execution, so they must not be stored.
+        bool isReportTruncated() const;
+
+        // Adds the report generated by the tool to the cache
+        bool store() const;
+
+        const std::string& getKey() const;
+};
+
+#endif // RESULTCACHE
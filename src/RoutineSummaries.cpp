@@ -0,0 +1,93 @@
+#include "RoutineSummaries.h"
+
+#include <cstring>
+
+RoutineSummaries::RoutineSummaries() : enabled(true){}
+
+RoutineSummaries& RoutineSummaries::getInstance(){
+    static RoutineSummaries instance;
+
+    return instance;
+}
+
+void RoutineSummaries::enable(bool enabled){
+    this->enabled = enabled;
+}
+
+bool RoutineSummaries::isEnabled() const{
+    return enabled;
+}
+
+bool RoutineSummaries::matches(const std::string& name, const char* routine){
+    // Variants append a suffix to the name of the routine (e.g. __memset_chk, __memset_avx2_unaligned_erms)
+    size_t length = strlen(routine);
+    if(name.compare(0, length, routine) != 0 || (name.size() != length && name[length] != '_'))
+        return false;
+
+    return name.size() < length + 2 || name.compare(name.size() - 2, 2, "_s") != 0;
+}
+
+bool RoutineSummaries::isLibc(IMG img){
+    const std::string& name = IMG_Name(img);
+    size_t slash = name.find_last_of('/');
+    size_t start = slash == std::string::npos ? 0 : slash + 1;
+
+    // e.g. libc.so.6 or libc-2.31.so
+    return name.compare(start, 5, "libc.") == 0 || name.compare(start, 5, "libc-") == 0;
+}
+
+RoutineSummaries::Kind RoutineSummaries::classify(const std::string& name){
+    std::string baseName = name.substr(0, name.find('@'));
+
+    // Helper of old versions of string2.h, with a different signature
+    if(baseName == "__mempcpy_small")
+        return NONE;
+
+    if(
+        matches(baseName, "memcpy") || matches(baseName, "memmove") || matches(baseName, "mempcpy") ||
+        matches(baseName, "__memcpy") || matches(baseName, "__memmove") || matches(baseName, "__mempcpy")
+    ){
+        return COPY;
+    }
+
+    if(matches(baseName, "memset") || matches(baseName, "__memset"))
+        return SET;
+
+    if(matches(baseName, "bzero") || matches(baseName, "__bzero"))
+        return ZERO;
+
+    // Optimized versions of wmemset share their code with memset, so they must be summarized as well
+    if(matches(baseName, "wmemset") || matches(baseName, "__wmemset"))
+        return WIDE_SET;
+
+    return NONE;
+}
+
+RoutineSummaries::Kind RoutineSummaries::addRoutine(RTN rtn){
+    if(!enabled || RTN_Size(rtn) == 0 || !isLibc(SEC_Img(RTN_Sec(rtn))))
+        return NONE;
+
+    Kind kind = classify(RTN_Name(rtn));
+    if(kind == NONE || SYM_IFuncResolver(RTN_Sym(rtn)))
+        return NONE;
+
+    ADDRINT start = RTN_Address(rtn);
+    ranges[start] = start + RTN_Size(rtn) - 1;
+    return kind;
+}
+
+void RoutineSummaries::onImageUnload(IMG img){
+    auto iter = ranges.lower_bound(IMG_LowAddress(img));
+    while(iter != ranges.end() && iter->first <= IMG_HighAddress(img)){
+        iter = ranges.erase(iter);
+    }
+}
+
+bool RoutineSummaries::isSummarized(ADDRINT addr) const{
+    auto iter = ranges.upper_bound(addr);
+    if(iter == ranges.begin())
+        return false;
+
+    --iter;
+    return addr <= iter->second;
+}
@@ -0,0 +1,68 @@
+#ifndef ROUTINESUMMARIES
+#define ROUTINESUMMARIES
+
+#include "pin.H"
+#include <string>
+#include <map>
+
+/*
+    Keeps track of the libc routines copying or setting memory (memcpy, memmove, mempcpy, memset, bzero, wmemset and the
+    variants selected by their IFUNC resolvers, e.g. __memmove_avx_unaligned_erms), identified by name when libc is loaded.
+    Routines of other images are never summarized, even if their names match (e.g. a memcpy defined by the application),
+    as their arguments may be different.
+    Their optimized implementations execute long sequences of wide accesses, each one analyzed on its own. Instead, a call
+    to one of them is replaced by a single bulk update of the shadow memory (see |summarizeRoutine| in MemTrace.cpp),
+    and their instructions are only instrumented to keep registers and the stack consistent.
+*/
+class RoutineSummaries{ // Singleton
+    public:
+        enum Kind{
+            NONE,
+            // (dst, src, n): the status of [src, src + n) is copied to [dst, dst + n)
+            COPY,
+            // (dst, c, n): [dst, dst + n) is initialized
+            SET,
+            // (dst, n): [dst, dst + n) is initialized
+            ZERO,
+            // (dst, wc, n): [dst, dst + n * sizeof(wchar_t)) is initialized
+            WIDE_SET
+        };
+
+    private:
+        bool enabled;
+        // Disjoint ranges of addresses of the summarized routines, mapping their first address to their last one
+        std::map<ADDRINT, ADDRINT> ranges;
+
+        RoutineSummaries();
+
+    public:
+        RoutineSummaries(RoutineSummaries const& other) = delete;
+        void operator=(RoutineSummaries const& other) = delete;
+
+        static RoutineSummaries& getInstance();
+
+        void enable(bool enabled);
+        bool isEnabled() const;
+
+        // Returns true if |name| is |routine| or one of its variants (i.e. |routine| followed by '_' and any suffix).
+        // Bounds-checking variants (e.g. memcpy_s of C11 Annex K) take different arguments, so they never match.
+        static bool matches(const std::string& name, const char* routine);
+
+        // Returns true if |img| is the C library (e.g. libc.so.6)
+        static bool isLibc(IMG img);
+
+        // Returns the kind of summary of the routine called |name| (without any symbol version, e.g. memcpy@GLIBC_2.2.5)
+        static Kind classify(const std::string& name);
+
+        // Returns the kind of summary of |rtn|. If it is not NONE, the addresses of the routine are recorded, and the
+        // routine must be instrumented with its summary.
+        // Only routines of libc are summarized, except for IFUNC resolvers (e.g. the routine named memcpy).
+        Kind addRoutine(RTN rtn);
+
+        // Must be called whenever an image is unloaded
+        void onImageUnload(IMG img);
+
+        bool isSummarized(ADDRINT addr) const;
+};
+
+#endif // ROUTINESUMMARIES
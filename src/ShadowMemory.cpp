@@ -1,13 +1,16 @@
 #include <vector>
+#include <algorithm>
 
 #include "ShadowMemory.h"
+#include "ShadowPagePool.h"
 
 using std::vector;
 
 unordered_map<ADDRINT, HeapShadow> mmapShadows;
 unsigned long mmapShadowsCounter = 0;
 
-static unsigned long SHADOW_ALLOCATION = sysconf(_SC_PAGESIZE);
+static ShadowPagePool& pagePool = ShadowPagePool::getInstance();
+static unsigned long SHADOW_ALLOCATION = pagePool.getPageSize();
 
 unsigned long long ShadowBase::min(unsigned long long x, unsigned long long y){
     return x <= y ? x : y;
@@ -24,13 +27,21 @@ uint8_t* ShadowBase::shadow_memory_copy(ADDRINT addr, UINT32 size){
     uint8_t* ret = (uint8_t*) malloc(sizeof(uint8_t) * shadowSize);
     UINT32 copied = 0;
     while(copied != shadowSize){
-        uint8_t* highestCopied = (uint8_t*)min(
-            (unsigned long long) shadowAddr + (shadowSize - copied) - 1,
-            (unsigned long long) shadow[shadowIdx] + SHADOW_ALLOCATION - 1
-        );
+        UINT32 toCopy;
+        // Pages never allocated by HeapShadow have never been written
+        if(shadowAddr == NULL){
+            toCopy = min(shadowSize - copied, SHADOW_ALLOCATION);
+            memset(ret + copied, 0, toCopy);
+        }
+        else{
+            uint8_t* highestCopied = (uint8_t*)min(
+                (unsigned long long) shadowAddr + (shadowSize - copied) - 1,
+                (unsigned long long) shadow[shadowIdx] + SHADOW_ALLOCATION - 1
+            );
 
-        UINT32 toCopy = highestCopied - shadowAddr + 1;
-        memcpy(ret + copied, shadowAddr, toCopy);
+            toCopy = highestCopied - shadowAddr + 1;
+            memcpy(ret + copied, shadowAddr, toCopy);
+        }
         copied += toCopy;
         shadowAddr = shadow[++shadowIdx];
     }
@@ -62,11 +73,7 @@ uint8_t* StackShadow::getShadowAddrFromIdx(unsigned* shadowIdxPtr, unsigned offs
     offset >>=3;
     // If the requested address does not have a shadow location yet, allocate it
     while(shadowIdx >= shadow.size()){
-        uint8_t* newMap = (uint8_t*) mmap(NULL, SHADOW_ALLOCATION, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-        if(newMap == (void*) - 1){
-            printf("mmap failed: %s\n", strerror(errno));
-            exit(1);
-        }
+        uint8_t* newMap = pagePool.getPage();
         shadow.push_back(newMap);
         dirtyPages.push_back(false);
     }
@@ -89,6 +96,16 @@ uint8_t* StackShadow::getShadowAddrFromIdx(unsigned* shadowIdxPtr, unsigned offs
     return ret;
 }
 
+uint8_t* StackShadow::getRangePage(size_t pageIdx, bool allocate){
+    // Pages are allocated contiguously, as done by |getShadowAddrFromIdx|
+    while(allocate && pageIdx >= shadow.size()){
+        shadow.push_back(pagePool.getPage());
+        dirtyPages.push_back(false);
+    }
+
+    return pageIdx < shadow.size() ? shadow[pageIdx] : NULL;
+}
+
 void StackShadow::set_as_initialized(ADDRINT addr, UINT32 size, uint8_t* data){
     std::pair<unsigned, unsigned> idxOffset = this->getShadowAddrIdxOffset(addr);
     unsigned shadowIdx = idxOffset.first;
@@ -198,6 +215,10 @@ void StackShadow::set_as_initialized(ADDRINT addr, UINT32 size) {
 //      of the tool more complex.
 
 uint8_t* StackShadow::getUninitializedInterval(ADDRINT addr, UINT32 size) {
+    // Large accesses (e.g. buffers read by system calls) are first checked a whole shadow word at a time
+    if(size >= SHADOW_BULK_MIN_SIZE && firstUninitialized(addr, size) == size)
+        return NULL;
+
     std::pair<unsigned, unsigned> idxOffset = getShadowAddrIdxOffset(addr);
     unsigned shadowIdx = idxOffset.first;
     uint8_t* shadowAddr = this->getShadowAddrFromIdx(&shadowIdx, idxOffset.second);
@@ -289,14 +310,32 @@ void StackShadow::reset(ADDRINT addr) {
     memset(shadowAddr, 0, bottom - (unsigned long long) shadowAddr + 1);
 #endif
 
+    // Pages just below the current stack frame are likely to be written again soon, so they are simply zeroed.
+    // Deeper pages (e.g. the ones used by a deep recursion) are trimmed instead, releasing their physical memory.
+    trimmedPages.resize(shadow.size(), false);
     for(unsigned i = shadowIdx + 1; i < shadow.size(); ++i){
         if(dirtyPages[i]){
-            memset(shadow[i], 0, SHADOW_ALLOCATION);
+            if(i > shadowIdx + STACK_SHADOW_RETAINED_PAGES){
+                trimmedPages[i] = pagePool.trimPage(shadow[i]);
+            }
+            else{
+                memset(shadow[i], 0, SHADOW_ALLOCATION);
+                trimmedPages[i] = false;
+            }
             dirtyPages[i] = false;
         }
     }
 }
 
+size_t StackShadow::getTrimmedPages() const{
+    size_t ret = 0;
+    for(unsigned i = 0; i < trimmedPages.size() && i < dirtyPages.size(); ++i){
+        if(trimmedPages[i] && !dirtyPages[i])
+            ++ret;
+    }
+    return ret;
+}
+
 set<std::pair<unsigned, unsigned>> ShadowBase::computeIntervals(uint8_t* uninitializedInterval, ADDRINT accessAddr, UINT32 accessSize){
     set<std::pair<unsigned, unsigned>> ret;
 
@@ -402,22 +441,425 @@ ShadowBase* ShadowBase::getPtr(){
 }
 
 void ShadowBase::freeMemory(){
-    for(uint8_t* ptr : shadow){
-        munmap(ptr, SHADOW_ALLOCATION);
+    for(unsigned i = 0; i < shadow.size(); ++i){
+        if(shadow[i] != NULL)
+            pagePool.releasePage(shadow[i]);
     }
     shadow.clear();
+    dirtyPages.clear();
+
+    for(uint8_t* ptr : checkpointPages){
+        free(ptr);
+    }
+    checkpointPages.clear();
+    checkpointDirtyPages.clear();
+}
+
+size_t ShadowBase::getAllocatedPages() const{
+    return shadow.getAllocatedPages();
+}
+
+void ShadowBase::checkpoint(){
+    for(uint8_t* ptr : checkpointPages){
+        free(ptr);
+    }
+    checkpointPages.assign(shadow.size(), NULL);
+    checkpointDirtyPages = dirtyPages;
+    checkpointHighestShadowAddr = highestShadowAddr;
+
+    for(unsigned i = 0; i < shadow.size(); ++i){
+        if(!dirtyPages[i])
+            continue;
+
+        checkpointPages[i] = (uint8_t*) malloc(sizeof(uint8_t) * SHADOW_ALLOCATION);
+        memcpy(checkpointPages[i], shadow[i], SHADOW_ALLOCATION);
+    }
+}
+
+void ShadowBase::restoreCheckpoint(){
+    for(unsigned i = 0; i < shadow.size(); ++i){
+        if(i < checkpointPages.size() && checkpointPages[i] != NULL){
+            memcpy(shadow[i], checkpointPages[i], SHADOW_ALLOCATION);
+        }
+        // Clean pages are all zeroes, so only those written after the checkpoint need to be reset
+        else if(dirtyPages[i]){
+            memset(shadow[i], 0, SHADOW_ALLOCATION);
+        }
+    }
+
+    dirtyPages = checkpointDirtyPages;
+    dirtyPages.resize(shadow.size(), false);
+    highestShadowAddr = checkpointHighestShadowAddr;
+}
+
+static inline uint8_t reverseBits(uint8_t value){
+    value = (value & 0xf0) >> 4 | (value & 0x0f) << 4;
+    value = (value & 0xcc) >> 2 | (value & 0x33) << 2;
+    value = (value & 0xaa) >> 1 | (value & 0x55) << 1;
+    return value;
+}
+
+// Mask of the first |count| bytes of a status byte (see ShadowBase::readStatus)
+static inline uint8_t getStatusMask(unsigned count){
+    return count >= 8 ? 0xff : (uint8_t) ((1U << count) - 1);
+}
+
+// Index of the first byte not set as initialized by |status|, which must not be 0xff
+static inline unsigned getFirstUnset(uint8_t status){
+    return __builtin_ctz(~status & 0xff);
+}
+
+// Returns the first byte of [ptr, ptr + size) which is not 0xff, or NULL
+static const uint8_t* findNotFull(const uint8_t* ptr, size_t size){
+    const uint8_t* end = ptr + size;
+    while(end - ptr >= 8){
+        uint64_t word;
+        memcpy(&word, ptr, sizeof(word));
+        if(word != ~0ULL)
+            break;
+        ptr += 8;
+    }
+    for(; ptr != end; ++ptr){
+        if(*ptr != 0xff)
+            return ptr;
+    }
+    return NULL;
+}
+
+// Returns the last byte of [ptr, ptr + size) which is not 0xff, or NULL
+static const uint8_t* findLastNotFull(const uint8_t* ptr, size_t size){
+    const uint8_t* end = ptr + size;
+    while(end - ptr >= 8){
+        uint64_t word;
+        memcpy(&word, end - 8, sizeof(word));
+        if(word != ~0ULL)
+            break;
+        end -= 8;
+    }
+    while(end != ptr){
+        if(*--end != 0xff)
+            return end;
+    }
+    return NULL;
+}
+
+// Restricts [addr, addr + size) to the addresses mirrored by this shadow memory. Returns false if none of them is.
+bool ShadowBase::clipRange(ADDRINT& addr, size_t& size) const{
+    if(descending){
+        // The first granule mirrors the application memory starting at |baseAddr|: nothing is mirrored above it
+        ADDRINT limit = (baseAddr & ~((ADDRINT) 7)) + 8;
+        if(addr >= limit)
+            return false;
+        if(size > limit - addr)
+            size = limit - addr;
+    }
+    else{
+        if(addr + size <= baseAddr)
+            return false;
+        if(addr < baseAddr){
+            size -= baseAddr - addr;
+            addr = baseAddr;
+        }
+    }
+    return size != 0;
+}
+
+size_t ShadowBase::getGranule(ADDRINT alignedAddr) const{
+    return descending ? (baseAddr - alignedAddr) >> 3 : (alignedAddr - baseAddr) >> 3;
+}
+
+// Granules [first, last) mirror the 8-bytes aligned application memory range [from, to)
+void ShadowBase::getGranules(ADDRINT from, ADDRINT to, size_t& first, size_t& last) const{
+    if(descending){
+        first = getGranule(to - 8);
+        last = getGranule(from) + 1;
+    }
+    else{
+        first = getGranule(from);
+        last = getGranule(to - 8) + 1;
+    }
+}
+
+uint8_t* ShadowBase::getGranuleAddr(size_t granule, bool allocate){
+    uint8_t* page = getRangePage(granule / SHADOW_ALLOCATION, allocate);
+    return page != NULL ? page + granule % SHADOW_ALLOCATION : NULL;
+}
+
+void ShadowBase::markWritten(size_t granule, uint8_t* granuleAddr){
+    size_t pageIdx = granule / SHADOW_ALLOCATION;
+    if(pageIdx >= dirtyPages.size())
+        dirtyPages.resize(pageIdx + 1, false);
+    dirtyPages[pageIdx] = true;
+
+    if(granuleAddr > highestShadowAddr)
+        highestShadowAddr = granuleAddr;
+}
+
+uint8_t ShadowBase::readGranule(ADDRINT alignedAddr){
+    // Memory which is not mirrored is considered initialized, as done by |getUninitializedInterval|
+    ADDRINT addr = alignedAddr;
+    size_t size = 8;
+    if(!clipRange(addr, size))
+        return 0xff;
+
+    // Pages which don't exist have never been written
+    uint8_t* granuleAddr = getGranuleAddr(getGranule(alignedAddr), false);
+    if(granuleAddr == NULL)
+        return 0;
+    return descending ? *granuleAddr : reverseBits(*granuleAddr);
+}
+
+void ShadowBase::writeGranule(ADDRINT alignedAddr, uint8_t mask, uint8_t status){
+    ADDRINT addr = alignedAddr;
+    size_t size = 8;
+    if(mask == 0 || !clipRange(addr, size))
+        return;
+
+    if(!descending){
+        mask = reverseBits(mask);
+        status = reverseBits(status);
+    }
+    status &= mask;
+
+    size_t granule = getGranule(alignedAddr);
+    // Resetting the status of a page which doesn't exist has no effect
+    uint8_t* granuleAddr = getGranuleAddr(granule, status != 0);
+    if(granuleAddr == NULL)
+        return;
+
+    *granuleAddr = (*granuleAddr & ~mask) | status;
+    if(status != 0)
+        markWritten(granule, granuleAddr);
+}
+
+// Returns the status of the 8 bytes starting at |addr|
+uint8_t ShadowBase::readStatus(ADDRINT addr){
+    unsigned offset = addr % 8;
+    ADDRINT alignedAddr = addr - offset;
+    uint8_t status = readGranule(alignedAddr);
+    if(offset == 0)
+        return status;
+
+    return (status >> offset) | (uint8_t) (readGranule(alignedAddr + 8) << (8 - offset));
+}
+
+// Sets the status of the first |count| (at most 8) bytes starting at |addr| according to |status|
+void ShadowBase::writeStatus(ADDRINT addr, uint8_t status, unsigned count){
+    unsigned offset = addr % 8;
+    ADDRINT alignedAddr = addr - offset;
+    unsigned mask = getStatusMask(count);
+    unsigned bits = status & mask;
+
+    writeGranule(alignedAddr, (uint8_t) (mask << offset), (uint8_t) (bits << offset));
+    if(offset != 0)
+        writeGranule(alignedAddr + 8, (uint8_t) (mask >> (8 - offset)), (uint8_t) (bits >> (8 - offset)));
+}
+
+// Sets every shadow byte mirroring the 8-bytes aligned range [from, to) to |value|
+void ShadowBase::fillGranules(ADDRINT from, ADDRINT to, uint8_t value){
+    size_t granule, last;
+    getGranules(from, to, granule, last);
+
+    while(granule < last){
+        size_t pageOffset = granule % SHADOW_ALLOCATION;
+        size_t count = min(SHADOW_ALLOCATION - pageOffset, last - granule);
+        uint8_t* page = getRangePage(granule / SHADOW_ALLOCATION, value != 0);
+
+        if(page != NULL){
+            memset(page + pageOffset, value, count);
+            if(value != 0)
+                markWritten(granule + count - 1, page + pageOffset + count - 1);
+        }
+
+        granule += count;
+    }
+}
+
+void ShadowBase::initializeRange(ADDRINT addr, size_t size){
+    if(!clipRange(addr, size))
+        return;
+
+    ADDRINT end = addr + size;
+    ADDRINT fullStart = (addr + 7) & ~((ADDRINT) 7);
+    ADDRINT fullEnd = end & ~((ADDRINT) 7);
+
+    if(fullStart >= fullEnd){
+        // No whole granule: the range spans at most 2 partial ones
+        while(addr < end){
+            unsigned count = min(8 - addr % 8, end - addr);
+            writeStatus(addr, 0xff, count);
+            addr += count;
+        }
+        return;
+    }
+
+    if(addr != fullStart)
+        writeStatus(addr, 0xff, fullStart - addr);
+    fillGranules(fullStart, fullEnd, 0xff);
+    if(end != fullEnd)
+        writeStatus(fullEnd, 0xff, end - fullEnd);
+}
+
+void ShadowBase::resetRange(ADDRINT addr, size_t size){
+    if(!clipRange(addr, size))
+        return;
+
+    ADDRINT end = addr + size;
+    ADDRINT fullStart = (addr + 7) & ~((ADDRINT) 7);
+    ADDRINT fullEnd = end & ~((ADDRINT) 7);
+
+    if(fullStart >= fullEnd){
+        while(addr < end){
+            unsigned count = min(8 - addr % 8, end - addr);
+            writeStatus(addr, 0, count);
+            addr += count;
+        }
+        return;
+    }
+
+    if(addr != fullStart)
+        writeStatus(addr, 0, fullStart - addr);
+    fillGranules(fullStart, fullEnd, 0);
+    if(end != fullEnd)
+        writeStatus(fullEnd, 0, end - fullEnd);
+}
+
+void ShadowBase::copyRange(ADDRINT dstAddr, ShadowBase& src, ADDRINT srcAddr, size_t size){
+    if(size == 0)
+        return;
+
+    ADDRINT clippedDst = dstAddr, clippedSrc = srcAddr;
+    size_t dstSize = size, srcSize = size;
+    bool isMirrored =   clipRange(clippedDst, dstSize) && clippedDst == dstAddr && dstSize == size &&
+                        src.clipRange(clippedSrc, srcSize) && clippedSrc == srcAddr && srcSize == size;
+    bool overlaps = &src == this && srcAddr < dstAddr + size && dstAddr < srcAddr + size;
+
+    // Whole granules can be copied as they are only if they mirror the same bytes, in the same layout
+    if(!isMirrored || overlaps || src.descending != descending || dstAddr % 8 != srcAddr % 8){
+        // The status is collected before being written, in case the ranges overlap
+        vector<uint8_t> status((size + 7) / 8);
+        for(size_t i = 0; i < status.size(); ++i){
+            status[i] = src.readStatus(srcAddr + i * 8);
+        }
+        for(size_t i = 0; i < status.size(); ++i){
+            writeStatus(dstAddr + i * 8, status[i], min(8, size - i * 8));
+        }
+        return;
+    }
+
+    size_t head = min((8 - dstAddr % 8) % 8, size);
+    if(head != 0){
+        writeStatus(dstAddr, src.readStatus(srcAddr), head);
+        dstAddr += head;
+        srcAddr += head;
+        size -= head;
+    }
+
+    size_t fullSize = size & ~((size_t) 7);
+    if(fullSize != 0){
+        size_t srcGranule, srcLast, dstGranule, dstLast;
+        src.getGranules(srcAddr, srcAddr + fullSize, srcGranule, srcLast);
+        getGranules(dstAddr, dstAddr + fullSize, dstGranule, dstLast);
+
+        while(srcGranule < srcLast){
+            size_t srcOffset = srcGranule % SHADOW_ALLOCATION;
+            size_t dstOffset = dstGranule % SHADOW_ALLOCATION;
+            size_t count = min(min(SHADOW_ALLOCATION - srcOffset, SHADOW_ALLOCATION - dstOffset), srcLast - srcGranule);
+            uint8_t* srcPage = src.getRangePage(srcGranule / SHADOW_ALLOCATION, false);
+            uint8_t* dstPage = getRangePage(dstGranule / SHADOW_ALLOCATION, srcPage != NULL);
+
+            if(srcPage != NULL){
+                memcpy(dstPage + dstOffset, srcPage + srcOffset, count);
+                markWritten(dstGranule + count - 1, dstPage + dstOffset + count - 1);
+            }
+            // Pages which don't exist have never been written
+            else if(dstPage != NULL){
+                memset(dstPage + dstOffset, 0, count);
+            }
+
+            srcGranule += count;
+            dstGranule += count;
+        }
+
+        dstAddr += fullSize;
+        srcAddr += fullSize;
+        size -= fullSize;
+    }
+
+    if(size != 0)
+        writeStatus(dstAddr, src.readStatus(srcAddr), size);
+}
+
+size_t ShadowBase::firstUninitialized(ADDRINT addr, size_t size){
+    ADDRINT start = addr;
+    size_t clippedSize = size;
+    if(!clipRange(start, clippedSize))
+        return size;
+
+    ADDRINT end = start + clippedSize;
+    ADDRINT fullStart = min((start + 7) & ~((ADDRINT) 7), end);
+    ADDRINT fullEnd = end & ~((ADDRINT) 7);
+    uint8_t status;
+
+    if(start != fullStart){
+        unsigned count = fullStart - start;
+        status = readStatus(start) | ~getStatusMask(count);
+        if(status != 0xff)
+            return start + getFirstUnset(status) - addr;
+        start = fullStart;
+    }
+
+    if(start < fullEnd){
+        size_t first, last;
+        getGranules(start, fullEnd, first, last);
+
+        // Granules are scanned in the order of the application addresses they mirror
+        while(first < last){
+            size_t granule = descending ? last - 1 : first;
+            size_t pageIdx = granule / SHADOW_ALLOCATION;
+            size_t chunkStart = descending ? std::max(first, pageIdx * SHADOW_ALLOCATION) : first;
+            size_t chunkEnd = descending ? last : min(last, (pageIdx + 1) * SHADOW_ALLOCATION);
+            uint8_t* page = getRangePage(pageIdx, false);
+
+            size_t found = (size_t) -1;
+            if(page == NULL){
+                found = granule;
+            }
+            else{
+                const uint8_t* chunk = page + chunkStart % SHADOW_ALLOCATION;
+                const uint8_t* ptr = descending ? findLastNotFull(chunk, chunkEnd - chunkStart) : findNotFull(chunk, chunkEnd - chunkStart);
+                if(ptr != NULL)
+                    found = chunkStart + (ptr - chunk);
+            }
+
+            if(found != (size_t) -1){
+                ADDRINT granuleAddr = descending ? baseAddr - found * 8 : baseAddr + found * 8;
+                return granuleAddr + getFirstUnset(readGranule(granuleAddr)) - addr;
+            }
+
+            if(descending)
+                last = chunkStart;
+            else
+                first = chunkEnd;
+        }
+        start = fullEnd;
+    }
+
+    if(start < end){
+        status = readStatus(start) | ~getStatusMask(end - start);
+        if(status != 0xff)
+            return start + getFirstUnset(status) - addr;
+    }
+
+    return size;
 }
 
 StackShadow::StackShadow(){
-    shadow.reserve(5);
+    descending = true;
     dirtyPages.reserve(5);
 
     for(int i = 0; i < 2; ++i){
-        uint8_t* newMap = (uint8_t*) mmap(NULL, SHADOW_ALLOCATION, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-        if(newMap == (void*) -1){
-            printf("mmap failed: %s\n", strerror(errno));
-            exit(1);
-        }
+        uint8_t* newMap = pagePool.getPage();
         shadow.push_back(newMap);
         dirtyPages.push_back(false);
     }
@@ -430,16 +872,11 @@ StackShadow::StackShadow(){
 }
 
 HeapShadow::HeapShadow(HeapEnum type) : heapType(type){
-    shadow.reserve(5);
     dirtyPages.reserve(5);
     isSingleChunk = false;
 
     for(int i = 0; i < 2; ++i){
-        uint8_t* newMap = (uint8_t*) mmap(NULL, SHADOW_ALLOCATION, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-        if(newMap == (void*) -1){
-            printf("mmap failed: %s\n", strerror(errno));
-            exit(1);
-        }
+        uint8_t* newMap = pagePool.getPage();
         shadow.push_back(newMap);
         dirtyPages.push_back(false);
     }
@@ -457,22 +894,29 @@ std::pair<unsigned, unsigned> HeapShadow::getShadowAddrIdxOffset(ADDRINT addr){
     return std::pair<unsigned, unsigned>(shadowIdx, retOffset);
 }
 
+uint8_t* HeapShadow::allocatePage(unsigned shadowIdx){
+    uint8_t* page = shadow[shadowIdx];
+    if(page == NULL){
+        page = pagePool.getPage();
+        shadow.set(shadowIdx, page);
+        if(dirtyPages.size() < shadow.size())
+            dirtyPages.resize(shadow.size(), false);
+    }
+
+    return page;
+}
+
+uint8_t* HeapShadow::getRangePage(size_t pageIdx, bool allocate){
+    return allocate ? allocatePage(pageIdx) : shadow[pageIdx];
+}
+
 uint8_t* HeapShadow::getShadowAddrFromIdx(unsigned* shadowIdxPtr, unsigned offset){    
     unsigned shadowIdx = *shadowIdxPtr;
     
     offset >>=3;
-    // If the requested address does not have a shadow location yet, allocate it
-    while(shadowIdx >= shadow.size()){
-        uint8_t* newMap = (uint8_t*) mmap(NULL, SHADOW_ALLOCATION, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-        if(newMap == (void*) - 1){
-            printf("mmap failed: %s\n", strerror(errno));
-            exit(1);
-        }
-        shadow.push_back(newMap);
-        dirtyPages.push_back(false);
-    }
-    
-    uint8_t* ret = shadow[shadowIdx] + (offset % SHADOW_ALLOCATION);
+    // If the requested address does not have a shadow location yet, allocate it.
+    // Pages between the last allocated one and the requested one are not allocated until they are accessed.
+    uint8_t* ret = allocatePage(shadowIdx) + (offset % SHADOW_ALLOCATION);
     return ret;
 }
 
@@ -510,24 +954,11 @@ void HeapShadow::set_as_initialized(ADDRINT addr, UINT32 size, uint8_t* data){
         } 
         else{
             ++shadowIdx;
-            if(shadowIdx < shadow.size()){
-                shadowAddr = shadow[shadowIdx];
-            }
-            else{
-                // This should happen in some rare cases, and in most of these cases just 1 time for a single access.
-                // This manages the case where the access is performed between 2 memory pages, and the last shadow memory has not been allocated yet
-                // Note that this can't happen in a StackShadow object, as when the shadowMemory address is computed, every required memory page
-                // is eventually allocated, because the stack grows towards low addresses, so every byte at an address higher than the start address of the 
-                // access will already have an allocated shadow memory page.
-                uint8_t* newMap = (uint8_t*) mmap(NULL, SHADOW_ALLOCATION, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-                if(newMap == (void*) - 1){
-                    printf("mmap failed: %s\n", strerror(errno));
-                    exit(1);
-                }
-                shadow.push_back(newMap);
-                dirtyPages.push_back(false);
-                shadowAddr = newMap;
-            }
+            // This manages the case where the access is performed between 2 memory pages, and the next shadow memory page
+            // has not been allocated yet. Note that this can't happen in a StackShadow object, as when the shadowMemory address
+            // is computed, every required memory page is eventually allocated, because the stack grows towards low addresses,
+            // so every byte at an address higher than the start address of the access will already have an allocated shadow memory page.
+            shadowAddr = allocatePage(shadowIdx);
             dirtyPages[shadowIdx] = true;
         }
 
@@ -561,24 +992,11 @@ void HeapShadow::set_as_initialized(ADDRINT addr, UINT32 size){
         } 
         else{
             ++shadowIdx;
-            if(shadowIdx < shadow.size()){
-                shadowAddr = shadow[shadowIdx];
-            }
-            else{
-                // This should happen in some rare cases, and in most of these cases just 1 time for a single access.
-                // This manages the case where the access is performed between 2 memory pages, and the last shadow memory has not been allocated yet
-                // Note that this can't happen in a StackShadow object, as when the shadowMemory address is computed, every required memory page
-                // is eventually allocated, because the stack grows towards low addresses, so every byte at an address higher than the start address of the 
-                // access will already have an allocated shadow memory page.
-                uint8_t* newMap = (uint8_t*) mmap(NULL, SHADOW_ALLOCATION, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-                if(newMap == (void*) - 1){
-                    printf("mmap failed: %s\n", strerror(errno));
-                    exit(1);
-                }
-                shadow.push_back(newMap);
-                dirtyPages.push_back(false);
-                shadowAddr = newMap;
-            }
+            // This manages the case where the access is performed between 2 memory pages, and the next shadow memory page
+            // has not been allocated yet. Note that this can't happen in a StackShadow object, as when the shadowMemory address
+            // is computed, every required memory page is eventually allocated, because the stack grows towards low addresses,
+            // so every byte at an address higher than the start address of the access will already have an allocated shadow memory page.
+            shadowAddr = allocatePage(shadowIdx);
             dirtyPages[shadowIdx] = true;
         }
 
@@ -623,12 +1041,15 @@ uint8_t* HeapShadow::invertBitOrder(uint8_t* data, unsigned offset, UINT32 byteS
 }
 
 uint8_t* HeapShadow::getUninitializedInterval(ADDRINT addr, UINT32 size){
+    // Large accesses (e.g. buffers read by system calls) are first checked a whole shadow word at a time
+    if(size >= SHADOW_BULK_MIN_SIZE && firstUninitialized(addr, size) == size)
+        return NULL;
+
     std::pair<unsigned, unsigned> idxOffset = this->getShadowAddrIdxOffset(addr);
     unsigned shadowIdx = idxOffset.first;
     uint8_t* shadowAddr = this->getShadowAddrFromIdx(&shadowIdx, idxOffset.second);
 
     bool isUninitialized = false;
-    bool requiresNewPages = false;
     unsigned offset = addr % 8;
     UINT32 leftSize = size + offset;
     uint8_t val;
@@ -645,32 +1066,17 @@ uint8_t* HeapShadow::getUninitializedInterval(ADDRINT addr, UINT32 size){
             ++shadowAddr;
         }
         else{
+            // Pages which have not been allocated have never been written, so if the access goes on in one of them,
+            // it is uninitialized
             shadowAddr = shadow[++shadowIdx];
-            if(shadowIdx >= shadow.size()){
+            if(shadowAddr == NULL && leftSize > 8){
                 isUninitialized = true;
-                requiresNewPages = true;
             }
         }
 
         leftSize -= 8;
     }
 
-    // This may happen if the chunk size is very big and it has no corresponding mmapped page
-    // considered as a single chunk (which is unlikely, on Ubuntu at least).
-    // This should not happen frequently.
-    if(requiresNewPages){
-        while(leftSize > 0){
-            uint8_t* newMap = (uint8_t*) mmap(NULL, SHADOW_ALLOCATION, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-            if(newMap == (void*) - 1){
-                printf("mmap failed: %s\n", strerror(errno));
-                exit(1);
-            }
-            shadow.push_back(newMap);
-            dirtyPages.push_back(false);
-            leftSize -= (PAGE_SIZE * 8);
-        }
-    }
-
     if(!isUninitialized && leftSize > 0){
         val = *shadowAddr;
         // Change val to put 1 to every bit not considered by this access
@@ -701,10 +1107,6 @@ uint8_t* HeapShadow::getUninitializedInterval(ADDRINT addr, UINT32 size){
 }
 
 void HeapShadow::reset(ADDRINT addr, size_t size){
-    std::pair<unsigned, unsigned> idxOffset = this->getShadowAddrIdxOffset(addr);
-    unsigned shadowIdx = idxOffset.first;
-    uint8_t* shadowAddr = this->getShadowAddrFromIdx(&shadowIdx, idxOffset.second);
-
     if(heapType == HeapEnum::MMAP && isSingleChunk){
         // If it is a heap allocated through mmap, it is due to a big allocation request.
         // These kind of requests are very rare, and when they happen it is likely to have a long life.
@@ -713,47 +1115,8 @@ void HeapShadow::reset(ADDRINT addr, size_t size){
         return;
     }
 
-    unsigned offset = addr % 8;
-    // Remember the ShadowMemory model keeps 1 byte for each 8 bytes of application memory
-    size_t freed_size = size / 8;
-    size_t reset_size = 0;
-
-    while(reset_size < freed_size){
-        // If there's no shadow page corresponding to the memory location being freed, it has never been written.
-        // So, there's nothing else to do
-        if(shadowIdx >= shadow.size())
-            return;
-        unsigned long long shadowPageLimit = (unsigned long long) shadow[shadowIdx] + SHADOW_ALLOCATION - 1;
-        unsigned long long bottom = min((unsigned long long) shadowAddr + freed_size - reset_size - 1, shadowPageLimit);
-        unsigned long long freedBytes = bottom - (unsigned long long) shadowAddr + 1;
-
-        if(offset > 0){
-            *shadowAddr &= ~((uint8_t) 0xff >> offset);
-            ++shadowAddr;
-            // Required to reduce freedBytes (and therefore increase reset_size) to avoid writing too many bytes
-            // with the subsequent call to memset
-            --freedBytes;
-            ++reset_size;
-        }
-
-        memset(shadowAddr, 0, freedBytes);
-        reset_size += freedBytes;
-        if(bottom == shadowPageLimit){
-            shadowAddr = shadow[++shadowIdx];
-        }
-        else{
-            shadowAddr = (uint8_t*) ++bottom;
-        }
-
-        offset = 0;
-    }
-
-    // If the size of the block is not a multiple of 8, we need to reset |blockSize % 8| bits of the shadow memory
-    // If the initial offset is not 0, we need to reset also the bytes not yet reset due to the offset
-    freed_size = size % 8 + addr % 8;
-    uint8_t mask = ~((uint8_t) 0xff >> offset);
-    mask |= (uint8_t) 0xff >> freed_size;
-    *shadowAddr &= mask;
+    // Pages which have not been allocated have never been written, so they are left as they are
+    resetRange(addr, size);
 }
 
 
@@ -11,9 +11,10 @@
 #include <unordered_map>
 #include <set>
 
-#include "pin.H"
+#include "PinTypes.h"
 #include "HeapEnum.h"
 #include "Platform.h"
+#include "ShadowPageTable.h"
 
 using std::map;
 using std::vector;
@@ -35,8 +36,14 @@ class ShadowBase{
         vector<bool> dirtyPages;
 
         // This shadow memory keeps 1 bit for each byte of application memory,
-        // telling if that byte has been initialized by a write access
-        vector<uint8_t*> shadow;
+        // telling if that byte has been initialized by a write access.
+        // StackShadow allocates its pages contiguously, while HeapShadow only allocates the accessed ones.
+        ShadowPageTable shadow;
+
+        // Status of the shadow memory saved by |checkpoint|. Clean pages are not copied, and their entry is NULL
+        vector<uint8_t*> checkpointPages;
+        vector<bool> checkpointDirtyPages;
+        uint8_t* checkpointHighestShadowAddr = NULL;
 
         // Returns a pair containing the index to be used to retrieve the correct shadow page
         // and an offset required to get the correct address inside that page
@@ -49,6 +56,29 @@ class ShadowBase{
         uint8_t* shadow_memory_copy(ADDRINT addr, UINT32 size);
         unsigned long long min(unsigned long long x, unsigned long long y);
 
+        // True if higher application addresses are mirrored by lower shadow addresses (as in StackShadow).
+        // In that case, the status of the byte at offset i of an 8-bytes aligned address is bit i of its shadow byte,
+        // otherwise it is bit 7 - i.
+        bool descending = false;
+
+        // Returns the shadow page with index |pageIdx|. If it doesn't exist, it is allocated if |allocate| is true,
+        // otherwise NULL is returned.
+        virtual uint8_t* getRangePage(size_t pageIdx, bool allocate) = 0;
+
+        // Helpers of the range operations below. A granule is the group of 8 bytes, starting at an 8-bytes aligned address,
+        // whose status is kept by a single shadow byte. Status bytes returned and accepted by |readStatus| and |writeStatus|
+        // have bit i set if the byte at |addr| + i is initialized, independently of the layout of the shadow memory.
+        bool clipRange(ADDRINT& addr, size_t& size) const;
+        size_t getGranule(ADDRINT alignedAddr) const;
+        void getGranules(ADDRINT from, ADDRINT to, size_t& first, size_t& last) const;
+        uint8_t* getGranuleAddr(size_t granule, bool allocate);
+        void markWritten(size_t granule, uint8_t* granuleAddr);
+        uint8_t readGranule(ADDRINT alignedAddr);
+        void writeGranule(ADDRINT alignedAddr, uint8_t mask, uint8_t status);
+        uint8_t readStatus(ADDRINT addr);
+        void writeStatus(ADDRINT addr, uint8_t status, unsigned count);
+        void fillGranules(ADDRINT from, ADDRINT to, uint8_t value);
+
     public:
         uint8_t* getShadowAddr(ADDRINT addr);
         
@@ -69,13 +99,46 @@ class ShadowBase{
 
         void setBaseAddr(ADDRINT baseAddr);
         ShadowBase* getPtr();
+        // Gives the shadow pages back to ShadowPagePool
         void freeMemory();
+        // Number of pages of shadow memory currently mapped
+        size_t getAllocatedPages() const;
+
+        // Bulk operations on the application memory range [addr, addr + size), meant for large ranges (e.g. buffers
+        // written by system calls or released by free). Whole groups of 8 bytes are updated with memset/memcpy on the
+        // shadow pages, and scanned a word at a time. Only the partial groups at the ends of a range are handled bit by bit.
+        void initializeRange(ADDRINT addr, size_t size);
+        void resetRange(ADDRINT addr, size_t size);
+        // Copies the status of [srcAddr, srcAddr + size) of |src| (which may be this shadow memory) to [dstAddr, dstAddr + size).
+        // Overlapping ranges are handled as memmove does.
+        void copyRange(ADDRINT dstAddr, ShadowBase& src, ADDRINT srcAddr, size_t size);
+        // Returns the offset from |addr| of the first uninitialized byte of the range, or |size| if it is fully initialized
+        size_t firstUninitialized(ADDRINT addr, size_t size);
+
+        // Saves a copy of the current status of the shadow memory, replacing any previous checkpoint.
+        // Used by persistent mode to bring the shadow memory back to the status it had when the persistent routine
+        // has been entered, every time a new iteration begins
+        void checkpoint();
+
+        // Brings the shadow memory back to the status saved by the last call to |checkpoint|.
+        // Pages allocated after the checkpoint (or every page, if no checkpoint has been taken) are zeroed.
+        void restoreCheckpoint();
 };
 
+// Number of shadow pages below the current stack frame which are zeroed rather than trimmed (see StackShadow::reset)
+#define STACK_SHADOW_RETAINED_PAGES 16
+// Minimum size of an access whose status is checked through ShadowBase::firstUninitialized before being
+// scanned byte by byte
+#define SHADOW_BULK_MIN_SIZE 64
+
 class StackShadow : public ShadowBase{
     protected:
+        // Pages released by |reset| through ShadowPagePool::trimPage. A trimmed page is resident again once it is dirty.
+        vector<bool> trimmedPages;
+
         std::pair<unsigned, unsigned> getShadowAddrIdxOffset(ADDRINT addr) override;
         uint8_t* getShadowAddrFromIdx(unsigned* shadowIdxPtr, unsigned offset) override;
+        uint8_t* getRangePage(size_t pageIdx, bool allocate) override;
 
     public:
         StackShadow();
@@ -85,6 +148,9 @@ class StackShadow : public ShadowBase{
         // or on free invocations.
         void reset(ADDRINT addr);
 
+        // Number of allocated pages which are not resident, as they have been trimmed and never written since then
+        size_t getTrimmedPages() const;
+
         // This function expects as a parameter a buffer of bytes that already includes both the offset and
         // the possible additional bits on the left due to the remainder of 8 of (size + offset). 
         // Of course, to avoid modifying other memory portions than the one we are supposed to update, both the offset 
@@ -105,6 +171,9 @@ class HeapShadow : public ShadowBase{
         std::pair<unsigned, unsigned> getShadowAddrIdxOffset(ADDRINT addr) override;
         uint8_t* getShadowAddrFromIdx(unsigned* shadowIdxPtr, unsigned offset) override;
         uint8_t* invertBitOrder(uint8_t* data, unsigned offset, UINT32 byteSize);
+        // Returns the page with index |shadowIdx|, allocating it (but none of the previous ones) if it doesn't exist yet
+        uint8_t* allocatePage(unsigned shadowIdx);
+        uint8_t* getRangePage(size_t pageIdx, bool allocate) override;
 
     public:
         HeapShadow(HeapEnum type);
@@ -0,0 +1,126 @@
+#include "ShadowPagePool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+ShadowPagePool::ShadowPagePool() : pageSize(sysconf(_SC_PAGESIZE)), mappedPages(0), hugePages(OFF), regionNext(NULL), regionEnd(NULL){}
+
+ShadowPagePool& ShadowPagePool::getInstance(){
+    static ShadowPagePool instance;
+
+    return instance;
+}
+
+size_t ShadowPagePool::getPageSize() const{
+    return pageSize;
+}
+
+void ShadowPagePool::enableHugePages(HugePages mode){
+    hugePages = mode;
+}
+
+ShadowPagePool::HugePages ShadowPagePool::getHugePages() const{
+    return hugePages;
+}
+
+bool ShadowPagePool::mapRegion(){
+    // The rest of the current region (if any) is left unused
+    if(hugePages == HUGETLB){
+        // Huge pages are reserved at once (rather than when first written) so that running out of them makes the mapping
+        // fail, instead of raising SIGBUS later
+        void* region = mmap(NULL, SHADOW_REGION_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if(region != MAP_FAILED){
+            regionNext = (uint8_t*) region;
+            regionEnd = regionNext + SHADOW_REGION_SIZE;
+            return true;
+        }
+
+        // No huge pages reserved by the system (or not enough of them): from now on, fall back to transparent huge pages
+        hugePages = THP;
+    }
+
+    // Transparent huge pages are only used for the parts of the mapping aligned to their size, so the region is
+    // reserved with an additional huge page and trimmed to an aligned address
+    size_t reservedSize = SHADOW_REGION_SIZE + SHADOW_HUGE_PAGE_SIZE;
+    void* region = mmap(NULL, reservedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(region == MAP_FAILED)
+        return false;
+
+    uintptr_t start = (uintptr_t) region;
+    uintptr_t alignedStart = (start + SHADOW_HUGE_PAGE_SIZE - 1) & ~(SHADOW_HUGE_PAGE_SIZE - 1);
+    uintptr_t alignedEnd = alignedStart + SHADOW_REGION_SIZE;
+    if(alignedStart != start)
+        munmap(region, alignedStart - start);
+    if(alignedEnd != start + reservedSize)
+        munmap((void*) alignedEnd, start + reservedSize - alignedEnd);
+
+    // If transparent huge pages are disabled, the region is still used: it saves a mmap for each page anyway
+    madvise((void*) alignedStart, SHADOW_REGION_SIZE, MADV_HUGEPAGE);
+
+    regionNext = (uint8_t*) alignedStart;
+    regionEnd = (uint8_t*) alignedEnd;
+    return true;
+}
+
+uint8_t* ShadowPagePool::getPage(){
+    if(!freePages.empty()){
+        uint8_t* ret = freePages.back();
+        freePages.pop_back();
+        return ret;
+    }
+
+    if(hugePages != OFF && (regionNext != regionEnd || mapRegion())){
+        uint8_t* ret = regionNext;
+        regionNext += pageSize;
+        ++mappedPages;
+        return ret;
+    }
+
+    uint8_t* newMap = (uint8_t*) mmap(NULL, pageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(newMap == (void*) -1){
+        printf("mmap failed: %s\n", strerror(errno));
+        exit(1);
+    }
+    ++mappedPages;
+
+    return newMap;
+}
+
+void ShadowPagePool::releasePage(uint8_t* page){
+    // Unmapping a single page would split a region, so with huge pages every released page is kept
+    if(hugePages == OFF && freePages.size() >= SHADOW_POOL_MAX_PAGES){
+        munmap(page, pageSize);
+        --mappedPages;
+        return;
+    }
+
+    trimPage(page);
+    freePages.push_back(page);
+}
+
+bool ShadowPagePool::trimPage(uint8_t* page){
+    // Dropping part of a huge page would split it (or fail, for MAP_HUGETLB mappings)
+    if(hugePages != OFF){
+        memset(page, 0, pageSize);
+        return false;
+    }
+
+    // Private anonymous pages read as zeroes after being dropped
+    if(madvise(page, pageSize, MADV_DONTNEED) != 0){
+        memset(page, 0, pageSize);
+        return false;
+    }
+    return true;
+}
+
+size_t ShadowPagePool::getMappedPages() const{
+    return mappedPages;
+}
+
+size_t ShadowPagePool::getPooledPages() const{
+    return freePages.size();
+}
@@ -0,0 +1,79 @@
+#ifndef SHADOWPAGEPOOL
+#define SHADOWPAGEPOOL
+
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+using std::vector;
+
+// Maximum number of released pages kept by the pool. Further released pages are unmapped.
+#define SHADOW_POOL_MAX_PAGES 4096
+// Size of the regions pages are carved from when huge pages are enabled (see |enableHugePages|)
+#define SHADOW_REGION_SIZE (64UL << 20)
+// Size of a transparent huge page: regions are aligned to it
+#define SHADOW_HUGE_PAGE_SIZE (2UL << 20)
+
+/*
+    Allocator of the pages of shadow memory (see ShadowMemory.h).
+    Pages released by a shadow memory (e.g. when a chunk allocated through mmap is freed) are given back to the
+    kernel through madvise(MADV_DONTNEED), so that they don't count towards the resident memory anymore, but they
+    are kept mapped and handed out again by the next request for a page, saving the cost of a mmap system call.
+    Pages returned by |getPage| are always zeroed.
+
+    By default every page is a separate mapping. With huge pages enabled, pages are instead carved from large regions
+    backed by huge pages, reducing both the number of mmap system calls and the TLB misses of the shadow memory.
+    Pages of a region are never unmapped, and they are zeroed rather than dropped, as dropping part of a huge page
+    would split it.
+*/
+class ShadowPagePool{ // Singleton
+    public:
+        enum HugePages{
+            OFF,
+            // Transparent huge pages, requested through madvise(MADV_HUGEPAGE)
+            THP,
+            // Huge pages reserved by the system (see /proc/sys/vm/nr_hugepages), mapped with MAP_HUGETLB.
+            // If they are not available, transparent huge pages are used.
+            HUGETLB
+        };
+
+    private:
+        size_t pageSize;
+        vector<uint8_t*> freePages;
+        // Number of pages currently mapped, including the ones held by the pool
+        size_t mappedPages;
+
+        HugePages hugePages;
+        // Unused part of the current region
+        uint8_t* regionNext;
+        uint8_t* regionEnd;
+
+        ShadowPagePool();
+
+        bool mapRegion();
+
+    public:
+        ShadowPagePool(ShadowPagePool const& other) = delete;
+        void operator=(ShadowPagePool const& other) = delete;
+
+        static ShadowPagePool& getInstance();
+
+        size_t getPageSize() const;
+
+        // Pages requested from now on are carved from regions backed by huge pages. Pages already handed out are not moved.
+        void enableHugePages(HugePages mode);
+        HugePages getHugePages() const;
+
+        uint8_t* getPage();
+        void releasePage(uint8_t* page);
+
+        // Zeroes a page still in use, releasing its physical memory until it is written again (unless huge pages are enabled).
+        // Cheaper than a memset for pages which are unlikely to be written again soon.
+        // Returns whether the physical memory has been released.
+        bool trimPage(uint8_t* page);
+
+        size_t getMappedPages() const;
+        size_t getPooledPages() const;
+};
+
+#endif // SHADOWPAGEPOOL
@@ -0,0 +1,38 @@
+#include "ShadowPageTable.h"
+
+ShadowPageTable::ShadowPageTable() : span(0), allocatedPages(0), lastIndex((size_t) -1), lastPage(NULL){}
+
+void ShadowPageTable::set(size_t index, uint8_t* page){
+    size_t leafIndex = index >> SHADOW_TABLE_LEAF_BITS;
+    if(leafIndex >= leaves.size())
+        leaves.resize(leafIndex + 1, NULL);
+    if(leaves[leafIndex] == NULL)
+        leaves[leafIndex] = new uint8_t*[SHADOW_TABLE_LEAF_PAGES]();
+
+    uint8_t*& entry = leaves[leafIndex][index & (SHADOW_TABLE_LEAF_PAGES - 1)];
+    if(entry == NULL && page != NULL)
+        ++allocatedPages;
+    else if(entry != NULL && page == NULL)
+        --allocatedPages;
+    entry = page;
+
+    if(index >= span)
+        span = index + 1;
+    if(index == lastIndex)
+        lastPage = page;
+}
+
+size_t ShadowPageTable::getAllocatedPages() const{
+    return allocatedPages;
+}
+
+void ShadowPageTable::clear(){
+    for(uint8_t** leaf : leaves){
+        delete[] leaf;
+    }
+    leaves.clear();
+    span = 0;
+    allocatedPages = 0;
+    lastIndex = (size_t) -1;
+    lastPage = NULL;
+}
@@ -0,0 +1,70 @@
+#ifndef SHADOWPAGETABLE
+#define SHADOWPAGETABLE
+
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+using std::vector;
+
+// Each leaf of the table holds the pointers to 2^SHADOW_TABLE_LEAF_BITS consecutive pages
+#define SHADOW_TABLE_LEAF_BITS 9
+#define SHADOW_TABLE_LEAF_PAGES (1UL << SHADOW_TABLE_LEAF_BITS)
+
+/*
+    Sparse table of the pages of a shadow memory, indexed as a vector of pages (see ShadowBase).
+    It is a two-level radix tree: the first level is a vector of leaves, each one holding the pointers to
+    SHADOW_TABLE_LEAF_PAGES consecutive pages, and a leaf is only allocated once one of its pages is set.
+    Pages which have never been set are NULL, so that a shadow memory whose application memory has large
+    gaps (e.g. a heap extended far from its beginning) only allocates the pages which are actually accessed.
+    The last looked up page is cached, as consecutive lookups usually refer to the same page.
+
+    As for the pages themselves, leaves are only freed by |clear|: copies of a table share them.
+*/
+class ShadowPageTable{
+    private:
+        vector<uint8_t**> leaves;
+        // Index following the highest index set
+        size_t span;
+        size_t allocatedPages;
+
+        mutable size_t lastIndex;
+        mutable uint8_t* lastPage;
+
+    public:
+        ShadowPageTable();
+
+        // Returns the page with index |index|, or NULL if it has never been set
+        inline uint8_t* operator[](size_t index) const{
+            if(index == lastIndex)
+                return lastPage;
+
+            uint8_t* ret = NULL;
+            if(index < span){
+                uint8_t** leaf = leaves[index >> SHADOW_TABLE_LEAF_BITS];
+                if(leaf != NULL)
+                    ret = leaf[index & (SHADOW_TABLE_LEAF_PAGES - 1)];
+            }
+
+            lastIndex = index;
+            lastPage = ret;
+            return ret;
+        }
+
+        void set(size_t index, uint8_t* page);
+        inline void push_back(uint8_t* page){
+            set(span, page);
+        }
+
+        // Index following the highest index set, as the size of a vector of pages
+        inline size_t size() const{
+            return span;
+        }
+
+        size_t getAllocatedPages() const;
+
+        // Removes every page, without releasing them
+        void clear();
+};
+
+#endif // SHADOWPAGETABLE
@@ -22,6 +22,7 @@ ShadowRegisterFile::ShadowRegisterFile(){
 ShadowRegisterFile::~ShadowRegisterFile(){
     // De-allocate memory page reserved for shadow register file
     free(shadowRegistersPtr);
+    free(checkpointPtr);
 
     // De-allocate all shadow registers dynamically allocated during initialization
     for(unsigned i = 0; i < numRegisters; ++i){
@@ -109,6 +110,7 @@ void ShadowRegisterFile::initShadowRegistersPtr(unsigned* sizes, SHDW_REG* super
             allocationSize += (curr_size / 8);
         }
     }
+    shadowRegistersSize = allocationSize;
     shadowRegistersPtr = malloc(sizeof(uint8_t) * allocationSize);
     memset(shadowRegistersPtr, 0xff, allocationSize);
 }
@@ -619,6 +621,22 @@ void ShadowRegisterFile::incrementFpuStackIndex(){
     }
 }
 
+void ShadowRegisterFile::checkpoint(){
+    if(checkpointPtr == NULL)
+        checkpointPtr = malloc(sizeof(uint8_t) * shadowRegistersSize);
+
+    memcpy(checkpointPtr, shadowRegistersPtr, shadowRegistersSize);
+    checkpointFpuStackIndex = fpuStackIndex;
+}
+
+void ShadowRegisterFile::restoreCheckpoint(){
+    if(checkpointPtr == NULL)
+        return;
+
+    memcpy(shadowRegistersPtr, checkpointPtr, shadowRegistersSize);
+    fpuStackIndex = checkpointFpuStackIndex;
+}
+
 
 SHDW_REG& operator+=(SHDW_REG& x, const SHDW_REG& y){
     unsigned intX = (unsigned) x;
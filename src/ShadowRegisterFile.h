@@ -6,7 +6,7 @@
 #include "Platform.h"
 #include "ShadowRegister.h"
 #include "misc/CeilToMultipleOf8.h"
-#include "pin.H"
+#include "PinTypes.h"
 
 using std::map;
 using std::set;
@@ -237,6 +237,10 @@ class ShadowRegisterFile{ // Singleton
         int fpuStackIndex = 0;
         unsigned numRegisters;
         void* shadowRegistersPtr;
+        size_t shadowRegistersSize;
+        // Copy of the shadow registers' content (and of the FPU stack index) saved by |checkpoint|
+        void* checkpointPtr = NULL;
+        int checkpointFpuStackIndex = 0;
         ShadowRegister** shadowRegisters;
         map<SHDW_REG, set<unsigned>> aliasingRegisters;
         set<unsigned> emptySet;
@@ -362,6 +366,13 @@ class ShadowRegisterFile{ // Singleton
         void decrementFpuStackIndex();
         void incrementFpuStackIndex();
 
+        /*
+            Saves the current status of every shadow register, so that it can be brought back by |restoreCheckpoint|.
+            This is used by persistent mode, where the same routine is executed once for each input.
+        */
+        void checkpoint();
+        void restoreCheckpoint();
+
 
         class DecresingSizeRegisterSorter{
             public: 
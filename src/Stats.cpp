@@ -0,0 +1,144 @@
+#include "Stats.h"
+
+#include <fstream>
+#include <time.h>
+
+static const char* counterNames[Stats::COUNTERS_NUM] = {
+    "instrumented_instructions",
+    "memory_reads",
+    "memory_writes",
+    "uninitialized_reads",
+    "heuristic_drops",
+    "duplicated_reads",
+    "pending_read_propagations",
+    "excluded_writes",
+    "spilled_groups",
+    "context_limit_drops",
+    "saturated_instructions",
+    "summarized_calls",
+    "string_overread_drops"
+};
+
+static const char* sizeNames[Stats::SIZES_NUM] = {
+    "mem_accesses",
+    "last_writes",
+    "pending_reads",
+    "used_tags",
+    "free_tags",
+    "shadow_pages",
+    "access_store_bytes",
+    "shadow_pooled_pages",
+    "shadow_resident_bytes",
+    "context_filters"
+};
+
+static uint64_t monotonicNanoseconds(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+Stats::Stats(){
+    reset();
+}
+
+Stats& Stats::getInstance(){
+    static Stats instance;
+
+    return instance;
+}
+
+void Stats::reset(){
+    for(unsigned i = 0; i < COUNTERS_NUM; ++i){
+        counters[i] = 0;
+    }
+    for(unsigned i = 0; i < SIZES_NUM; ++i){
+        sizes[i] = 0;
+        peakSizes[i] = 0;
+    }
+    for(unsigned i = 0; i < PHASES_NUM; ++i){
+        phaseCycles[i] = 0;
+    }
+
+    startCycles = readTsc();
+    startNanoseconds = monotonicNanoseconds();
+    endCycles = 0;
+    endNanoseconds = 0;
+}
+
+void Stats::enable(const std::string& path){
+    outputPath = path;
+    reset();
+}
+
+bool Stats::isEnabled() const{
+    return !outputPath.empty();
+}
+
+void Stats::sample(Size size, size_t value){
+    sizes[size] = value;
+    if(value > peakSizes[size])
+        peakSizes[size] = value;
+}
+
+void Stats::addCycles(Phase phase, uint64_t cycles){
+    phaseCycles[phase] += cycles;
+}
+
+void Stats::restart(int pid){
+    if(!isEnabled())
+        return;
+
+    outputPath += "." + std::to_string(pid);
+    reset();
+}
+
+void Stats::endExecution(){
+    if(endCycles != 0)
+        return;
+
+    endCycles = readTsc();
+    endNanoseconds = monotonicNanoseconds();
+}
+
+bool Stats::write() const{
+    std::ofstream out(outputPath);
+    if(!out)
+        return false;
+
+    // If the execution has not ended yet (i.e. statistics are written while the application is still running), report its partial duration
+    uint64_t executionEndCycles = endCycles != 0 ? endCycles : readTsc();
+    uint64_t executionEndNanoseconds = endNanoseconds != 0 ? endNanoseconds : monotonicNanoseconds();
+    uint64_t executionCycles = executionEndCycles - startCycles;
+    // Instrumentation happens during the execution, but it is reported separately
+    executionCycles = executionCycles > phaseCycles[INSTRUMENTATION] ? executionCycles - phaseCycles[INSTRUMENTATION] : 0;
+
+    out << "{" << std::endl;
+    out << "    \"counters\": {" << std::endl;
+    for(unsigned i = 0; i < COUNTERS_NUM; ++i){
+        out << "        \"" << counterNames[i] << "\": " << counters[i] << (i + 1 < COUNTERS_NUM ? "," : "") << std::endl;
+    }
+    out << "    }," << std::endl;
+
+    out << "    \"sizes\": {" << std::endl;
+    for(unsigned i = 0; i < SIZES_NUM; ++i){
+        out << "        \"" << sizeNames[i] << "\": {\"current\": " << sizes[i] << ", \"peak\": " << peakSizes[i] << "}" << (i + 1 < SIZES_NUM ? "," : "") << std::endl;
+    }
+    out << "    }," << std::endl;
+
+    out << "    \"cycles\": {" << std::endl;
+    out << "        \"instrumentation\": " << phaseCycles[INSTRUMENTATION] << "," << std::endl;
+    out << "        \"execution\": " << executionCycles << "," << std::endl;
+    out << "        \"fini\": " << phaseCycles[FINI] << std::endl;
+    out << "    }," << std::endl;
+    out << "    \"execution_wall_time_ms\": " << (executionEndNanoseconds - startNanoseconds) / 1000000 << std::endl;
+    out << "}" << std::endl;
+
+    return out.good();
+}
+
+StatsTimer::StatsTimer(Stats::Phase phase) : phase(phase), start(readTsc()){}
+
+StatsTimer::~StatsTimer(){
+    Stats::getInstance().addCycles(phase, readTsc() - start);
+}
@@ -0,0 +1,119 @@
+#ifndef STATS
+#define STATS
+
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+
+// Number of traced memory accesses between two consecutive samplings of the sizes of the data structures
+#define STATS_SAMPLE_INTERVAL (1ULL << 12)
+
+// Reads the time stamp counter of the processor
+inline uint64_t readTsc(){
+    uint32_t low, high;
+    __asm__ __volatile__("rdtsc" : "=a"(low), "=d"(high));
+    return ((uint64_t) high << 32) | low;
+}
+
+/*
+    Statistics about the analysis, written as a JSON file at the end of the execution if knob --stats is specified.
+    Counters are always updated (a single increment is cheaper than checking whether statistics are enabled),
+    while the sizes of the data structures are only sampled when statistics are enabled.
+*/
+class Stats{ // Singleton
+    public:
+        enum Counter{
+            INSTRUMENTED_INSTRUCTIONS,
+            MEMORY_READS,
+            MEMORY_WRITES,
+            UNINITIALIZED_READS,
+            HEURISTIC_DROPS,
+            DUPLICATED_READS,
+            PENDING_READ_PROPAGATIONS,
+            EXCLUDED_WRITES,
+            SPILLED_GROUPS,
+            CONTEXT_LIMIT_DROPS,
+            SATURATED_INSTRUCTIONS,
+            SUMMARIZED_CALLS,
+            STRING_OVERREAD_DROPS,
+            COUNTERS_NUM
+        };
+
+        enum Size{
+            MEM_ACCESSES,
+            LAST_WRITES,
+            PENDING_READS,
+            USED_TAGS,
+            FREE_TAGS,
+            SHADOW_PAGES,
+            ACCESS_STORE_BYTES,
+            SHADOW_POOLED_PAGES,
+            SHADOW_RESIDENT_BYTES,
+            CONTEXT_FILTERS,
+            SIZES_NUM
+        };
+
+        enum Phase{
+            INSTRUMENTATION,
+            FINI,
+            PHASES_NUM
+        };
+
+    private:
+        std::string outputPath;
+        uint64_t counters[COUNTERS_NUM];
+        size_t sizes[SIZES_NUM];
+        size_t peakSizes[SIZES_NUM];
+        uint64_t phaseCycles[PHASES_NUM];
+        uint64_t startCycles;
+        uint64_t endCycles;
+        uint64_t startNanoseconds;
+        uint64_t endNanoseconds;
+
+        Stats();
+        void reset();
+
+    public:
+        Stats(Stats const& other) = delete;
+        void operator=(Stats const& other) = delete;
+
+        static Stats& getInstance();
+
+        // Statistics are written to |path| by |write|. The execution phase starts when this is called.
+        void enable(const std::string& path);
+        bool isEnabled() const;
+
+        inline void increment(Counter counter){
+            ++counters[counter];
+        }
+
+        inline void add(Counter counter, uint64_t value){
+            counters[counter] += value;
+        }
+
+        // Updates the current size of a data structure, together with its peak size
+        void sample(Size size, size_t value);
+        void addCycles(Phase phase, uint64_t cycles);
+
+        // Called by fork server children: statistics inherited from the fork server are discarded, and the
+        // pid of the child is appended to the output path, so that children don't overwrite each other's statistics
+        void restart(int pid);
+
+        // Ends the execution phase. Only the first call has effect.
+        void endExecution();
+
+        bool write() const;
+};
+
+// Adds the cycles elapsed between its construction and its destruction to a phase
+class StatsTimer{
+    private:
+        Stats::Phase phase;
+        uint64_t start;
+
+    public:
+        StatsTimer(Stats::Phase phase);
+        ~StatsTimer();
+};
+
+#endif // STATS
@@ -0,0 +1,222 @@
+#include "StringRoutines.h"
+#include "RoutineSummaries.h"
+
+#include <wchar.h>
+#include <algorithm>
+
+struct StringRoutine{
+    const char* name;
+    // Number of strings taken as the first arguments
+    unsigned strings;
+};
+
+// Routines of string.h operating on strings of char
+static const StringRoutine narrowRoutines[] = {
+    {"strlen", 1}, {"strnlen", 1}, {"strcpy", 2}, {"strncpy", 2}, {"strcat", 2}, {"strncat", 2}, {"strcmp", 2},
+    {"strncmp", 2}, {"strcasecmp", 2}, {"strncasecmp", 2}, {"strchr", 1}, {"strchrnul", 1}, {"strrchr", 1},
+    {"strstr", 2}, {"strcasestr", 2}, {"strspn", 2}, {"strcspn", 2}, {"strpbrk", 2}, {"strdup", 1}, {"strndup", 1},
+    {"strcoll", 2}, {"strxfrm", 2}, {"stpcpy", 2}, {"stpncpy", 2}
+};
+
+// Routines of wchar.h operating on strings of wchar_t
+static const StringRoutine wideRoutines[] = {
+    {"wcslen", 1}, {"wcsnlen", 1}, {"wcscpy", 2}, {"wcsncpy", 2}, {"wcscat", 2}, {"wcsncat", 2}, {"wcscmp", 2},
+    {"wcsncmp", 2}, {"wcscasecmp", 2}, {"wcsncasecmp", 2}, {"wcschr", 1}, {"wcschrnul", 1}, {"wcsrchr", 1},
+    {"wcsstr", 2}, {"wcsspn", 2}, {"wcscspn", 2}, {"wcspbrk", 2}, {"wcsdup", 1}, {"wcpcpy", 2}, {"wcpncpy", 2}
+};
+
+StringRoutines::StringRoutines() : enabled(true){}
+
+StringRoutines& StringRoutines::getInstance(){
+    static StringRoutines instance;
+
+    return instance;
+}
+
+void StringRoutines::enable(bool enabled){
+    this->enabled = enabled;
+}
+
+bool StringRoutines::isEnabled() const{
+    return enabled;
+}
+
+StringRoutines::Kind StringRoutines::classify(const std::string& name, unsigned& strings){
+    std::string baseName = name.substr(0, name.find('@'));
+
+    // Internal aliases and optimized variants are prefixed by underscores (e.g. __stpcpy, __strlen_avx2)
+    size_t start = baseName.find_first_not_of('_');
+    if(start == std::string::npos)
+        return NONE;
+    baseName.erase(0, start);
+
+    for(const StringRoutine& routine : narrowRoutines){
+        if(RoutineSummaries::matches(baseName, routine.name)){
+            strings = routine.strings;
+            return NARROW;
+        }
+    }
+
+    for(const StringRoutine& routine : wideRoutines){
+        if(RoutineSummaries::matches(baseName, routine.name)){
+            strings = routine.strings;
+            return WIDE;
+        }
+    }
+
+    return NONE;
+}
+
+StringRoutines::Kind StringRoutines::addRoutine(RTN rtn, unsigned& strings){
+    if(!enabled || RTN_Size(rtn) == 0 || !RoutineSummaries::isLibc(SEC_Img(RTN_Sec(rtn))))
+        return NONE;
+
+    Kind kind = classify(RTN_Name(rtn), strings);
+    if(kind == NONE || SYM_IFuncResolver(RTN_Sym(rtn)))
+        return NONE;
+
+    ADDRINT start = RTN_Address(rtn);
+    Range& range = ranges[start];
+    range.end = start + RTN_Size(rtn) - 1;
+    range.kind = kind;
+    return kind;
+}
+
+void StringRoutines::onImageUnload(IMG img){
+    auto iter = ranges.lower_bound(IMG_LowAddress(img));
+    while(iter != ranges.end() && iter->first <= IMG_HighAddress(img)){
+        iter = ranges.erase(iter);
+    }
+}
+
+void StringRoutines::popReturnedFrames(ADDRINT sp){
+    // The stack pointer of a running routine never exceeds the one it was entered with
+    while(!frames.empty() && frames.back().sp < sp){
+        frames.pop_back();
+    }
+}
+
+void StringRoutines::enterRoutine(ADDRINT sp, ADDRINT firstArg, ADDRINT secondArg, unsigned strings){
+    popReturnedFrames(sp);
+
+    // A routine entered with the same stack pointer has been jumped to by the previous one (e.g. strcat jumping to
+    // strcpy), which never runs again
+    if(frames.empty() || frames.back().sp != sp)
+        frames.push_back(Frame());
+
+    Frame& frame = frames.back();
+    frame.sp = sp;
+    frame.strings[0] = firstArg;
+    frame.strings[1] = secondArg;
+    frame.stringsNum = strings;
+    for(unsigned i = 0; i < STRING_ROUTINE_MAX_STRINGS; ++i){
+        frame.terminators[i] = 0;
+        frame.scanned[i] = frame.strings[i];
+    }
+}
+
+StringRoutines::Frame* StringRoutines::getFrame(ADDRINT sp){
+    popReturnedFrames(sp);
+    return frames.empty() ? NULL : &frames.back();
+}
+
+StringRoutines::Kind StringRoutines::getKind(ADDRINT addr) const{
+    auto iter = ranges.upper_bound(addr);
+    if(iter == ranges.begin())
+        return NONE;
+
+    --iter;
+    return addr <= iter->second.end ? iter->second.kind : NONE;
+}
+
+bool StringRoutines::endsBefore(Frame& frame, unsigned index, ADDRINT addr, unsigned charSize){
+    if(frame.terminators[index] != 0)
+        return frame.terminators[index] + charSize <= addr;
+
+    uint8_t content[STRING_READ_MAX_SIZE];
+    ADDRINT& block = frame.scanned[index];
+    while(block + charSize <= addr){
+        size_t size = std::min((ADDRINT) sizeof(content), addr - block);
+        size -= size % charSize;
+        if(PIN_SafeCopy(content, (void*) block, size) != size)
+            return false;
+
+        for(size_t i = 0; i < size; i += charSize){
+            bool isZero = true;
+            for(unsigned j = 0; j < charSize; ++j){
+                isZero = isZero && content[i + j] == 0;
+            }
+
+            if(isZero){
+                frame.terminators[index] = block + i;
+                return true;
+            }
+        }
+
+        block += size;
+    }
+
+    return false;
+}
+
+bool StringRoutines::hasTerminator(ADDRINT addr, const uint8_t* content, const std::set<std::pair<unsigned, unsigned>>& intervals, ADDRINT string, unsigned end, unsigned charSize){
+    // Characters of the string are aligned to its beginning
+    unsigned first = string >= addr ? string - addr : (charSize - (addr - string) % charSize) % charSize;
+
+    auto interval = intervals.begin();
+    for(unsigned i = first; i + charSize <= end; i += charSize){
+        while(interval != intervals.end() && interval->second < i){
+            ++interval;
+        }
+
+        // At least one byte of the character is uninitialized
+        if(interval != intervals.end() && interval->first < i + charSize)
+            continue;
+
+        bool isZero = true;
+        for(unsigned j = 0; j < charSize; ++j){
+            isZero = isZero && content[i + j] == 0;
+        }
+
+        if(isZero)
+            return true;
+    }
+
+    return false;
+}
+
+bool StringRoutines::isOverRead(ADDRINT addr, const uint8_t* content, const std::set<std::pair<unsigned, unsigned>>& intervals, Kind kind, Frame& frame){
+    if(intervals.empty())
+        return false;
+
+    unsigned charSize = kind == WIDE ? sizeof(wchar_t) : 1;
+
+    for(const auto& uninitialized : intervals){
+        ADDRINT first = addr + uninitialized.first;
+        ADDRINT last = addr + uninitialized.second;
+
+        // Closest string starting at or before the first uninitialized byte, if any
+        int owner = -1;
+        for(unsigned i = 0; i < frame.stringsNum; ++i){
+            ADDRINT string = frame.strings[i];
+            // The first character of the string is uninitialized
+            if(string > first && string <= last)
+                return false;
+
+            if(string <= first && (owner < 0 || string > frame.strings[owner]))
+                owner = i;
+        }
+
+        // Bytes preceding every string are outside of them
+        if(owner < 0)
+            continue;
+
+        // Bytes following a string are outside of it only if they follow its terminator, either before the read or
+        // initialized among the bytes read
+        ADDRINT string = frame.strings[owner];
+        if(!(string < addr && endsBefore(frame, owner, addr, charSize)) && !hasTerminator(addr, content, intervals, string, uninitialized.first, charSize))
+            return false;
+    }
+
+    return true;
+}
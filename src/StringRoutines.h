@@ -0,0 +1,116 @@
+#ifndef STRINGROUTINES
+#define STRINGROUTINES
+
+#include "pin.H"
+#include <string>
+#include <map>
+#include <set>
+#include <vector>
+#include <utility>
+
+// Maximum size of a read checked by StringRoutines::isOverRead (i.e. the size of a ZMM register)
+#define STRING_READ_MAX_SIZE 64
+// Maximum number of strings passed as arguments to a string routine
+#define STRING_ROUTINE_MAX_STRINGS 2
+
+/*
+    Keeps track of the libc routines operating on nul-terminated strings (str*, stp* and wcs* routines, e.g. strlen, stpcpy,
+    wcscmp, and the variants selected by their IFUNC resolvers, e.g. __strlen_avx2), identified by name when libc is loaded.
+    Routines of other images and bounds-checking variants (e.g. strnlen_s) are analyzed as any other code.
+    Routines whose string is not passed as an argument (strtok and strsep) are not tracked.
+    Their optimized implementations read whole aligned blocks of memory, which usually extend before the beginning or after
+    the terminator of the string. The strings passed to a routine are recorded when it is entered (see |enterRoutine|),
+    and the reads it performs are analyzed by a dedicated routine (see |stringRoutineRead| in MemTrace.cpp), which doesn't
+    report uninitialized bytes lying outside of those strings, so that neither the string optimization heuristic nor the
+    string filter applied to the reports is needed for them.
+*/
+class StringRoutines{ // Singleton
+    public:
+        enum Kind{
+            NONE,
+            // Strings of char
+            NARROW,
+            // Strings of wchar_t
+            WIDE
+        };
+
+    private:
+        struct Range{
+            ADDRINT end;
+            Kind kind;
+        };
+
+    public:
+        // Call of a string routine which has not returned yet
+        struct Frame{
+            // Stack pointer when the routine was entered
+            ADDRINT sp;
+            // Addresses of the strings passed as arguments
+            ADDRINT strings[STRING_ROUTINE_MAX_STRINGS];
+            unsigned stringsNum;
+            // For each string, the address of its terminator if it has been found, or 0
+            ADDRINT terminators[STRING_ROUTINE_MAX_STRINGS];
+            // For each string, the first address which has not been scanned for its terminator yet
+            ADDRINT scanned[STRING_ROUTINE_MAX_STRINGS];
+        };
+
+    private:
+        bool enabled;
+        // Disjoint ranges of addresses of the string routines, mapping their first address to their last one
+        std::map<ADDRINT, Range> ranges;
+        // Calls of string routines (e.g. strlen called by strdup), the innermost one last
+        std::vector<Frame> frames;
+
+        // Removes the frames of the routines which already returned when the stack pointer is |sp|
+        void popReturnedFrames(ADDRINT sp);
+
+        // Returns true if the |index|-th string of |frame| ends before |addr|, i.e. a terminator precedes |addr|.
+        // Those bytes have already been read by the routine, so the status of the terminator has already been checked.
+        // Each byte is scanned at most once for each call of the routine.
+        static bool endsBefore(Frame& frame, unsigned index, ADDRINT addr, unsigned charSize);
+
+        // Returns true if the string starting at |string| has an initialized terminator ending before |end| (an offset
+        // from |addr|) among the bytes read
+        static bool hasTerminator(ADDRINT addr, const uint8_t* content, const std::set<std::pair<unsigned, unsigned>>& intervals, ADDRINT string, unsigned end, unsigned charSize);
+
+        StringRoutines();
+
+    public:
+        StringRoutines(StringRoutines const& other) = delete;
+        void operator=(StringRoutines const& other) = delete;
+
+        static StringRoutines& getInstance();
+
+        void enable(bool enabled);
+        bool isEnabled() const;
+
+        // Returns the kind of strings the routine called |name| (without any symbol version, e.g. strlen@GLIBC_2.2.5)
+        // operates on. If it is not NONE, |strings| is set to the number of strings it takes as its first arguments.
+        static Kind classify(const std::string& name, unsigned& strings);
+
+        // Returns the kind of strings |rtn| operates on. If it is not NONE, the addresses of the routine are recorded,
+        // and |enterRoutine| must be called whenever it is entered, with its first |strings| arguments.
+        // Only routines of libc are recorded, except for IFUNC resolvers (e.g. the routine named strlen).
+        Kind addRoutine(RTN rtn, unsigned& strings);
+
+        // Records the strings passed to the string routine entered with stack pointer |sp|
+        void enterRoutine(ADDRINT sp, ADDRINT firstArg, ADDRINT secondArg, unsigned strings);
+
+        // Returns the call of the innermost string routine running when the stack pointer is |sp|, or NULL if there is none
+        Frame* getFrame(ADDRINT sp);
+
+        // Must be called whenever an image is unloaded
+        void onImageUnload(IMG img);
+
+        // Returns the kind of the string routine containing |addr|, or NONE if there is no such routine
+        Kind getKind(ADDRINT addr) const;
+
+        // Returns true if the uninitialized bytes (|intervals|, see MemoryAccess::computeIntervals) read at |addr| by the
+        // string routine called as |frame|, operating on strings of the given |kind|, all lie outside of its strings: each
+        // one either precedes all of them (aligned blocks starting before a string) or follows the terminator of the
+        // closest string starting before it (which must be initialized if it is among the bytes read).
+        // |content| holds the bytes read.
+        static bool isOverRead(ADDRINT addr, const uint8_t* content, const std::set<std::pair<unsigned, unsigned>>& intervals, Kind kind, Frame& frame);
+};
+
+#endif // STRINGROUTINES
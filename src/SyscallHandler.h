@@ -1,5 +1,4 @@
 #include <iostream>
-#include <set>
 
 #include "Platform.h"
 
@@ -12,178 +11,38 @@
 #endif
 
 using std::endl;
-using std::set;
-
-// State pattern for the syscall handler
 
+/*
+    Keeps track of the system call being executed, from its entry to its exit, and retrieves the memory
+    accesses it performed.
+    The handler moves through 3 states: arguments are set when the system call is entered, then its return value
+    is set when it exits, and finally its memory accesses are retrieved, which brings the handler back to the first state.
+    Arguments and memory accesses are stored in buffers owned by the handler, so that no allocation is performed
+    for each system call.
+*/
 class SyscallHandler{
 
-    class SyscallHandlerUnsetState;
-    class SyscallHandlerSysEntryState;
-    class SyscallHandlerSysExitState;
-
-    class SyscallHandlerState{
-
-        protected:
-            unsigned short sysNum;
-            ADDRINT retVal;
-            // args actually contain only syscall arguments which are stack addresses
-            vector<ADDRINT> args;
-            ADDRINT lastSp;
-            ADDRINT lastBp;
-
-            void stateError(const char* msg){
-                std::cerr << msg << " (" << this->getName() << ")" << endl;
-                exit(1);
-            }
-
-        public:
-            virtual SyscallHandlerState* setSysArgs(unsigned short sysNum, vector<ADDRINT>& args){
-                stateError("Setting system call arguments is not valid at this state");
-                return NULL;
-            }
-
-            virtual SyscallHandlerState* setSysRet(ADDRINT sysRet){
-                stateError("Setting system call return value is not valid at this state");
-                return NULL;
-            }
-
-            virtual set<SyscallMemAccess> getReadsWrites(){
-                stateError("It's not possible to retrieve syscall readings and writings at this state");
-                return set<SyscallMemAccess>();
-            }
-
-            virtual bool isInitialized() const{
-                return false;
-            }
-
-            virtual const std::string getName(){
-                return std::string("Generic State");
-            }
-
-            // Method used to pass a reference and avoid copying a vector on state transition
-            vector<ADDRINT>& getArgs(){
-                return args;
-            }
-
-            virtual ~SyscallHandlerState(){};
-
-            friend class SyscallHandlerUnsetState;
-            friend class SyscallHandlerSysEntryState;
-            friend class SyscallHandlerSysExitState;
+    enum State{
+        UNSET,
+        SYS_ENTRY,
+        SYS_EXIT
     };
 
-
-
-
-
-    class SyscallHandlerSysExitState : public SyscallHandlerState{
-        private: 
-            SyscallHandlerState* nextState(){
-                return this;
-            }
-
-        public:
-            SyscallHandlerSysExitState(SyscallHandlerState* entryState){
-                this->sysNum = entryState->sysNum;
-                this->retVal = entryState->retVal;
-                this->args = entryState->getArgs();
-            }
-
-            SyscallHandlerSysExitState(const SyscallHandlerSysExitState& other) = delete;
-            SyscallHandlerSysExitState& operator=(const SyscallHandlerSysExitState& other) = delete;
-
-            const std::string getName() override{
-                return std::string("Sys Exit State");
-            }
-            
-            set<SyscallMemAccess> getReadsWrites() override{
-                return  HandlerSelector::getInstance().handle_syscall(
-                            this->sysNum, 
-                            this->retVal,
-                            this->args
-                        );
-            }
-    };
-
-
-
-
-
-    class SyscallHandlerSysEntryState : public SyscallHandlerState{
-        private:
-            SyscallHandlerState* nextState(){
-                SyscallHandlerSysExitState* state = new SyscallHandlerSysExitState(this);
-                return state;
-            }
-
-        public:
-            SyscallHandlerSysEntryState(SyscallHandlerState* unsetState){
-                this->sysNum = unsetState->sysNum;
-                this->args = unsetState->getArgs();
-            }
-
-            SyscallHandlerSysEntryState(const SyscallHandlerSysEntryState& other) = delete;
-            SyscallHandlerSysEntryState& operator=(const SyscallHandlerSysEntryState& other) = delete;
-
-            const std::string getName() override{
-                return std::string("Sys Entry State");
-            }
-            
-            SyscallHandlerState* setSysRet(ADDRINT sysRet) override{
-                this->retVal = sysRet;
-                SyscallHandlerState* state = nextState();
-                delete this;
-                return state;
-            }
-    };
-
-
-
-
-    class SyscallHandlerUnsetState : public SyscallHandlerState{
-        private:
-            SyscallHandlerState* nextState(){
-                SyscallHandlerSysEntryState* state = new SyscallHandlerSysEntryState(this);
-                return state;
-            }
-
-        public:
-            SyscallHandlerUnsetState(){}
-
-            SyscallHandlerUnsetState(const SyscallHandlerUnsetState& other) = delete;
-            SyscallHandlerUnsetState& operator=(const SyscallHandlerUnsetState& other) = delete;
-
-            const std::string getName() override{
-                return std::string("Unset State");
-            }
-            
-            SyscallHandlerState* setSysArgs(unsigned short sysNum, vector<ADDRINT>& args) override{
-                this->sysNum = sysNum;
-                this->args = vector<ADDRINT>(args);
-                SyscallHandlerState* state = nextState();
-                delete this;
-                return state;
-            }
-
-            bool isInitialized() const override{
-                return true;
-            }
-
-    };
-
-
     private:
-        SyscallHandlerState* currentState;
-
-        void initHandler(){
-            currentState = new SyscallHandlerUnsetState();
-        }                    
-
-        SyscallHandler(){
-            initHandler();
+        State state;
+        unsigned short sysNum;
+        ADDRINT retVal;
+        // args actually contain only syscall arguments which are stack addresses
+        ADDRINT args[SYSCALL_MAX_ARGS];
+        SyscallEffects effects;
+
+        void stateError(const char* msg){
+            std::cerr << msg << " (" << this->getStateName() << ")" << endl;
+            exit(1);
         }
 
+        SyscallHandler() : state(UNSET), sysNum(0), retVal(0), args(){}
+
     public:
 
         SyscallHandler(const SyscallHandler& other) = delete;
@@ -194,35 +53,57 @@ class SyscallHandler{
             return instance;
         }
 
-        void setSysArgs(unsigned short sysNum, vector<ADDRINT> actualArgs){
-            currentState = currentState->setSysArgs(sysNum, actualArgs);
+        void setSysArgs(unsigned short sysNum, const ADDRINT* actualArgs, unsigned short argsCount){
+            if(state != UNSET)
+                stateError("Setting system call arguments is not valid at this state");
+
+            this->sysNum = sysNum;
+            for(unsigned short i = 0; i < argsCount; ++i){
+                args[i] = actualArgs[i];
+            }
+            state = SYS_ENTRY;
         }
 
         void setSysRet(ADDRINT retVal){
-            currentState = currentState->setSysRet(retVal);
+            if(state != SYS_ENTRY)
+                stateError("Setting system call return value is not valid at this state");
+
+            this->retVal = retVal;
+            state = SYS_EXIT;
         }
 
-        set<SyscallMemAccess> getReadsWrites(){
-            set<SyscallMemAccess> ret = currentState->getReadsWrites();
-            initHandler();
-            return ret;
+        // The returned accesses are only valid until the next system call returns
+        const SyscallEffects& getReadsWrites(){
+            if(state != SYS_EXIT)
+                stateError("It's not possible to retrieve syscall readings and writings at this state");
+
+            HandlerSelector::getInstance().handle_syscall(sysNum, retVal, args, effects);
+            state = UNSET;
+            return effects;
         }
 
         // Returns true if initialization is required, denoting that the last called system call
         // did not return
         bool init(){
-            if(!currentState->isInitialized()){
-                initHandler();
+            if(state != UNSET){
+                state = UNSET;
                 return true;
             }
             return false;
         }
 
         std::string getStateName(){
-            return currentState->getName();
+            switch(state){
+                case UNSET:
+                    return std::string("Unset State");
+                case SYS_ENTRY:
+                    return std::string("Sys Entry State");
+                default:
+                    return std::string("Sys Exit State");
+            }
         }
 
         unsigned short getSyscallArgsCount(unsigned short sysNum){
             return HandlerSelector::getInstance().getSyscallArgsCount(sysNum);
         }
-};
\ No newline at end of file
+};
@@ -1,6 +1,14 @@
+#include <vector>
+
 #include "pin.H"
 #include "MemoryAccess.h"
 
+using std::vector;
+
+// Number of effects for which a SyscallEffects buffer is preallocated. System calls with more effects (e.g. a readv
+// with many buffers) simply grow it, and the grown buffer is then kept for the following system calls.
+#define SYSCALL_EFFECTS_RESERVED 64
+
 class SyscallMemAccess{
     private:
         ADDRINT accessAddress;
@@ -36,4 +44,43 @@ class SyscallMemAccess{
             }
             return false;
         }
-};
\ No newline at end of file
+};
+
+/*
+    Buffer holding the memory accesses performed by a system call, filled by its handler.
+    A single buffer is reused for every system call: clearing it doesn't release its memory, so, once
+    it has grown enough, handling a system call doesn't allocate anything.
+    Accesses are kept in the order the handler inserted them.
+*/
+class SyscallEffects{
+    private:
+        vector<SyscallMemAccess> accesses;
+
+    public:
+        SyscallEffects(){
+            accesses.reserve(SYSCALL_EFFECTS_RESERVED);
+        }
+
+        SyscallEffects(const SyscallEffects& other) = delete;
+        SyscallEffects& operator=(const SyscallEffects& other) = delete;
+
+        inline void insert(const SyscallMemAccess& access){
+            accesses.push_back(access);
+        }
+
+        inline void clear(){
+            accesses.clear();
+        }
+
+        inline size_t size() const{
+            return accesses.size();
+        }
+
+        inline vector<SyscallMemAccess>::const_iterator begin() const{
+            return accesses.begin();
+        }
+
+        inline vector<SyscallMemAccess>::const_iterator end() const{
+            return accesses.end();
+        }
+};
@@ -58,6 +58,10 @@ const tag_t TagManager::getTag(Access access){
     return ret;
 }
 
+bool TagManager::hasTag(const Access& access) const{
+    return accessToTag.find(access) != accessToTag.end();
+}
+
 void TagManager::increaseRefCount(tag_t tag){
     if(referenceCount.find(tag) == referenceCount.end())
         return;
@@ -103,4 +107,12 @@ void TagManager::decreaseRefCount(const set<tag_t>& tags){
     for(auto iter = tags.begin(); iter != tags.end(); ++iter){
         decreaseRefCount(*iter);
     }
+}
+
+size_t TagManager::getUsedTagsCount() const{
+    return tagToAccess.size();
+}
+
+size_t TagManager::getFreeTagsCount() const{
+    return freeTags.size();
 }
\ No newline at end of file
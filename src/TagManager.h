@@ -30,10 +30,16 @@ class TagManager{
         static TagManager& getInstance();
         const Access& getAccess(tag_t tag);
         const tag_t getTag(Access access);  
+        // Whether a tag is currently associated to |access|
+        bool hasTag(const Access& access) const;
         void increaseRefCount(tag_t tag);
         void increaseRefCount(const set<tag_t>& tags);
         void decreaseRefCount(tag_t tag);
         void decreaseRefCount(const set<tag_t>& tags);
+
+        // Number of tags currently associated to an access, and number of released tags waiting to be reused
+        size_t getUsedTagsCount() const;
+        size_t getFreeTagsCount() const;
 };
 
 #undef Access
@@ -1,6 +1,6 @@
 #include <list>
 #include <set>
-#include "pin.H"
+#include "../PinTypes.h"
 
 #ifndef INSTRUCTIONCLASSIFICATION
 #define INSTRUCTIONCLASSIFICATION
@@ -0,0 +1,43 @@
+#include "NulScan.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+uint64_t zeroBytesMask(const uint8_t* content, unsigned size){
+    uint64_t ret = 0;
+
+    #ifdef __SSE2__
+        // Compare 16 bytes at a time with 0 (pcmpeqb), and gather the most significant bit of each result (pmovmskb)
+        const __m128i zero = _mm_setzero_si128();
+        for(unsigned i = 0; i < NUL_SCAN_BLOCK_SIZE; i += 16){
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(content + i));
+            ret |= (uint64_t) (uint16_t) _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero)) << i;
+        }
+    #else
+        for(unsigned i = 0; i < NUL_SCAN_BLOCK_SIZE; ++i){
+            ret |= (uint64_t) (content[i] == 0) << i;
+        }
+    #endif
+
+    return size < NUL_SCAN_BLOCK_SIZE ? ret & ((1ULL << size) - 1) : ret;
+}
+
+uint64_t intervalsMask(const std::set<std::pair<unsigned, unsigned>>& intervals, unsigned start, unsigned size){
+    uint64_t ret = 0;
+    unsigned end = start + size - 1;
+
+    for(const auto& interval : intervals){
+        if(interval.second < start)
+            continue;
+        if(interval.first > end)
+            break;
+
+        unsigned first = (interval.first > start ? interval.first : start) - start;
+        unsigned last = (interval.second < end ? interval.second : end) - start;
+        // When the interval covers the whole block, 2 << 63 overflows to 0, and the mask correctly has all bits set
+        ret |= ((2ULL << (last - first)) - 1) << first;
+    }
+
+    return ret;
+}
@@ -0,0 +1,24 @@
+#ifndef NULSCAN
+#define NULSCAN
+
+#include <set>
+#include <utility>
+#include <stdint.h>
+
+// Number of bytes scanned at a time by |zeroBytesMask|
+#define NUL_SCAN_BLOCK_SIZE 64
+
+/*
+    Returns a mask having bit i set if |content|[i] is 0, for each of the first |size| bytes of |content|
+    (|size| must not be greater than NUL_SCAN_BLOCK_SIZE).
+    |content| must always be NUL_SCAN_BLOCK_SIZE bytes long: the bytes following the first |size| ones are read, but ignored.
+*/
+uint64_t zeroBytesMask(const uint8_t* content, unsigned size);
+
+/*
+    Returns a mask having bit i set if byte |start| + i belongs to any of the |intervals| (see MemoryAccess::computeIntervals),
+    for each of the |size| bytes starting from |start| (|size| must not be greater than NUL_SCAN_BLOCK_SIZE).
+*/
+uint64_t intervalsMask(const std::set<std::pair<unsigned, unsigned>>& intervals, unsigned start, unsigned size);
+
+#endif //NULSCAN
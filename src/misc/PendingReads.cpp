@@ -240,10 +240,11 @@ static map<range_t, set<tag_t>, IncreasingStartRangeSorter>& merge(map<range_t,
             range_t newRange(r1.first, r2.second);
             pair<range_t, set<tag_t>> newElem(newRange, s1);
             pair<ITERATOR, bool> ret = m.insert(newElem);
-            m.erase(iter);
-            m.erase(nxt);
+            // |s2| belongs to |nxt|, so the reference it held must be released before erasing it
             if(isPendingReadMap)
                 tagManager.decreaseRefCount(s2);
+            m.erase(iter);
+            m.erase(nxt);
             iter = ret.first;
         }
         else{
@@ -355,9 +356,10 @@ static GENERIC_ITERATOR split(map<range_t, set<tag_t>, S>& m, GENERIC_ITERATOR&
     unsigned origRefCount = 1;
 
     if(splittingRange == curr_range){
-        m.erase(iter);
+        // |origTags| belongs to |iter|, so the reference it held must be released before erasing it
         if(isPendingReadMap)
             tagManager.decreaseRefCount(origTags);
+        m.erase(iter);
         return ret;
     }
 
@@ -463,9 +465,12 @@ static void removeStoredPendingReads(range_t r){
 
 
 void updateStoredPendingReads(const AccessIndex& ai){
-    if(storedPendingUninitializedReads.size() != 0){
-        ADDRINT addr = ai.getFirst();
-        range_t r(addr, addr + ai.getSecond() - 1);
+    updateStoredPendingReads(ai.getFirst(), ai.getSecond());
+}
+
+void updateStoredPendingReads(ADDRINT addr, size_t size){
+    if(storedPendingUninitializedReads.size() != 0 && size != 0){
+        range_t r(addr, addr + size - 1);
         removeStoredPendingReads(r);
     }
 }
@@ -688,7 +693,7 @@ void copyStoredPendingReads(MemoryAccess& srcMA, MemoryAccess& dstMA, list<REG>*
         tagSet.insert(regsTags.begin(), regsTags.end());
 
         range.first = range.first - srcAddr + dstAddr;
-        range.second = range.first - srcAddr + dstAddr;
+        range.second = range.second - srcAddr + dstAddr;
         converted[range] = tagSet;
     }
 
@@ -698,3 +703,49 @@ void copyStoredPendingReads(MemoryAccess& srcMA, MemoryAccess& dstMA, list<REG>*
 
     insertStoredPendingReads(converted);
 }
+
+void copyStoredPendingReads(ADDRINT srcAddr, ADDRINT dstAddr, size_t size){
+    if(storedPendingUninitializedReads.size() == 0 || size == 0)
+        return;
+
+    range_t srcRange(srcAddr, srcAddr + size - 1);
+    map<range_t, set<tag_t>, IncreasingStartRangeSorter> converted;
+    for(auto iter = storedPendingUninitializedReads.begin(); iter != storedPendingUninitializedReads.end(); ++iter){
+        const range_t& iterRange = iter->first;
+        if(iterRange.first > srcRange.second || iterRange.second < srcRange.first)
+            continue;
+
+        // Only the part of the range inside the source is copied
+        range_t range = getOverlappingRange(iterRange, srcRange);
+        range.first = range.first - srcAddr + dstAddr;
+        range.second = range.second - srcAddr + dstAddr;
+        converted[range] = iter->second;
+    }
+
+    // If the ranges overlap, removing the destination range may release the last references to the copied tags
+    TagManager& tagManager = TagManager::getInstance();
+    for(auto iter = converted.begin(); iter != converted.end(); ++iter){
+        tagManager.increaseRefCount(iter->second);
+    }
+
+    removeStoredPendingReads(range_t(dstAddr, dstAddr + size - 1));
+    insertStoredPendingReads(converted);
+
+    for(auto iter = converted.begin(); iter != converted.end(); ++iter){
+        tagManager.decreaseRefCount(iter->second);
+    }
+}
+
+void clearPendingReads(){
+    TagManager& tagManager = TagManager::getInstance();
+
+    for(auto iter = pendingUninitializedReads.begin(); iter != pendingUninitializedReads.end(); ++iter){
+        tagManager.decreaseRefCount(iter->second);
+    }
+    pendingUninitializedReads.clear();
+
+    for(auto iter = storedPendingUninitializedReads.begin(); iter != storedPendingUninitializedReads.end(); ++iter){
+        tagManager.decreaseRefCount(iter->second);
+    }
+    storedPendingUninitializedReads.clear();
+}
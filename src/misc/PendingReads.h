@@ -1,6 +1,6 @@
 #include <list>
 #include <map>
-#include "pin.H"
+#include "../PinTypes.h"
 #include "../TagManager.h"
 #include "../AccessIndex.h"
 #include "../MemoryAccess.h"
@@ -35,10 +35,16 @@ void updatePendingReads(list<REG>* dstRegs);
 void propagatePendingReads(list<REG>* srcRegs, list<REG>* dstRegs);
 
 void updateStoredPendingReads(const AccessIndex& ai);
+void updateStoredPendingReads(ADDRINT addr, size_t size);
 void storePendingReads(list<REG>* srcRegs, MemoryAccess& ma);
 map<range_t, set<tag_t>> getStoredPendingReads(MemoryAccess& ma);
 map<range_t, set<tag_t>> getStoredPendingReads(AccessIndex& ai);
 void copyStoredPendingReads(MemoryAccess& srcMA, MemoryAccess& dstMA, list<REG>* srcRegs);
+// Moves the pending reads stored in [srcAddr, srcAddr + size) to [dstAddr, dstAddr + size), as memmove does with the memory
+void copyStoredPendingReads(ADDRINT srcAddr, ADDRINT dstAddr, size_t size);
+
+// Drops every pending read, both from registers and from memory, releasing the associated tags
+void clearPendingReads();
 
 /*
     Compute the difference |ranges| - |r2|, which means that we remove from range
@@ -1,6 +1,6 @@
 #include <list>
 
-#include "pin.H"
+#include "../PinTypes.h"
 
 #ifndef SETOPS
 #define SETOPS
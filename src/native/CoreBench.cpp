@@ -0,0 +1,390 @@
+/*
+    Benchmark of the core data structures of MemTrace, executed without Intel PIN.
+    Each benchmark drives one of the modules with a stream of memory accesses, either generated synthetically
+    or read from a trace file, and reports the average time per operation.
+
+    Usage: coreBench [-n ACCESSES] [-s SEED] [-t TRACE] [-b BUDGET] [-p OFF|THP|HUGETLB] [shadow|ranges|registers|tags|pending|fini ...]
+    A trace file contains one access per line, in the form "R|W <hex address> <size>".
+    If BUDGET (in bytes) is specified, the fini benchmark spills the access store to the current directory as MemTrace
+    does with knob --mem-budget. Option -p backs the shadow memory with huge pages, as knob --shadow-huge-pages does.
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <strings.h>
+#include <unistd.h>
+
+#include "PinTypes.h"
+#include "ShadowMemory.h"
+#include "ShadowPagePool.h"
+#include "ShadowRegisterFile.h"
+#include "MemoryAccess.h"
+#include "AccessIndex.h"
+#include "TagManager.h"
+#include "OverlapAnalysis.h"
+#include "AccessSpill.h"
+#include "AccessStream.h"
+#include "misc/PendingReads.h"
+
+// Globals defined by MemTrace.cpp, which is not part of the core library
+map<THREADID, ADDRINT> threadInfos;
+ADDRINT lowestHeapAddr = -1;
+unordered_map<ADDRINT, size_t> mallocatedPtrs;
+unordered_map<ADDRINT, size_t> mmapMallocated;
+#ifdef DEBUG
+    std::ofstream isReadLogger;
+#endif
+
+#define STACK_BASE 0x7ffffffff000ULL
+#define HEAP_BASE 0x555555560000ULL
+// Size of the synthetic stack and heap areas accessed by generated streams
+#define AREA_SIZE (1ULL << 20)
+
+struct TraceEntry{
+    AccessType type;
+    ADDRINT addr;
+    UINT32 size;
+    bool isStack;
+};
+
+static vector<TraceEntry> generateTrace(size_t accesses, unsigned seed){
+    std::mt19937_64 rng(seed);
+    static const UINT32 sizes[] = {1, 2, 4, 8, 8, 8, 16, 32};
+    vector<TraceEntry> trace;
+    trace.reserve(accesses);
+
+    for(size_t i = 0; i < accesses; ++i){
+        TraceEntry e;
+        e.isStack = rng() % 2 == 0;
+        e.type = rng() % 3 == 0 ? AccessType::READ : AccessType::WRITE;
+        e.size = sizes[rng() % (sizeof(sizes) / sizeof(sizes[0]))];
+        // Most accesses are aligned to their size, as the ones generated by compilers
+        ADDRINT offset = (rng() % AREA_SIZE) & ~((ADDRINT) e.size - 1);
+        e.addr = e.isStack ? STACK_BASE - AREA_SIZE + offset : HEAP_BASE + offset;
+        trace.push_back(e);
+    }
+
+    return trace;
+}
+
+static bool readTrace(const std::string& path, vector<TraceEntry>& trace){
+    std::ifstream in(path);
+    if(!in)
+        return false;
+
+    std::string type;
+    ADDRINT addr;
+    UINT32 size;
+    while(in >> type >> std::hex >> addr >> std::dec >> size){
+        TraceEntry e;
+        e.type = type == "R" ? AccessType::READ : AccessType::WRITE;
+        e.addr = addr;
+        e.size = size;
+        e.isStack = addr <= STACK_BASE && addr > STACK_BASE - (1ULL << 32);
+        trace.push_back(e);
+    }
+
+    return true;
+}
+
+static ShadowBase* selectShadow(const TraceEntry& e){
+    return e.isStack ? (ShadowBase*) &stack : (ShadowBase*) &heap;
+}
+
+static void report(const char* name, size_t operations, std::chrono::steady_clock::duration elapsed){
+    double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    std::cout << name << ": " << operations << " operations, " << ns / 1000000 << " ms, " <<
+        (operations != 0 ? ns / operations : 0) << " ns/op" << std::endl;
+}
+
+static void benchShadow(const vector<TraceEntry>& trace){
+    unsigned long long checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for(size_t i = 0; i < trace.size(); ++i){
+        const TraceEntry& e = trace[i];
+        currentShadow = selectShadow(e);
+
+        if(e.type == AccessType::WRITE){
+            set_as_initialized(e.addr, e.size);
+        }
+        else{
+            uint8_t* interval = getUninitializedInterval(e.addr, e.size);
+            if(interval != NULL){
+                checksum += interval[0];
+                free(interval);
+            }
+        }
+
+        // Periodically simulate the return from a deep stack frame
+        if(i % 4096 == 4095)
+            stack.reset(STACK_BASE - AREA_SIZE / 2);
+    }
+
+    report("shadow", trace.size(), std::chrono::steady_clock::now() - start);
+    std::cerr << "shadow checksum: " << checksum << std::endl;
+}
+
+// Bulk operations on large buffers, as the ones written and read by system calls or released by free
+static void benchRanges(const vector<TraceEntry>& trace){
+    unsigned long long checksum = 0;
+    unsigned long long bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for(size_t i = 0; i < trace.size(); ++i){
+        const TraceEntry& e = trace[i];
+        ShadowBase* shadow = selectShadow(e);
+        size_t size = e.size * 1024 + i % 8;
+
+        if(i % 16 == 15){
+            shadow->resetRange(e.addr, size);
+        }
+        else if(i % 64 == 62){
+            heap.copyRange(HEAP_BASE + (e.addr % AREA_SIZE), *shadow, e.addr, size);
+        }
+        else if(e.type == AccessType::WRITE){
+            shadow->initializeRange(e.addr, size);
+        }
+        else{
+            checksum += shadow->firstUninitialized(e.addr, size);
+        }
+        bytes += size;
+    }
+
+    report("ranges", trace.size(), std::chrono::steady_clock::now() - start);
+    std::cerr << "ranges checksum: " << checksum << ", " << bytes << " bytes" << std::endl;
+}
+
+static void benchRegisters(const vector<TraceEntry>& trace){
+    static const REG regs[] = {REG_RAX, REG_EBX, REG_CX, REG_DL, REG_AH, REG_RSI, REG_R8, REG_R9D, REG_XMM0, REG_XMM1};
+    const unsigned regsNum = sizeof(regs) / sizeof(regs[0]);
+    ShadowRegisterFile& registerFile = ShadowRegisterFile::getInstance();
+    uint8_t data[64];
+    memset(data, 0xff, sizeof(data));
+    unsigned long long checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for(size_t i = 0; i < trace.size(); ++i){
+        const TraceEntry& e = trace[i];
+        REG reg = regs[e.addr % regsNum];
+
+        if(e.type == AccessType::WRITE){
+            if(e.size < 8){
+                registerFile.setAsInitialized(reg, data);
+            }
+            else{
+                registerFile.setBitsAsInitialized(reg);
+            }
+        }
+        else{
+            uint8_t* status = registerFile.getContentStatus(reg);
+            checksum += status[0];
+            free(status);
+        }
+    }
+
+    report("registers", trace.size(), std::chrono::steady_clock::now() - start);
+    std::cerr << "registers checksum: " << checksum << std::endl;
+}
+
+static void benchTags(const vector<TraceEntry>& trace){
+    TagManager& tagManager = TagManager::getInstance();
+    vector<tag_t> live;
+    unsigned long long executionOrder = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for(size_t i = 0; i < trace.size(); ++i){
+        const TraceEntry& e = trace[i];
+        MemoryAccess ma(0, ++executionOrder, e.addr, e.addr, e.addr, 0, 0, e.size, e.type, NULL, selectShadow(e));
+        tag_t tag = tagManager.getTag(std::make_pair(AccessIndex(e.addr, e.size), ma));
+        tagManager.increaseRefCount(tag);
+        live.push_back(tag);
+
+        // Keep a bounded number of live tags, so that released tags are reused
+        if(live.size() > 1024){
+            for(tag_t t : live){
+                tagManager.decreaseRefCount(t);
+            }
+            live.clear();
+        }
+    }
+
+    for(tag_t t : live){
+        tagManager.decreaseRefCount(t);
+    }
+
+    report("tags", trace.size(), std::chrono::steady_clock::now() - start);
+}
+
+static void benchPending(const vector<TraceEntry>& trace){
+    static const REG regs[] = {REG_RAX, REG_RBX, REG_RCX, REG_RDX, REG_RSI, REG_RDI, REG_R8, REG_R9};
+    const unsigned regsNum = sizeof(regs) / sizeof(regs[0]);
+    ShadowRegisterFile& registerFile = ShadowRegisterFile::getInstance();
+    unsigned long long executionOrder = 0;
+    // Owned by the access store in MemTrace, freed at the end of the benchmark here
+    vector<uint8_t*> intervals;
+    auto start = std::chrono::steady_clock::now();
+
+    for(size_t i = 0; i < trace.size(); ++i){
+        const TraceEntry& e = trace[i];
+        list<REG> src(1, regs[e.addr % regsNum]);
+        list<REG> dst(1, regs[(e.addr >> 3) % regsNum]);
+
+        if(e.type == AccessType::READ){
+            // Uninitialized read loaded into |src|
+            MemoryAccess ma(0, ++executionOrder, e.addr, e.addr, e.addr, 0, 0, e.size, e.type, NULL, selectShadow(e));
+            uint8_t* interval = (uint8_t*) calloc(1, e.size + sizeof(size_t));
+            intervals.push_back(interval);
+            ma.setUninitializedInterval(interval);
+            ma.setUninitializedRead();
+            registerFile.setAsInitialized(src.front());
+            addPendingRead(&src, ma);
+        }
+        else{
+            propagatePendingReads(&src, &dst);
+        }
+
+        if(i % 4096 == 4095)
+            clearPendingReads();
+    }
+    clearPendingReads();
+
+    report("pending", trace.size(), std::chrono::steady_clock::now() - start);
+
+    for(uint8_t* interval : intervals){
+        free(interval);
+    }
+}
+
+static void benchFini(const vector<TraceEntry>& trace, size_t budget){
+    AccessStore memAccesses;
+    AccessSpill& accessSpill = AccessSpill::getInstance();
+    accessSpill.enable(".", budget);
+    unsigned long long executionOrder = 0;
+
+    for(const TraceEntry& e : trace){
+        MemoryAccess ma(0, ++executionOrder, e.addr, e.addr, e.addr, 0, 0, e.size, e.type, NULL, selectShadow(e));
+        if(e.type == AccessType::READ){
+            // The hashers of MemoryAccess read the interval in words of 8 bytes
+            ma.setUninitializedInterval((uint8_t*) calloc(1, e.size + sizeof(size_t)));
+            ma.setUninitializedRead();
+        }
+
+        auto& group = memAccesses[AccessIndex(e.addr, e.size)];
+        bool isNewGroup = group.empty();
+        if(group.insert(ma).second){
+            accessSpill.accessStored(ma, isNewGroup);
+            if(accessSpill.isOverBudget() && accessSpill.spill(memAccesses) < 0){
+                std::cerr << "Can't write spill segment" << std::endl;
+                accessSpill.disable();
+            }
+        }
+    }
+
+    // Same steps as writeReport: full overlaps are streamed once, and partial overlaps are computed over a sliding window
+    auto start = std::chrono::steady_clock::now();
+    vector<OrderedAccessEntry> inMemory = getOrderedView(memAccesses);
+    size_t groups = 0;
+    size_t accesses = 0;
+    size_t partialOverlapAccesses = 0;
+
+    AccessStream fullOverlaps(inMemory, accessSpill.getSegments());
+    StreamedGroup group;
+    OrderedAccessGroup v;
+    while(fullOverlaps.next(group, v)){
+        ++groups;
+        accesses += v.size();
+    }
+
+    OverlapWindow partialOverlaps(inMemory, accessSpill.getSegments());
+    while(partialOverlaps.next()){
+        partialOverlapAccesses += partialOverlaps.getPartialOverlapGroup().size();
+    }
+
+    report("fini", groups, std::chrono::steady_clock::now() - start);
+    std::cerr << "fini: " << accesses << " accesses, " << partialOverlapAccesses << " partial overlap accesses, " <<
+        accessSpill.getSegments().size() << " spill segments" << std::endl;
+
+    accessSpill.clear();
+    for(auto& entry : memAccesses){
+        for(const MemoryAccess& ma : entry.second){
+            ma.freeMemory();
+        }
+    }
+}
+
+static void usage(const char* name){
+    std::cerr << "Usage: " << name << " [-n ACCESSES] [-s SEED] [-t TRACE] [-b BUDGET] [-p OFF|THP|HUGETLB] [shadow|ranges|registers|tags|pending|fini ...]" << std::endl;
+}
+
+int main(int argc, char* argv[]){
+    size_t accesses = 1000000;
+    unsigned seed = 0;
+    std::string tracePath;
+    size_t budget = 0;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:s:t:b:p:h")) != -1){
+        switch(opt){
+            case 'n': accesses = strtoull(optarg, NULL, 0); break;
+            case 's': seed = strtoul(optarg, NULL, 0); break;
+            case 't': tracePath = optarg; break;
+            case 'b': budget = strtoull(optarg, NULL, 0); break;
+            case 'p':
+                if(strcasecmp(optarg, "THP") == 0)
+                    ShadowPagePool::getInstance().enableHugePages(ShadowPagePool::THP);
+                else if(strcasecmp(optarg, "HUGETLB") == 0)
+                    ShadowPagePool::getInstance().enableHugePages(ShadowPagePool::HUGETLB);
+                break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    vector<std::string> benchmarks(argv + optind, argv + argc);
+    if(benchmarks.empty())
+        benchmarks = {"shadow", "ranges", "registers", "tags", "pending", "fini"};
+
+    vector<TraceEntry> trace;
+    if(tracePath.empty()){
+        trace = generateTrace(accesses, seed);
+    }
+    else if(!readTrace(tracePath, trace)){
+        std::cerr << "Unable to read " << tracePath << std::endl;
+        return 1;
+    }
+
+    stack.setBaseAddr(STACK_BASE);
+    heap.setBaseAddr(HEAP_BASE);
+    currentShadow = &stack;
+
+    for(const std::string& b : benchmarks){
+        if(b == "shadow")
+            benchShadow(trace);
+        else if(b == "ranges")
+            benchRanges(trace);
+        else if(b == "registers")
+            benchRegisters(trace);
+        else if(b == "tags")
+            benchTags(trace);
+        else if(b == "pending")
+            benchPending(trace);
+        else if(b == "fini")
+            benchFini(trace, budget);
+        else{
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // As done by Fini
+    stack.freeMemory();
+    heap.freeMemory();
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+#ifndef PINSHIM
+#define PINSHIM
+
+/*
+    Subset of the types and constants of Intel PIN used by the core modules of the tool, allowing them to be built
+    natively (i.e. without PIN) by defining MEMTRACE_NATIVE (see PinTypes.h).
+    Opcodes and ISA extensions are the ones of XED, whose headers are shipped with PIN.
+    NOTE: values of REG don't match the ones of PIN. Registers must always be referred to by name.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+extern "C" {
+    #include "xed-iclass-enum.h"
+    #include "xed-extension-enum.h"
+}
+
+#if defined(__x86_64__)
+    #define TARGET_IA32E
+    #define HOST_IA32E
+#else
+    #define TARGET_IA32
+    #define HOST_IA32
+#endif
+
+#if defined(__linux__)
+    #define TARGET_LINUX
+#endif
+
+typedef uintptr_t ADDRINT;
+typedef uint8_t UINT8;
+typedef uint16_t UINT16;
+typedef uint32_t UINT32;
+typedef uint64_t UINT64;
+typedef int8_t INT8;
+typedef int16_t INT16;
+typedef int32_t INT32;
+typedef int64_t INT64;
+typedef bool BOOL;
+typedef UINT32 THREADID;
+typedef UINT32 OPCODE;
+
+#define PIN_REG_TABLE(X) \
+    X(RAX) X(RBP) X(RBX) X(RCX) X(RDI) X(RDX) X(RIP) X(RSI) \
+    X(RSP) X(R8) X(R9) X(R10) X(R11) X(R12) X(R13) X(R14) \
+    X(R15) X(EAX) X(EBP) X(EBX) X(ECX) X(EDI) X(EDX) X(EIP) \
+    X(ESI) X(ESP) X(R8D) X(R9D) X(R10D) X(R11D) X(R12D) X(R13D) \
+    X(R14D) X(R15D) X(AX) X(BP) X(BX) X(CX) X(DI) X(DX) \
+    X(SI) X(SP) X(R8W) X(R9W) X(R10W) X(R11W) X(R12W) X(R13W) \
+    X(R14W) X(R15W) X(AH) X(AL) X(BH) X(BL) X(BPL) X(CH) \
+    X(CL) X(DH) X(DIL) X(DL) X(SIL) X(SPL) X(R8B) X(R9B) \
+    X(R10B) X(R11B) X(R12B) X(R13B) X(R14B) X(R15B) X(ST0) X(ST1) \
+    X(ST2) X(ST3) X(ST4) X(ST5) X(ST6) X(ST7) X(MM0) X(MM1) \
+    X(MM2) X(MM3) X(MM4) X(MM5) X(MM6) X(MM7) X(XMM0) X(XMM1) \
+    X(XMM2) X(XMM3) X(XMM4) X(XMM5) X(XMM6) X(XMM7) X(XMM8) X(XMM9) \
+    X(XMM10) X(XMM11) X(XMM12) X(XMM13) X(XMM14) X(XMM15) X(XMM16) X(XMM17) \
+    X(XMM18) X(XMM19) X(XMM20) X(XMM21) X(XMM22) X(XMM23) X(XMM24) X(XMM25) \
+    X(XMM26) X(XMM27) X(XMM28) X(XMM29) X(XMM30) X(XMM31) X(YMM0) X(YMM1) \
+    X(YMM2) X(YMM3) X(YMM4) X(YMM5) X(YMM6) X(YMM7) X(YMM8) X(YMM9) \
+    X(YMM10) X(YMM11) X(YMM12) X(YMM13) X(YMM14) X(YMM15) X(YMM16) X(YMM17) \
+    X(YMM18) X(YMM19) X(YMM20) X(YMM21) X(YMM22) X(YMM23) X(YMM24) X(YMM25) \
+    X(YMM26) X(YMM27) X(YMM28) X(YMM29) X(YMM30) X(YMM31) X(ZMM0) X(ZMM1) \
+    X(ZMM2) X(ZMM3) X(ZMM4) X(ZMM5) X(ZMM6) X(ZMM7) X(ZMM8) X(ZMM9) \
+    X(ZMM10) X(ZMM11) X(ZMM12) X(ZMM13) X(ZMM14) X(ZMM15) X(ZMM16) X(ZMM17) \
+    X(ZMM18) X(ZMM19) X(ZMM20) X(ZMM21) X(ZMM22) X(ZMM23) X(ZMM24) X(ZMM25) \
+    X(ZMM26) X(ZMM27) X(ZMM28) X(ZMM29) X(ZMM30) X(ZMM31) X(K0) X(K1) \
+    X(K2) X(K3) X(K4) X(K5) X(K6) X(K7)
+
+enum REG{
+    REG_INVALID_,
+    #define X(name) REG_##name,
+    PIN_REG_TABLE(X)
+    #undef X
+    REG_LAST,
+
+    #if defined(TARGET_IA32E)
+    REG_STACK_PTR = REG_RSP,
+    REG_INST_PTR = REG_RIP,
+    REG_GAX = REG_RAX,
+    REG_GBP = REG_RBP
+    #else
+    REG_STACK_PTR = REG_ESP,
+    REG_INST_PTR = REG_EIP,
+    REG_GAX = REG_EAX,
+    REG_GBP = REG_EBP
+    #endif
+};
+
+inline std::string REG_StringShort(REG reg){
+    static const char* names[] = {
+        "invalid",
+        #define X(name) #name,
+        PIN_REG_TABLE(X)
+        #undef X
+    };
+
+    return reg < REG_LAST ? names[reg] : "invalid";
+}
+
+#endif // PINSHIM
@@ -0,0 +1,181 @@
+#include "MappedReport.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+MappedReport::MappedReport() :
+    base(NULL),
+    size(0),
+    header(NULL),
+    legacy(false)
+{}
+
+MappedReport::~MappedReport(){
+    if(base != NULL)
+        munmap(const_cast<uint8_t*>(base), size);
+}
+
+bool MappedReport::fail(const std::string& message){
+    error = message;
+    if(base != NULL){
+        munmap(const_cast<uint8_t*>(base), size);
+        base = NULL;
+    }
+    header = NULL;
+    size = 0;
+    return false;
+}
+
+bool MappedReport::open(const std::string& path){
+    legacy = false;
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return fail(std::string("Can't open ") + path + ": " + strerror(errno));
+
+    struct stat st;
+    if(fstat(fd, &st) < 0){
+        close(fd);
+        return fail(std::string("Can't stat ") + path + ": " + strerror(errno));
+    }
+
+    size = st.st_size;
+    if(size < sizeof(ReportFormat::Header)){
+        close(fd);
+        legacy = true;
+        return fail(path + " is too short to be a report");
+    }
+
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED)
+        return fail(std::string("Can't map ") + path + ": " + strerror(errno));
+
+    base = reinterpret_cast<const uint8_t*>(mapping);
+    header = reinterpret_cast<const ReportFormat::Header*>(base);
+
+    if(memcmp(header->magic, ReportFormat::MAGIC, sizeof(header->magic)) != 0){
+        legacy = true;
+        return fail(path + " has been written with the legacy report format");
+    }
+
+    if(header->version != ReportFormat::VERSION)
+        return fail(path + ": unsupported report version " + std::to_string(header->version));
+
+    if(!validate())
+        return fail(path + ": " + error);
+
+    return true;
+}
+
+// Check every section and cross reference once, so that accessors can be used without any further check
+bool MappedReport::validate(){
+    using namespace ReportFormat;
+
+    static const uint64_t recordSizes[SECTIONS_NUM] = {
+        sizeof(EntryRecord),
+        sizeof(IntervalRecord),
+        sizeof(AccessSetRecord),
+        sizeof(AccessSetRecord),
+        sizeof(InstructionRecord),
+        sizeof(ImageRecord),
+        1
+    };
+
+    for(int s = 0; s < SECTIONS_NUM; ++s){
+        const SectionDescriptor& descriptor = header->sections[s];
+        if(descriptor.offset > size || descriptor.count > (size - descriptor.offset) / recordSizes[s]){
+            error = "section " + std::to_string(s) + " exceeds the report size";
+            return false;
+        }
+        if(s != STRINGS && descriptor.offset % 8 != 0){
+            error = "section " + std::to_string(s) + " is not aligned";
+            return false;
+        }
+    }
+
+    uint64_t stringsSize = count(STRINGS);
+    if(stringsSize > 0 && string(0)[stringsSize - 1] != '\0'){
+        error = "string table is not terminated";
+        return false;
+    }
+
+    for(uint64_t i = 0; i < count(IMAGES); ++i){
+        if(image(i).nameOffset >= stringsSize){
+            error = "image name out of string table";
+            return false;
+        }
+    }
+
+    for(uint64_t i = 0; i < count(INSTRUCTIONS); ++i){
+        const InstructionRecord& ins = instruction(i);
+        if(ins.disasmOffset >= stringsSize || (ins.imageIndex != NO_IMAGE && ins.imageIndex >= count(IMAGES))){
+            error = "instruction " + std::to_string(i) + " refers to missing records";
+            return false;
+        }
+    }
+
+    uint64_t intervalsCount = count(INTERVALS);
+    for(uint64_t i = 0; i < count(ENTRIES); ++i){
+        const EntryRecord& e = entry(i);
+        if(e.instructionIndex >= count(INSTRUCTIONS) || e.firstInterval > intervalsCount || e.intervalsCount > intervalsCount - e.firstInterval){
+            error = "entry " + std::to_string(i) + " refers to missing records";
+            return false;
+        }
+    }
+
+    for(Section s : {FULL_OVERLAPS, PARTIAL_OVERLAPS}){
+        const AccessSetRecord* sets = accessSets(s);
+        for(uint64_t i = 0; i < count(s); ++i){
+            if(sets[i].firstEntry > count(ENTRIES) || sets[i].entriesCount > count(ENTRIES) - sets[i].firstEntry){
+                error = "access set " + std::to_string(i) + " refers to missing entries";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool MappedReport::isLegacy() const{
+    return legacy;
+}
+
+const std::string& MappedReport::getError() const{
+    return error;
+}
+
+uint64_t MappedReport::getStackBase() const{
+    return header->stackBase;
+}
+
+uint64_t MappedReport::count(ReportFormat::Section s) const{
+    return header->sections[s].count;
+}
+
+const ReportFormat::AccessSetRecord* MappedReport::accessSets(ReportFormat::Section s) const{
+    return section<ReportFormat::AccessSetRecord>(s);
+}
+
+const ReportFormat::EntryRecord& MappedReport::entry(uint64_t index) const{
+    return section<ReportFormat::EntryRecord>(ReportFormat::ENTRIES)[index];
+}
+
+const ReportFormat::IntervalRecord* MappedReport::intervals(const ReportFormat::EntryRecord& entry) const{
+    return section<ReportFormat::IntervalRecord>(ReportFormat::INTERVALS) + entry.firstInterval;
+}
+
+const ReportFormat::InstructionRecord& MappedReport::instruction(uint32_t index) const{
+    return section<ReportFormat::InstructionRecord>(ReportFormat::INSTRUCTIONS)[index];
+}
+
+const ReportFormat::ImageRecord& MappedReport::image(uint32_t index) const{
+    return section<ReportFormat::ImageRecord>(ReportFormat::IMAGES)[index];
+}
+
+const char* MappedReport::string(uint32_t offset) const{
+    return section<char>(ReportFormat::STRINGS) + offset;
+}
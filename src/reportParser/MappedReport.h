@@ -0,0 +1,65 @@
+#ifndef MAPPEDREPORT
+#define MAPPEDREPORT
+
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../ReportFormat.h"
+
+// Read-only view of a binary report (see ReportFormat.h) mapped in memory.
+// Records are never copied: every accessor returns a reference or a pointer inside the mapping, which
+// stays valid until the object is destroyed.
+class MappedReport{
+    private:
+        const uint8_t* base;
+        size_t size;
+        const ReportFormat::Header* header;
+        bool legacy;
+        std::string error;
+
+        template<typename T>
+        const T* section(ReportFormat::Section s) const{
+            return reinterpret_cast<const T*>(base + header->sections[s].offset);
+        }
+
+        bool fail(const std::string& message);
+
+        bool validate();
+
+    public:
+        MappedReport();
+
+        ~MappedReport();
+
+        MappedReport(const MappedReport& other) = delete;
+
+        MappedReport& operator=(const MappedReport& other) = delete;
+
+        // Maps the report at |path|. Returns false, setting the error message, if the file can't be mapped
+        // or it is not a valid report.
+        bool open(const std::string& path);
+
+        // True if the last call to |open| failed because the file is a report written with the legacy format
+        bool isLegacy() const;
+
+        const std::string& getError() const;
+
+        uint64_t getStackBase() const;
+
+        uint64_t count(ReportFormat::Section s) const;
+
+        const ReportFormat::AccessSetRecord* accessSets(ReportFormat::Section s) const;
+
+        const ReportFormat::EntryRecord& entry(uint64_t index) const;
+
+        const ReportFormat::IntervalRecord* intervals(const ReportFormat::EntryRecord& entry) const;
+
+        const ReportFormat::InstructionRecord& instruction(uint32_t index) const;
+
+        const ReportFormat::ImageRecord& image(uint32_t index) const;
+
+        const char* string(uint32_t offset) const;
+};
+
+#endif // MAPPEDREPORT
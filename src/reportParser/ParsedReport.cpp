@@ -0,0 +1,315 @@
+#include "ParsedReport.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+std::string toHex(uint64_t value){
+    char buf[19];
+    snprintf(buf, sizeof(buf), "0x%lx", (unsigned long) value);
+    return std::string(buf);
+}
+
+static const char* tableSeparator = "===============================================";
+
+void writeTableHeader(std::ostream& out, const std::string& header){
+    out << tableSeparator << "\n" << header << "\n" << tableSeparator << "\n";
+}
+
+void writeTableFooter(std::ostream& out){
+    out << tableSeparator << "\n" << tableSeparator << "\n\n\n\n\n";
+}
+
+// Implementation of AccessView methods
+
+uint64_t AccessView::getIP() const{
+    return report->instruction(entry->instructionIndex).ip;
+}
+
+uint64_t AccessView::getActualIP() const{
+    return report->instruction(entry->instructionIndex).actualIp;
+}
+
+const char* AccessView::getDisasm() const{
+    return report->string(report->instruction(entry->instructionIndex).disasmOffset);
+}
+
+uint32_t AccessView::getSize() const{
+    return entry->size;
+}
+
+int64_t AccessView::getSPOffset() const{
+    return entry->spOffset;
+}
+
+int64_t AccessView::getBPOffset() const{
+    return entry->bpOffset;
+}
+
+bool AccessView::isWrite() const{
+    return entry->flags & ReportFormat::WRITE;
+}
+
+bool AccessView::isUninitializedRead() const{
+    return entry->flags & ReportFormat::UNINITIALIZED_READ;
+}
+
+bool AccessView::isStackAccess() const{
+    return entry->flags & ReportFormat::STACK;
+}
+
+bool AccessView::isPartialOverlap() const{
+    return entry->flags & ReportFormat::PARTIAL_OVERLAP;
+}
+
+uint32_t AccessView::getIntervalsCount() const{
+    return entry->intervalsCount;
+}
+
+uint64_t AccessView::getFingerprint() const{
+    return entry->fingerprint;
+}
+
+const ReportFormat::IntervalRecord* AccessView::getIntervals() const{
+    return report->intervals(*entry);
+}
+
+const ReportFormat::AccessSetRecord* AccessView::getAccessSet() const{
+    return accessSet;
+}
+
+std::string AccessView::toString() const{
+    std::string ret(isPartialOverlap() ? "=> " : "   ");
+
+    if(isUninitializedRead())
+        ret += "*";
+
+    const char* disasm = getDisasm();
+    ret += toHex(getIP()) + " (" + toHex(getActualIP()) + "):";
+    ret += *disasm != '\0' ? "\t" : " ";
+    ret += disasm;
+    ret += isWrite() ? " W " : " R ";
+    ret += std::to_string(getSize()) + " B ";
+    if(isStackAccess()){
+        ret += "@ (sp ";
+        ret += getSPOffset() >= 0 ? "+ " : "- ";
+        ret += std::to_string(llabs(getSPOffset()));
+        ret += "); (bp ";
+        ret += getBPOffset() >= 0 ? "+ " : "- ";
+        ret += std::to_string(llabs(getBPOffset()));
+        ret += "); ";
+    }
+
+    const ReportFormat::IntervalRecord* intervals = getIntervals();
+    for(uint32_t i = 0; i < getIntervalsCount(); ++i){
+        ret += "[" + std::to_string(intervals[i].lowerBound) + " ~ " + std::to_string(intervals[i].upperBound) + "]";
+    }
+
+    return ret;
+}
+
+bool AccessView::equals(const AccessView& other) const{
+    if(getIP() != other.getIP() ||
+        isWrite() != other.isWrite() ||
+        getSize() != other.getSize() ||
+        isUninitializedRead() != other.isUninitializedRead() ||
+        isStackAccess() != other.isStackAccess() ||
+        isPartialOverlap() != other.isPartialOverlap() ||
+        getIntervalsCount() != other.getIntervalsCount())
+        return false;
+
+    const ReportFormat::IntervalRecord* intervals = getIntervals();
+    const ReportFormat::IntervalRecord* otherIntervals = other.getIntervals();
+    for(uint32_t i = 0; i < getIntervalsCount(); ++i){
+        if(intervals[i].lowerBound != otherIntervals[i].lowerBound || intervals[i].upperBound != otherIntervals[i].upperBound)
+            return false;
+    }
+
+    return true;
+}
+
+
+// Functions replicating python_modules/maSet.py
+
+static bool intervalsOverlap(uint32_t firstLower, uint32_t firstUpper, uint32_t secondLower, uint32_t secondUpper){
+    if(firstLower <= secondLower)
+        return secondLower <= firstUpper;
+    return firstLower <= secondUpper;
+}
+
+// Same as is_read_by_uninitialized_read: |following| points to the accesses executed after |write|
+static bool isReadByUninitializedRead(const AccessView& write, AccessList::const_iterator following, AccessList::const_iterator end){
+    if(write.getIntervalsCount() == 0)
+        return false;
+
+    uint32_t writeLower = write.getIntervals()[0].lowerBound;
+    uint32_t writeUpper = write.getIntervals()[0].upperBound;
+    std::vector<bool> overwritten(writeUpper - writeLower + 1, false);
+    uint32_t notOverwrittenCount = overwritten.size();
+
+    for(; following != end; ++following){
+        if(notOverwrittenCount == 0)
+            return false;
+
+        if(following->isWrite()){
+            if(following->getIntervalsCount() == 0)
+                continue;
+
+            uint32_t lower = following->getIntervals()[0].lowerBound;
+            uint32_t upper = following->getIntervals()[0].upperBound;
+            if(!intervalsOverlap(writeLower, writeUpper, lower, upper))
+                continue;
+
+            for(uint32_t i = std::max(lower, writeLower); i <= std::min(upper, writeUpper); ++i){
+                if(!overwritten[i - writeLower]){
+                    overwritten[i - writeLower] = true;
+                    --notOverwrittenCount;
+                }
+            }
+        }
+        else if(following->getSize() > 0 && intervalsOverlap(writeLower, writeUpper, 0, following->getSize() - 1)){
+            return true;
+        }
+    }
+
+    return false;
+}
+
+AccessList removeUselessWrites(const AccessList& overlaps){
+    AccessList ret;
+
+    bool containsReads = false;
+    for(const AccessView& access : overlaps){
+        if(!access.isWrite()){
+            containsReads = true;
+            break;
+        }
+    }
+
+    if(!containsReads)
+        return ret;
+
+    for(auto iter = overlaps.begin(); iter != overlaps.end(); ++iter){
+        if(!iter->isWrite() || isReadByUninitializedRead(*iter, iter + 1, overlaps.end()))
+            ret.push_back(*iter);
+    }
+
+    return ret;
+}
+
+bool checkForOverlappingWrites(const AccessList& overlaps, const AccessView& uninitializedRead){
+    const ReportFormat::IntervalRecord* readIntervals = uninitializedRead.getIntervals();
+
+    for(const AccessView& access : overlaps){
+        if(!access.isWrite() || access.getIntervalsCount() == 0)
+            continue;
+
+        // NOTE: write accesses are supposed to have only 1 interval
+        const ReportFormat::IntervalRecord& writeInterval = access.getIntervals()[0];
+        for(uint32_t i = 0; i < uninitializedRead.getIntervalsCount(); ++i){
+            if(intervalsOverlap(writeInterval.lowerBound, writeInterval.upperBound, readIntervals[i].lowerBound, readIntervals[i].upperBound))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+
+// Implementation of ParsedReport methods
+
+ParsedReport::ParsedReport(const MappedReport& report, bool ignoreIfNoOverlappingWrite, const std::set<uint64_t>& ignoredAddresses) :
+    report(report),
+    stackBase(report.getStackBase())
+{
+    for(uint64_t i = 0; i < report.count(ReportFormat::IMAGES); ++i){
+        const ReportFormat::ImageRecord& image = report.image(i);
+        LoadBase loadBase(report.string(image.nameOffset), image.baseAddress);
+
+        bool duplicated = false;
+        for(const LoadBase& lb : loadBases){
+            if(lb.second == loadBase.second && strcmp(lb.first, loadBase.first) == 0){
+                duplicated = true;
+                break;
+            }
+        }
+        if(!duplicated)
+            loadBases.push_back(loadBase);
+    }
+
+    // The python parser orders load addresses as hexadecimal strings: keep the very same order
+    std::stable_sort(loadBases.begin(), loadBases.end(), [](const LoadBase& lb1, const LoadBase& lb2){
+        return toHex(lb1.second) < toHex(lb2.second);
+    });
+
+    for(size_t i = 0; i < loadBases.size(); ++i){
+        loadBasesByAddress.push_back(i);
+    }
+    std::stable_sort(loadBasesByAddress.begin(), loadBasesByAddress.end(), [this](size_t i1, size_t i2){
+        return loadBases[i1].second < loadBases[i2].second;
+    });
+
+    const ReportFormat::AccessSetRecord* sets = report.accessSets(ReportFormat::FULL_OVERLAPS);
+    for(uint64_t i = 0; i < report.count(ReportFormat::FULL_OVERLAPS); ++i){
+        AccessList overlaps;
+        overlaps.reserve(sets[i].entriesCount);
+        for(uint64_t e = sets[i].firstEntry; e < sets[i].firstEntry + sets[i].entriesCount; ++e){
+            overlaps.push_back(AccessView(&report, &report.entry(e), &sets[i]));
+        }
+
+        if(overlaps.size() > 0)
+            fullOverlaps.push_back(AccessGroup(&sets[i], std::move(overlaps)));
+    }
+
+    sets = report.accessSets(ReportFormat::PARTIAL_OVERLAPS);
+    for(uint64_t i = 0; i < report.count(ReportFormat::PARTIAL_OVERLAPS); ++i){
+        AccessList overlaps;
+        unsigned ignored = 0;
+
+        for(uint64_t e = sets[i].firstEntry; e < sets[i].firstEntry + sets[i].entriesCount; ++e){
+            AccessView access(&report, &report.entry(e), &sets[i]);
+            if(access.isUninitializedRead()){
+                if(ignoreIfNoOverlappingWrite && !checkForOverlappingWrites(overlaps, access))
+                    continue;
+
+                if(ignoredAddresses.find(access.getActualIP()) != ignoredAddresses.end()){
+                    printf("%s  ignored\n", toHex(access.getActualIP()).c_str());
+                    ++ignored;
+                    continue;
+                }
+            }
+
+            overlaps.push_back(access);
+        }
+
+        if(ignoreIfNoOverlappingWrite || ignored > 0)
+            overlaps = removeUselessWrites(overlaps);
+
+        if(overlaps.size() > 0)
+            partialOverlaps.push_back(AccessGroup(&sets[i], std::move(overlaps)));
+    }
+}
+
+const LoadBase* ParsedReport::findLib(uint64_t addr) const{
+    auto it = std::upper_bound(loadBasesByAddress.begin(), loadBasesByAddress.end(), addr, [this](uint64_t value, size_t index){
+        return value < loadBases[index].second;
+    });
+    if(it == loadBasesByAddress.begin())
+        return NULL;
+
+    // Among images loaded at the same address, return the first one (as python's max does)
+    uint64_t base = loadBases[*(it - 1)].second;
+    it = std::lower_bound(loadBasesByAddress.begin(), loadBasesByAddress.end(), base, [this](size_t index, uint64_t value){
+        return loadBases[index].second < value;
+    });
+    return &loadBases[*it];
+}
+
+const LoadBase* ParsedReport::findLibByName(const char* name) const{
+    for(const LoadBase& lb : loadBases){
+        if(strcmp(lb.first, name) == 0)
+            return &lb;
+    }
+    return NULL;
+}
@@ -0,0 +1,101 @@
+#ifndef PARSEDREPORT
+#define PARSEDREPORT
+
+#include <string>
+#include <ostream>
+#include <vector>
+#include <set>
+#include <utility>
+
+#include "MappedReport.h"
+
+// A single access of a report. It only points to the records of the mapped report it comes from.
+class AccessView{
+    private:
+        const MappedReport* report;
+        const ReportFormat::EntryRecord* entry;
+        const ReportFormat::AccessSetRecord* accessSet;
+
+    public:
+        AccessView(const MappedReport* report, const ReportFormat::EntryRecord* entry, const ReportFormat::AccessSetRecord* accessSet) :
+            report(report),
+            entry(entry),
+            accessSet(accessSet)
+            {}
+
+        uint64_t getIP() const;
+
+        uint64_t getActualIP() const;
+
+        const char* getDisasm() const;
+
+        uint32_t getSize() const;
+
+        int64_t getSPOffset() const;
+
+        int64_t getBPOffset() const;
+
+        bool isWrite() const;
+
+        bool isUninitializedRead() const;
+
+        bool isStackAccess() const;
+
+        bool isPartialOverlap() const;
+
+        uint32_t getIntervalsCount() const;
+
+        uint64_t getFingerprint() const;
+
+        const ReportFormat::IntervalRecord* getIntervals() const;
+
+        // The access set (AccessIndex) the access has been reported in
+        const ReportFormat::AccessSetRecord* getAccessSet() const;
+
+        // Same as the string representation of MemoryAccess objects in python_modules/parsedData.py
+        std::string toString() const;
+
+        // Same as MemoryAccess.__eq__ in python_modules/parsedData.py (actual IPs are not compared)
+        bool equals(const AccessView& other) const;
+};
+
+typedef std::vector<AccessView> AccessList;
+typedef std::pair<const ReportFormat::AccessSetRecord*, AccessList> AccessGroup;
+typedef std::pair<const char*, uint64_t> LoadBase;
+
+// Mirrors ParseResult of python_modules/parsedData.py, as built by |parse| of bin/binOverlapParser.py
+class ParsedReport{
+    private:
+        const MappedReport& report;
+        // Indexes of |loadBases| ordered by (numeric) base address, used by |findLib|
+        std::vector<size_t> loadBasesByAddress;
+
+    public:
+        std::vector<LoadBase> loadBases;
+        uint64_t stackBase;
+        std::vector<AccessGroup> fullOverlaps;
+        std::vector<AccessGroup> partialOverlaps;
+
+        ParsedReport(const MappedReport& report, bool ignoreIfNoOverlappingWrite, const std::set<uint64_t>& ignoredAddresses);
+
+        // Returns the image the given address belongs to (the one with the highest base address lower than or
+        // equal to |addr|), or NULL if there is no such image
+        const LoadBase* findLib(uint64_t addr) const;
+
+        const LoadBase* findLibByName(const char* name) const;
+};
+
+// Same as python's hex()
+std::string toHex(uint64_t value);
+
+// Same as print_table_header and print_table_footer in bin/binOverlapParser.py
+void writeTableHeader(std::ostream& out, const std::string& header);
+void writeTableFooter(std::ostream& out);
+
+// Same as remove_useless_writes in python_modules/maSet.py
+AccessList removeUselessWrites(const AccessList& overlaps);
+
+// Same as check_for_overlapping_writes in python_modules/maSet.py
+bool checkForOverlappingWrites(const AccessList& overlaps, const AccessView& uninitializedRead);
+
+#endif // PARSEDREPORT
@@ -0,0 +1,267 @@
+#include "ReportMerger.h"
+
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <sys/stat.h>
+
+static const char* setSeparator = "***********************************************";
+
+AccessList removeMaskedWrites(const AccessList& writes, uint32_t readSize){
+    AccessList ret;
+    std::vector<uint8_t> bitMap(readSize, 0);
+
+    for(auto it = writes.rbegin(); it != writes.rend(); ++it){
+        if(it->getIntervalsCount() == 0){
+            ret.push_back(*it);
+            continue;
+        }
+
+        uint64_t lower = it->getIntervals()[0].lowerBound;
+        uint64_t upper = (uint64_t) it->getIntervals()[0].upperBound + 1;
+        uint64_t size = upper - lower;
+
+        // Python slices are clamped to the list size, and assigning a longer list to a slice extends it
+        uint64_t sliceBegin = std::min<uint64_t>(lower, bitMap.size());
+        uint64_t sliceEnd = std::max(sliceBegin, std::min<uint64_t>(upper, bitMap.size()));
+        uint64_t sum = 0;
+        for(uint64_t i = sliceBegin; i < sliceEnd; ++i){
+            sum += bitMap[i];
+        }
+
+        if(sum < size){
+            bitMap.erase(bitMap.begin() + sliceBegin, bitMap.begin() + sliceEnd);
+            bitMap.insert(bitMap.begin() + sliceBegin, size, 1);
+            ret.push_back(*it);
+        }
+    }
+
+    std::reverse(ret.begin(), ret.end());
+    return ret;
+}
+
+ReportMerger::ReportMerger(bool ignoreIfNoOverlap, StringFilter* filter) :
+    ignoreIfNoOverlap(ignoreIfNoOverlap),
+    filter(filter)
+{}
+
+ReportMerger::InputStatus ReportMerger::addInput(const std::string& ref, const std::string& inputDir){
+    std::string reportPath = inputDir + "/overlaps.bin";
+    printf("Parsing binary report from %s\n", inputDir.c_str());
+
+    struct stat st;
+    if(stat(reportPath.c_str(), &st) != 0){
+        printf("Binary report not found in %s\n", inputDir.c_str());
+        return NOT_FOUND;
+    }
+
+    Input input;
+    input.ref = ref;
+    input.report.reset(new MappedReport());
+    if(!input.report->open(reportPath)){
+        if(input.report->isLegacy())
+            return LEGACY;
+
+        printf("ParseError raised for %s\n", inputDir.c_str());
+        printf("%s\n", input.report->getError().c_str());
+        return INVALID;
+    }
+
+    input.parsed.reset(new ParsedReport(*input.report, ignoreIfNoOverlap, std::set<uint64_t>()));
+    if(filter != NULL){
+        printf("Applying filter\n");
+        filter->apply(*input.parsed);
+    }
+
+    inputs.push_back(std::move(input));
+    size_t inputIndex = inputs.size() - 1;
+
+    for(const AccessGroup& group : inputs[inputIndex].parsed->partialOverlaps){
+        AccessList writes;
+        bool hasRead = false;
+
+        for(const AccessView& access : group.second){
+            if(access.isWrite()){
+                writes.push_back(access);
+                continue;
+            }
+
+            if(hasRead)
+                writes = removeMaskedWrites(writes, access.getSize());
+            hasRead = true;
+
+            addSet(inputIndex, writes, access);
+        }
+    }
+
+    return ADDED;
+}
+
+void ReportMerger::addSet(size_t inputIndex, const AccessList& writes, const AccessView& read){
+    const ParsedReport& parsed = *inputs[inputIndex].parsed;
+
+    MergedSet newSet;
+    newSet.origins.push_back(inputIndex);
+    newSet.accesses.reserve(writes.size() + 1);
+    newSet.accesses.insert(newSet.accesses.end(), writes.begin(), writes.end());
+    newSet.accesses.push_back(read);
+
+    for(const AccessView& access : newSet.accesses){
+        const LoadBase* lib = parsed.findLib(access.getActualIP());
+        newSet.libOffsets.push_back(access.getActualIP() - (lib != NULL ? lib->second : 0));
+    }
+
+    const ReportFormat::AccessSetRecord* accessSet = read.getAccessSet();
+    uint64_t memBase;
+    newSet.stack = read.isStackAccess();
+    newSet.size = accessSet->size;
+    if(newSet.stack){
+        memBase = parsed.stackBase;
+        newSet.memName = "stack";
+    }
+    else{
+        const LoadBase* heap = parsed.findLibByName("Heap");
+        if(heap == NULL)
+            heap = parsed.findLib(accessSet->address);
+
+        memBase = heap != NULL ? heap->second : 0;
+        newSet.memName = heap != NULL ? heap->first : "";
+    }
+    newSet.memOffset = (int64_t) (accessSet->address - memBase);
+
+    newSet.fingerprint = ReportFormat::FINGERPRINT_SEED;
+    newSet.fingerprint = ReportFormat::addToFingerprint(newSet.fingerprint, newSet.stack);
+    newSet.fingerprint = ReportFormat::addToFingerprint(newSet.fingerprint, newSet.memOffset);
+    newSet.fingerprint = ReportFormat::addToFingerprint(newSet.fingerprint, newSet.size);
+    for(const AccessView& access : newSet.accesses){
+        newSet.fingerprint = ReportFormat::addToFingerprint(newSet.fingerprint, access.getFingerprint());
+    }
+
+    const LoadBase* lib = parsed.findLib(read.getActualIP());
+    InstructionKey key;
+    key.ip = read.getIP();
+    key.libName = lib != NULL ? lib->first : "";
+    key.offset = read.getActualIP() - (lib != NULL ? lib->second : 0);
+
+    auto found = instructionsIndex.find(key);
+    if(found == instructionsIndex.end()){
+        MergedInstruction instruction;
+        instruction.ip = key.ip;
+        instruction.actualIp = read.getActualIP();
+        instruction.baseAddr = lib != NULL ? lib->second : 0;
+        instruction.libName = key.libName;
+        instruction.ignored = false;
+        instruction.setsIndex.insert(std::make_pair(newSet.fingerprint, 0));
+        instruction.sets.push_back(std::move(newSet));
+
+        instructionsIndex.insert(std::make_pair(std::move(key), instructions.size()));
+        instructions.push_back(std::move(instruction));
+        return;
+    }
+
+    // Same as |merge_ma_sets|: look for an identical set coming from another input.
+    // Only sets with the same fingerprint can be identical.
+    MergedInstruction& instruction = instructions[found->second];
+    auto candidates = instruction.setsIndex.equal_range(newSet.fingerprint);
+    for(auto it = candidates.first; it != candidates.second; ++it){
+        MergedSet& mergedSet = instruction.sets[it->second];
+        if(equalSets(mergedSet, newSet)){
+            if(std::find(mergedSet.origins.begin(), mergedSet.origins.end(), inputIndex) == mergedSet.origins.end())
+                mergedSet.origins.push_back(inputIndex);
+            return;
+        }
+    }
+
+    instruction.setsIndex.insert(std::make_pair(newSet.fingerprint, instruction.sets.size()));
+    instruction.sets.push_back(std::move(newSet));
+}
+
+bool ReportMerger::equalSets(const MergedSet& set1, const MergedSet& set2){
+    if(set1.accesses.size() != set2.accesses.size() || set1.stack != set2.stack ||
+        set1.memOffset != set2.memOffset || set1.size != set2.size)
+        return false;
+
+    for(size_t i = 0; i < set1.accesses.size(); ++i){
+        if(set1.libOffsets[i] != set2.libOffsets[i] || !set1.accesses[i].equals(set2.accesses[i]))
+            return false;
+    }
+
+    return true;
+}
+
+void ReportMerger::removeIgnored(const std::map<std::string, std::set<uint64_t>>& ignoredAddresses){
+    if(ignoredAddresses.empty())
+        return;
+
+    printf("Removing ignored addresses...\n");
+
+    for(MergedInstruction& instruction : instructions){
+        auto lib = ignoredAddresses.find(instruction.libName);
+        if(lib == ignoredAddresses.end())
+            continue;
+
+        uint64_t offset = instruction.actualIp - instruction.baseAddr;
+        if(lib->second.find(offset) != lib->second.end()){
+            printf("Offset %s of library %s ignored\n", toHex(offset).c_str(), instruction.libName.c_str());
+            instruction.ignored = true;
+        }
+    }
+}
+
+bool ReportMerger::writeBaseAddresses(const std::string& path) const{
+    std::ofstream out(path);
+    if(!out)
+        return false;
+
+    for(const Input& input : inputs){
+        out << "===============================================\n";
+        out << input.ref;
+        out << "\n===============================================\n";
+        for(const LoadBase& lb : input.parsed->loadBases){
+            out << lb.first << " base address: " << toHex(lb.second) << "\n";
+        }
+
+        out << "Stack base address: " << toHex(input.parsed->stackBase) << "\n";
+        out << "===============================================\n";
+        out << "===============================================\n\n";
+    }
+
+    return (bool) out;
+}
+
+bool ReportMerger::writePartialOverlaps(const std::string& path, bool reportUniqueAccessSets) const{
+    std::ofstream out(path);
+    if(!out)
+        return false;
+
+    bool isEmpty = true;
+    for(const MergedInstruction& instruction : instructions){
+        if(instruction.ignored || (!reportUniqueAccessSets && instruction.sets.size() < 2))
+            continue;
+
+        isEmpty = false;
+        writeTableHeader(out, toHex(instruction.ip) + "(" + toHex(instruction.actualIp) + "): " + instruction.libName + " loaded at @ " + toHex(instruction.baseAddr));
+
+        for(const MergedSet& mergedSet : instruction.sets){
+            out << "Generated by " << mergedSet.origins.size() << " inputs:\n";
+            out << inputs[mergedSet.origins[0]].ref << "\n";
+            out << "Reads " << mergedSet.size << " bytes from <" << mergedSet.memName << "_base> " << (mergedSet.memOffset >= 0 ? "+ " : "- ") << (uint64_t) llabs(mergedSet.memOffset) << "\n";
+            out << setSeparator << "\n";
+
+            for(const AccessView& access : mergedSet.accesses){
+                out << access.toString() << "\n";
+            }
+
+            out << setSeparator << "\n\n";
+        }
+
+        writeTableFooter(out);
+    }
+
+    if(isEmpty)
+        out << "** NO OVERLAPS DETECTED **\n";
+
+    return (bool) out;
+}
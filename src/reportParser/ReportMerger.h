@@ -0,0 +1,108 @@
+#ifndef REPORTMERGER
+#define REPORTMERGER
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <unordered_map>
+#include <stdint.h>
+
+#include "MappedReport.h"
+#include "ParsedReport.h"
+#include "StringFilter.h"
+
+// Native counterpart of |merge_reports| in bin/merge_reports.py.
+// Every input report stays mapped until the merger is destroyed, as merged sets only refer to its records.
+class ReportMerger{
+    public:
+        enum InputStatus{
+            ADDED,
+            NOT_FOUND,
+            INVALID,
+            LEGACY
+        };
+
+    private:
+        struct Input{
+            std::string ref;
+            std::unique_ptr<MappedReport> report;
+            std::unique_ptr<ParsedReport> parsed;
+        };
+
+        // Same as InstructionAddress in python_modules/instructionAddress.py: instructions are identified
+        // by the ip, the library they belong to and their offset inside that library
+        struct InstructionKey{
+            uint64_t ip;
+            std::string libName;
+            uint64_t offset;
+
+            bool operator==(const InstructionKey& other) const{
+                return ip == other.ip && offset == other.offset && libName == other.libName;
+            }
+        };
+
+        struct InstructionKeyHasher{
+            size_t operator()(const InstructionKey& key) const{
+                return std::hash<uint64_t>()(key.ip) ^ (std::hash<uint64_t>()(key.offset) << 1) ^ (std::hash<std::string>()(key.libName) << 2);
+            }
+        };
+
+        // Same as MASet in python_modules/maSet.py
+        struct MergedSet{
+            std::vector<size_t> origins;
+            AccessList accesses;
+            // Offset of the actual ip of every access from the library it belongs to, inside the first origin
+            std::vector<uint64_t> libOffsets;
+            bool stack;
+            int64_t memOffset;
+            uint32_t size;
+            std::string memName;
+            // Combination of the fingerprints of the entries and of the memory location: identical sets
+            // always have the same fingerprint
+            uint64_t fingerprint;
+        };
+
+        struct MergedInstruction{
+            uint64_t ip;
+            uint64_t actualIp;
+            uint64_t baseAddr;
+            std::string libName;
+            bool ignored;
+            std::vector<MergedSet> sets;
+            // Indexes of |sets| by fingerprint
+            std::unordered_multimap<uint64_t, size_t> setsIndex;
+        };
+
+        bool ignoreIfNoOverlap;
+        StringFilter* filter;
+        std::vector<Input> inputs;
+        // Merged instructions, in the same order they have been found for the first time
+        std::vector<MergedInstruction> instructions;
+        std::unordered_map<InstructionKey, size_t, InstructionKeyHasher> instructionsIndex;
+
+        void addSet(size_t inputIndex, const AccessList& writes, const AccessView& read);
+
+        static bool equalSets(const MergedSet& set1, const MergedSet& set2);
+
+    public:
+        // If |filter| is not NULL, it is applied to every input report
+        ReportMerger(bool ignoreIfNoOverlap, StringFilter* filter);
+
+        // Parses the binary report contained in |inputDir| and merges its access sets.
+        // |ref| is the name the input is referred to by inside the textual reports.
+        InputStatus addInput(const std::string& ref, const std::string& inputDir);
+
+        // Removes the uninitialized reads at the given offsets, grouped by library name
+        void removeIgnored(const std::map<std::string, std::set<uint64_t>>& ignoredAddresses);
+
+        bool writeBaseAddresses(const std::string& path) const;
+
+        bool writePartialOverlaps(const std::string& path, bool reportUniqueAccessSets) const;
+};
+
+// Emulates |remove_masked_writes| of bin/merge_reports.py (including its python slices semantic)
+AccessList removeMaskedWrites(const AccessList& writes, uint32_t readSize);
+
+#endif // REPORTMERGER
@@ -0,0 +1,189 @@
+#include "StringFilter.h"
+
+#include <elf.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <libgen.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string.h>
+#include <cstdio>
+#include <algorithm>
+
+static const char* debugFolders[] = {"/usr/lib/debug", "/lib/debug", "/usr/bin/.debug"};
+
+template<typename Ehdr, typename Shdr, typename Sym, typename SymbolsList>
+static void readFunctionSymbols(const uint8_t* elf, size_t size, SymbolsList& ret){
+    const Ehdr* ehdr = reinterpret_cast<const Ehdr*>(elf);
+    if(ehdr->e_shoff == 0 || ehdr->e_shoff + (uint64_t) ehdr->e_shnum * sizeof(Shdr) > size || ehdr->e_shstrndx >= ehdr->e_shnum)
+        return;
+
+    const Shdr* sections = reinterpret_cast<const Shdr*>(elf + ehdr->e_shoff);
+    const Shdr& shstrtab = sections[ehdr->e_shstrndx];
+    if(shstrtab.sh_offset + shstrtab.sh_size > size)
+        return;
+
+    for(unsigned i = 0; i < ehdr->e_shnum; ++i){
+        const Shdr& symtab = sections[i];
+        if(symtab.sh_name >= shstrtab.sh_size || strcmp((const char*) elf + shstrtab.sh_offset + symtab.sh_name, ".symtab") != 0)
+            continue;
+
+        if(symtab.sh_link >= ehdr->e_shnum || symtab.sh_offset + symtab.sh_size > size)
+            return;
+
+        const Shdr& strtab = sections[symtab.sh_link];
+        if(strtab.sh_offset + strtab.sh_size > size)
+            return;
+
+        const Sym* syms = reinterpret_cast<const Sym*>(elf + symtab.sh_offset);
+        for(uint64_t s = 0; s < symtab.sh_size / sizeof(Sym); ++s){
+            // ELF32_ST_TYPE and ELF64_ST_TYPE are the same macro
+            if(ELF64_ST_TYPE(syms[s].st_info) != STT_FUNC || syms[s].st_name >= strtab.sh_size)
+                continue;
+
+            const char* name = (const char*) elf + strtab.sh_offset + syms[s].st_name;
+            ret.push_back({syms[s].st_value, syms[s].st_size, std::string(name, strnlen(name, strtab.sh_size - syms[s].st_name))});
+        }
+        return;
+    }
+}
+
+StringFilter::StringFilter(const std::string& debugFile) :
+    debugFile(debugFile),
+    debugFileDetected(!debugFile.empty())
+{}
+
+const std::string& StringFilter::findDebugPath(const std::string& libPath){
+    if(debugFileDetected)
+        return debugFile;
+
+    debugFileDetected = true;
+
+    std::vector<char> pathCopy(libPath.begin(), libPath.end());
+    pathCopy.push_back('\0');
+    std::string dirName(dirname(pathCopy.data()));
+
+    for(const char* folder : debugFolders){
+        std::string fullPath = std::string(folder) + (dirName[0] == '/' ? "" : "/") + dirName;
+        DIR* dir = opendir(fullPath.c_str());
+        if(dir == NULL)
+            continue;
+
+        struct dirent* file;
+        while((file = readdir(dir)) != NULL){
+            if(strstr(file->d_name, "libc") != NULL){
+                debugFile = fullPath + "/" + file->d_name;
+                break;
+            }
+        }
+        closedir(dir);
+
+        if(!debugFile.empty()){
+            printf("Debug file detected: %s\n", debugFile.c_str());
+            return debugFile;
+        }
+    }
+
+    debugFile = libPath;
+    printf("No debug symbols file found. Using library's path: %s\n", libPath.c_str());
+    return debugFile;
+}
+
+const std::vector<StringFilter::FunctionSymbol>& StringFilter::loadSymbols(const std::string& elfPath){
+    auto found = symbols.find(elfPath);
+    if(found != symbols.end())
+        return found->second;
+
+    std::vector<FunctionSymbol>& ret = symbols[elfPath];
+
+    int fd = open(elfPath.c_str(), O_RDONLY);
+    if(fd < 0)
+        return ret;
+
+    struct stat st;
+    if(fstat(fd, &st) < 0 || (size_t) st.st_size < EI_NIDENT){
+        close(fd);
+        return ret;
+    }
+
+    void* mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED)
+        return ret;
+
+    const uint8_t* elf = reinterpret_cast<const uint8_t*>(mapping);
+    if(memcmp(elf, ELFMAG, SELFMAG) == 0){
+        if(elf[EI_CLASS] == ELFCLASS64 && (size_t) st.st_size >= sizeof(Elf64_Ehdr))
+            readFunctionSymbols<Elf64_Ehdr, Elf64_Shdr, Elf64_Sym>(elf, st.st_size, ret);
+        else if(elf[EI_CLASS] == ELFCLASS32 && (size_t) st.st_size >= sizeof(Elf32_Ehdr))
+            readFunctionSymbols<Elf32_Ehdr, Elf32_Shdr, Elf32_Sym>(elf, st.st_size, ret);
+    }
+
+    munmap(mapping, st.st_size);
+    return ret;
+}
+
+const char* StringFilter::findFunctionName(const std::string& elfPath, uint64_t offset){
+    for(const FunctionSymbol& symbol : loadSymbols(elfPath)){
+        if(symbol.start <= offset && offset - symbol.start < symbol.size)
+            return symbol.name.c_str();
+    }
+
+    return NULL;
+}
+
+void StringFilter::apply(ParsedReport& report){
+    std::vector<AccessGroup> filtered;
+
+    for(AccessGroup& group : report.partialOverlaps){
+        AccessList newSet;
+
+        for(const AccessView& access : group.second){
+            if(access.isWrite()){
+                newSet.push_back(access);
+                continue;
+            }
+
+            const LoadBase* lib = report.findLib(access.getActualIP());
+            if(lib == NULL || strstr(lib->first, "libc") == NULL){
+                newSet.push_back(access);
+                continue;
+            }
+
+            uint64_t offset = access.getActualIP() - lib->second;
+            if(alreadyRemoved.find(offset) != alreadyRemoved.end())
+                continue;
+            if(alreadyChecked.find(offset) != alreadyChecked.end()){
+                newSet.push_back(access);
+                continue;
+            }
+
+            const char* funcName = findFunctionName(findDebugPath(lib->first), offset);
+            if(funcName == NULL){
+                printf("No function found for address %s\n", toHex(offset).c_str());
+                newSet.push_back(access);
+                alreadyChecked.insert(offset);
+                continue;
+            }
+
+            std::string lowerName(funcName);
+            std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
+            // This assumes all string related functions contain 'str' or is stpcpy
+            if(lowerName.find("str") != std::string::npos || lowerName.find("stpcpy") != std::string::npos){
+                printf("String operation function found: %s\n", lowerName.c_str());
+                alreadyRemoved.insert(offset);
+            }
+            else{
+                newSet.push_back(access);
+                alreadyChecked.insert(offset);
+            }
+        }
+
+        newSet = removeUselessWrites(newSet);
+        if(newSet.size() > 0)
+            filtered.push_back(AccessGroup(group.first, std::move(newSet)));
+    }
+
+    report.partialOverlaps.swap(filtered);
+}
@@ -0,0 +1,45 @@
+#ifndef STRINGFILTER
+#define STRINGFILTER
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <stdint.h>
+
+#include "ParsedReport.h"
+
+// Native counterpart of python_modules/stringFilter.py.
+// Removes uninitialized reads performed by libc string functions (e.g. strcpy, strcmp...) from the partial
+// overlaps of a report. Unlike the python filter, the debug symbols file is never chosen interactively:
+// either it is explicitly provided, or the first file containing 'libc' in its name found in the usual
+// debug folders is used (falling back to the library itself).
+class StringFilter{
+    private:
+        struct FunctionSymbol{
+            uint64_t start;
+            uint64_t size;
+            std::string name;
+        };
+
+        std::string debugFile;
+        bool debugFileDetected;
+        // Symbols of every ELF file already loaded, in the same order as in its symbol table
+        std::map<std::string, std::vector<FunctionSymbol>> symbols;
+
+        // Offsets already known to belong (or not to belong) to a string function
+        std::set<uint64_t> alreadyRemoved;
+        std::set<uint64_t> alreadyChecked;
+
+        const std::string& findDebugPath(const std::string& libPath);
+        const std::vector<FunctionSymbol>& loadSymbols(const std::string& elfPath);
+        const char* findFunctionName(const std::string& elfPath, uint64_t offset);
+
+    public:
+        // If |debugFile| is not empty, it is used as the debug symbols file of libc
+        StringFilter(const std::string& debugFile);
+
+        void apply(ParsedReport& report);
+};
+
+#endif // STRINGFILTER
@@ -0,0 +1,257 @@
+// Native parser and merger of the binary reports written by MemTrace (see ReportFormat.h).
+// It produces the very same textual reports as bin/binOverlapParser.py (subcommand 'parse') and
+// bin/merge_reports.py (subcommand 'merge'), but maps the binary reports in memory instead of decoding them.
+// Reports written with the legacy format are not supported: in that case the tool exits with
+// EXIT_LEGACY_REPORT, so that the caller can fall back to the python scripts.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <fstream>
+#include <algorithm>
+#include <dirent.h>
+
+#include "MappedReport.h"
+#include "ParsedReport.h"
+#include "StringFilter.h"
+#include "ReportMerger.h"
+
+#define EXIT_LEGACY_REPORT 2
+
+using std::string;
+
+static void usage(const char* progName){
+    fprintf(stderr,
+        "Usage:\n"
+        "  %s parse [-a] [-d <report_dir>] [-i <actual_ip>]... [--disable-string-filter] [--debug-file <path>]\n"
+        "  %s merge [-a] [-q] [--into <lib> -i <offset>...]... [--disable-string-filter] [--debug-file <path>] <tracer_out_path>\n"
+        "\n"
+        "Options have the same meaning as the ones of binOverlapParser.py and merge_reports.py.\n"
+        "--debug-file allows to specify the debug symbols file of libc used by the string filter.\n"
+        "Exits with code %d if any report has been written with the legacy format.\n",
+        progName, progName, EXIT_LEGACY_REPORT);
+    exit(1);
+}
+
+static bool parseInteger(const string& s, int base, int64_t& ret){
+    const char* begin = s.c_str();
+    while(*begin == ' ' || *begin == '\t')
+        ++begin;
+
+    char* end;
+    errno = 0;
+    ret = strtoll(begin, &end, base);
+    if(end == begin || errno != 0)
+        return false;
+
+    while(*end == ' ' || *end == '\t')
+        ++end;
+    return *end == '\0';
+}
+
+// Same as |parse_addr| of bin/merge_reports.py: either an offset or a subtraction 'actualIp - baseAddress'
+static bool parseOffset(const string& s, uint64_t& ret){
+    size_t minus = s.find('-');
+    int64_t first;
+    if(minus == string::npos){
+        if(!parseInteger(s, 0, first))
+            return false;
+        ret = first;
+        return true;
+    }
+
+    int64_t second;
+    if(!parseInteger(s.substr(0, minus), 0, first) || !parseInteger(s.substr(minus + 1), 0, second))
+        return false;
+    ret = first - second;
+    return true;
+}
+
+static void writeLoadAddresses(std::ofstream& out, const ParsedReport& parsed){
+    out << "LOAD ADDRESSES:\n";
+    for(const LoadBase& lb : parsed.loadBases){
+        out << lb.first << " base address: " << toHex(lb.second) << "\n";
+    }
+    out << "Stack base address: " << toHex(parsed.stackBase) << "\n\n\n";
+}
+
+static void writeAccessGroups(std::ofstream& out, const std::vector<AccessGroup>& groups){
+    for(const AccessGroup& group : groups){
+        writeTableHeader(out, toHex(group.first->address) + " - " + std::to_string(group.first->size));
+
+        for(const AccessView& access : group.second){
+            out << access.toString() << "\n";
+        }
+
+        writeTableFooter(out);
+    }
+}
+
+static int parseReport(int argc, char** argv){
+    bool ignoreIfNoOverlap = true;
+    bool applyStringFilter = true;
+    string reportDir(".");
+    string debugFile;
+    std::set<uint64_t> ignoredAddresses;
+
+    for(int i = 2; i < argc; ++i){
+        string arg(argv[i]);
+        if(arg == "-a" || arg == "--all")
+            ignoreIfNoOverlap = false;
+        else if(arg == "--disable-string-filter")
+            applyStringFilter = false;
+        else if((arg == "-d" || arg == "--directory") && i + 1 < argc)
+            reportDir = argv[++i];
+        else if(arg == "--debug-file" && i + 1 < argc)
+            debugFile = argv[++i];
+        else if((arg == "-i" || arg == "--ignore") && i + 1 < argc){
+            int64_t addr;
+            if(!parseInteger(argv[++i], 16, addr)){
+                fprintf(stderr, "Not valid address: %s\n", argv[i]);
+                return 1;
+            }
+            ignoredAddresses.insert(addr);
+        }
+        else
+            usage(argv[0]);
+    }
+
+    MappedReport report;
+    if(!report.open(reportDir + "/overlaps.bin")){
+        fprintf(stderr, "%s\n", report.getError().c_str());
+        return report.isLegacy() ? EXIT_LEGACY_REPORT : 1;
+    }
+
+    ParsedReport parsed(report, ignoreIfNoOverlap, ignoredAddresses);
+    if(applyStringFilter){
+        printf("Applying filter...\n");
+        StringFilter filter(debugFile);
+        filter.apply(parsed);
+    }
+
+    std::ofstream fo("overlaps.log");
+    std::ofstream po("partialOverlaps.log");
+    if(!fo || !po){
+        fprintf(stderr, "Can't create textual reports\n");
+        return 1;
+    }
+
+    if(!parsed.fullOverlaps.empty()){
+        fo << "ENTRY FORMAT: \n[*]<binaryIP> (<actualIP>): [<assembly_instr>] {R/W} <access_size> B @ "
+            "(sp {+/-} <sp_relative_offset>); (bp {+/-} <bp_relative_offset>) "
+            "['['<uninitialized_lower_bound> ~ <uninitialized_upper_bound>']']\n\n\n";
+        writeLoadAddresses(fo, parsed);
+    }
+    else
+        fo << "** NO OVERLAPS DETECTED **\n";
+
+    if(!parsed.partialOverlaps.empty())
+        writeLoadAddresses(po, parsed);
+    else
+        po << "** NO OVERLAPS DETECTED **\n";
+
+    writeAccessGroups(fo, parsed.fullOverlaps);
+    writeAccessGroups(po, parsed.partialOverlaps);
+
+    printf("Finished parsing binary file. Textual reports created\n");
+    return 0;
+}
+
+static std::vector<string> listDirectory(const string& path){
+    std::vector<string> ret;
+    DIR* dir = opendir(path.c_str());
+    if(dir == NULL)
+        return ret;
+
+    struct dirent* entry;
+    while((entry = readdir(dir)) != NULL){
+        if(strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+            ret.push_back(entry->d_name);
+    }
+    closedir(dir);
+
+    return ret;
+}
+
+static int mergeReports(int argc, char** argv){
+    bool ignoreIfNoOverlap = true;
+    bool applyStringFilter = true;
+    bool reportUniqueAccessSets = false;
+    string debugFile;
+    string tracerOutPath;
+    const char* lib = NULL;
+    std::map<string, std::set<uint64_t>> ignoredAddresses;
+
+    for(int i = 2; i < argc; ++i){
+        string arg(argv[i]);
+        if(arg == "-a" || arg == "--all")
+            ignoreIfNoOverlap = false;
+        else if(arg == "-q" || arg == "--unique-access-sets")
+            reportUniqueAccessSets = true;
+        else if(arg == "--disable-string-filter")
+            applyStringFilter = false;
+        else if(arg == "--debug-file" && i + 1 < argc)
+            debugFile = argv[++i];
+        else if(arg == "--into" && i + 1 < argc)
+            lib = argv[++i];
+        else if((arg == "-i" || arg == "--ignore") && i + 1 < argc){
+            uint64_t offset;
+            if(lib == NULL){
+                fprintf(stderr, "No library specified before option --ignore\n");
+                return 1;
+            }
+            if(!parseOffset(argv[++i], offset)){
+                fprintf(stderr, "Not valid address: %s\n", argv[i]);
+                return 1;
+            }
+            ignoredAddresses[lib].insert(offset);
+        }
+        else if(tracerOutPath.empty() && arg[0] != '-')
+            tracerOutPath = arg;
+        else
+            usage(argv[0]);
+    }
+
+    if(tracerOutPath.empty())
+        usage(argv[0]);
+
+    StringFilter filter(debugFile);
+    ReportMerger merger(ignoreIfNoOverlap, applyStringFilter ? &filter : NULL);
+
+    for(const string& instance : listDirectory(tracerOutPath)){
+        string instancePath = tracerOutPath + "/" + instance;
+        for(const string& inputDir : listDirectory(instancePath)){
+            if(merger.addInput(instance + "/" + inputDir, instancePath + "/" + inputDir) == ReportMerger::LEGACY){
+                fprintf(stderr, "%s/%s/overlaps.bin has been written with the legacy report format\n", instancePath.c_str(), inputDir.c_str());
+                return EXIT_LEGACY_REPORT;
+            }
+        }
+    }
+
+    merger.removeIgnored(ignoredAddresses);
+
+    printf("Generating textual report...\n");
+    if(!merger.writeBaseAddresses("base_addresses.log") || !merger.writePartialOverlaps("partialOverlaps.log", reportUniqueAccessSets)){
+        fprintf(stderr, "Can't create textual reports\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv){
+    if(argc < 2)
+        usage(argv[0]);
+
+    if(strcmp(argv[1], "parse") == 0)
+        return parseReport(argc, argv);
+    if(strcmp(argv[1], "merge") == 0)
+        return mergeReports(argc, argv);
+
+    usage(argv[0]);
+}
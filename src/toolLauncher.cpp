@@ -4,9 +4,16 @@
 #include <unistd.h>
 #include <cstring>
 #include <errno.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+
+#include "ResultCache.h"
 
 extern char** environ;
 
+static pid_t tracerPid = -1;
+
 char** append_args(char** cmd, char** args){
 	unsigned index = 3;
 	char** args_index = args;
@@ -19,6 +26,59 @@ char** append_args(char** cmd, char** args){
 	return cmd;
 }
 
+// Removes option --cache-dir (which is handled by the launcher itself) from the knobs of the tool.
+// Returns the cache directory, or NULL if the option is not present.
+char* extract_cache_dir(int* argc, char** argv){
+	char* cacheDir = NULL;
+	int i = 1;
+
+	while(i < *argc && strcmp(argv[i], "--") != 0){
+		if(strcmp(argv[i], "--cache-dir") == 0 && i + 1 < *argc){
+			cacheDir = argv[i + 1];
+			memmove(&argv[i], &argv[i + 2], sizeof(char*) * (*argc - i - 1));
+			*argc -= 2;
+			continue;
+		}
+		++i;
+	}
+
+	return cacheDir;
+}
+
+void forward_signal(int sig){
+	if(tracerPid > 0)
+		kill(tracerPid, sig);
+}
+
+// Runs Intel PIN as a child process (instead of replacing the launcher), so that its report can be cached
+// once it terminates. Returns the wait status of PIN, or -1 if it can't be launched.
+int run_tracer(char* executable, char** cmd){
+	tracerPid = fork();
+	if(tracerPid < 0)
+		return -1;
+
+	if(tracerPid == 0){
+		// Whoever launched the tracer only knows the pid of the launcher: if it gets killed, kill the tracer too
+		prctl(PR_SET_PDEATHSIG, SIGKILL);
+		execve(executable, cmd, environ);
+		printf("%s\n", "Execve failed");
+		printf("Error: %s\n", strerror(errno));
+		_exit(127);
+	}
+
+	signal(SIGTERM, forward_signal);
+	signal(SIGINT, forward_signal);
+	signal(SIGHUP, forward_signal);
+
+	int status;
+	while(waitpid(tracerPid, &status, 0) < 0){
+		if(errno != EINTR)
+			return -1;
+	}
+
+	return status;
+}
+
 int main(int argc, char** argv) {
 	#ifndef PIN_ROOT
 		fprintf(stderr, "Unknown Intel PIN root directory path");
@@ -30,7 +90,7 @@ int main(int argc, char** argv) {
 		exit(2);
 	#endif
 
-	char** args = argv;
+	char* cacheDir = extract_cache_dir(&argc, argv);
 	if(argc < 2){
 		fprintf(stderr, "Specify program to launch\n");
 		return 2;
@@ -59,6 +119,34 @@ int main(int argc, char** argv) {
 
 	char** cmd = append_args(new_argv, &argv[1]);
 
+	if(cacheDir != NULL){
+		ResultCache cache(cacheDir);
+		if(cache.computeKey(toolPath, &argv[1], environ)){
+			if(cache.restore()){
+				printf("Report restored from cache (key %s)\n", cache.getKey().c_str());
+				return 0;
+			}
+
+			int status = run_tracer(executable, cmd);
+			if(status == -1){
+				printf("Error: %s\n", strerror(errno));
+				return 1;
+			}
+
+			// Incomplete reports of tracers killed by a signal (e.g. because of a timeout) or stopped by an execution
+			// budget are not cached
+			if(WIFEXITED(status)){
+				if(cache.isReportTruncated())
+					printf("Incomplete report: not stored in cache\n");
+				else if(!cache.store())
+					fprintf(stderr, "Can't store the report in cache directory %s\n", cacheDir);
+				return WEXITSTATUS(status);
+			}
+
+			return 128 + WTERMSIG(status);
+		}
+	}
+
 	execve(executable, cmd, environ);
 	printf("%s\n", "Execve failed");
 	printf("Error: %s\n", strerror(errno));
@@ -0,0 +1,450 @@
+// Native dispatcher of the tracer processes launched by bin/memTracer.py.
+// It watches the directories where the fuzzer instances store their inputs (through inotify) and keeps a bounded pool
+// of tracer processes busy with the jobs it receives from the launcher script. Terminated processes are detected through
+// pidfds and stuck ones are killed when their timerfd expires, so that nothing is ever polled.
+//
+// Protocol (see python_modules/nativeDispatcher.py):
+//  - once ready, the dispatcher writes "READY\n" on stdout. If it exits before that, the caller should fall back
+//    to its own implementation (e.g. the kernel does not support pidfds).
+//  - every file written in a watched directory (and every file already there at startup) is notified on stdout
+//    with a line "INPUT\t<instance>\t<path>\n".
+//  - jobs are read from stdin. Each job is a sequence of nul-terminated fields:
+//    <argc> <stdin path> <output path> <environment file> <argv[0]> ... <argv[argc - 1]>
+//    Empty paths mean, respectively, /dev/null, /dev/null and the environment of the dispatcher. The environment
+//    file contains a KEY=VALUE pair on each line.
+//  - when stdin is closed, the dispatcher stops watching directories, waits for every queued job to terminate and exits.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+#include <fstream>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/timerfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+// Grace period given to a timed out process between SIGTERM and SIGKILL
+#define KILL_GRACE_PERIOD 5
+
+using std::string;
+using std::vector;
+
+extern char** environ;
+
+struct Job{
+    string stdinPath;
+    string outputPath;
+    string envPath;
+    vector<string> argv;
+};
+
+struct Worker{
+    pid_t pid;
+    int pidFd;
+    int timerFd;
+    bool terminated;
+};
+
+enum EventSource{
+    JOBS_SOURCE,
+    INOTIFY_SOURCE,
+    PID_SOURCE,
+    TIMER_SOURCE,
+    OUTPUT_SOURCE
+};
+
+static int epollFd;
+static int inotifyFd = -1;
+static unsigned maxWorkers = 1;
+static unsigned timeout = 0;
+// Watch descriptor => (instance name, watched directory)
+static std::map<int, std::pair<string, string>> watches;
+static std::set<string> notifiedPaths;
+static std::deque<Job> pendingJobs;
+// Workers indexed by both their pidfd and their timerfd
+static std::map<int, Worker*> workers;
+static unsigned runningWorkers = 0;
+// Notifications not written yet. Stdout is non-blocking, so that the dispatcher never stops reading jobs
+// while the launcher script is busy writing them
+static string pendingOutput;
+static bool waitingOutput = false;
+
+static void usage(const char* progName){
+    fprintf(stderr, "Usage: %s [-j <processes>] [-t <timeout_seconds>] [--watch <instance> <directory>]...\n", progName);
+    exit(1);
+}
+
+static int pidfdOpen(pid_t pid){
+    return syscall(SYS_pidfd_open, pid, 0);
+}
+
+static void addToEpoll(int fd, EventSource source, uint32_t events = EPOLLIN){
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.u64 = ((uint64_t) source << 32) | (uint32_t) fd;
+    if(epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0){
+        perror("epoll_ctl");
+        exit(1);
+    }
+}
+
+static void flushOutput(){
+    while(!pendingOutput.empty()){
+        ssize_t written = write(STDOUT_FILENO, pendingOutput.data(), pendingOutput.size());
+        if(written < 0){
+            if(errno == EINTR)
+                continue;
+            if(errno != EAGAIN){
+                // The launcher script is not listening anymore
+                pendingOutput.clear();
+                break;
+            }
+
+            if(!waitingOutput){
+                addToEpoll(STDOUT_FILENO, OUTPUT_SOURCE, EPOLLOUT);
+                waitingOutput = true;
+            }
+            return;
+        }
+
+        pendingOutput.erase(0, written);
+    }
+
+    if(waitingOutput){
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, STDOUT_FILENO, NULL);
+        waitingOutput = false;
+    }
+}
+
+static void notifyInput(const string& instance, const string& path){
+    if(!notifiedPaths.insert(path).second)
+        return;
+
+    pendingOutput += "INPUT\t" + instance + "\t" + path + "\n";
+}
+
+static void addWatch(const string& instance, const string& directory){
+    int wd = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if(wd < 0){
+        fprintf(stderr, "[Dispatcher] Can't watch %s: %s\n", directory.c_str(), strerror(errno));
+        return;
+    }
+    watches[wd] = std::make_pair(instance, directory);
+
+    // Files written before the watch was added
+    DIR* dir = opendir(directory.c_str());
+    if(dir == NULL)
+        return;
+
+    struct dirent* entry;
+    while((entry = readdir(dir)) != NULL){
+        if(entry->d_type != DT_DIR)
+            notifyInput(instance, directory + "/" + entry->d_name);
+    }
+    closedir(dir);
+}
+
+static void readInotifyEvents(){
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t len = read(inotifyFd, buffer, sizeof(buffer));
+    if(len <= 0)
+        return;
+
+    for(char* ptr = buffer; ptr < buffer + len; ptr += sizeof(struct inotify_event) + ((struct inotify_event*) ptr)->len){
+        struct inotify_event* event = (struct inotify_event*) ptr;
+        auto watch = watches.find(event->wd);
+        if(watch == watches.end() || event->len == 0 || (event->mask & IN_ISDIR))
+            continue;
+
+        notifyInput(watch->second.first, watch->second.second + "/" + event->name);
+    }
+}
+
+static vector<string> readEnvironment(const string& path){
+    vector<string> ret;
+    std::ifstream envFile(path);
+    string line;
+    while(std::getline(envFile, line)){
+        if(!line.empty())
+            ret.push_back(line);
+    }
+
+    return ret;
+}
+
+static void redirect(const string& path, int flags, int fd){
+    int newFd = open(path.empty() ? "/dev/null" : path.c_str(), flags, 0644);
+    if(newFd < 0){
+        fprintf(stderr, "[Dispatcher] Can't open %s: %s\n", path.c_str(), strerror(errno));
+        _exit(127);
+    }
+    dup2(newFd, fd);
+    close(newFd);
+}
+
+static void startJob(const Job& job){
+    // Everything that requires memory allocation is done before forking
+    vector<string> env = job.envPath.empty() ? vector<string>() : readEnvironment(job.envPath);
+    vector<char*> argv;
+    for(const string& arg : job.argv){
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(NULL);
+
+    vector<char*> envp;
+    for(const string& var : env){
+        envp.push_back(const_cast<char*>(var.c_str()));
+    }
+    envp.push_back(NULL);
+
+    pid_t pid = fork();
+    if(pid < 0){
+        perror("fork");
+        return;
+    }
+
+    if(pid == 0){
+        signal(SIGPIPE, SIG_DFL);
+        redirect(job.stdinPath, O_RDONLY, STDIN_FILENO);
+        redirect(job.outputPath, O_WRONLY | O_CREAT | O_TRUNC, STDOUT_FILENO);
+        dup2(STDOUT_FILENO, STDERR_FILENO);
+        execve(argv[0], argv.data(), job.envPath.empty() ? environ : envp.data());
+        fprintf(stderr, "Exception happened while launching the tracer\nExecve failed: %s\n", strerror(errno));
+        _exit(127);
+    }
+
+    Worker* worker = new Worker();
+    worker->pid = pid;
+    worker->terminated = false;
+    worker->pidFd = pidfdOpen(pid);
+    worker->timerFd = -1;
+    if(worker->pidFd < 0){
+        // Can't happen for a child which has not been reaped yet, unless the kernel does not support pidfds,
+        // which has already been checked at startup
+        perror("pidfd_open");
+        exit(1);
+    }
+    workers[worker->pidFd] = worker;
+    addToEpoll(worker->pidFd, PID_SOURCE);
+
+    if(timeout != 0){
+        worker->timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+        struct itimerspec expiration;
+        memset(&expiration, 0, sizeof(expiration));
+        expiration.it_value.tv_sec = timeout;
+        timerfd_settime(worker->timerFd, 0, &expiration, NULL);
+        workers[worker->timerFd] = worker;
+        addToEpoll(worker->timerFd, TIMER_SOURCE);
+    }
+
+    ++runningWorkers;
+}
+
+static void startPendingJobs(){
+    while(runningWorkers < maxWorkers && !pendingJobs.empty()){
+        startJob(pendingJobs.front());
+        pendingJobs.pop_front();
+    }
+}
+
+static void reapWorker(int pidFd){
+    auto found = workers.find(pidFd);
+    if(found == workers.end())
+        return;
+
+    Worker* worker = found->second;
+    int status;
+    while(waitpid(worker->pid, &status, 0) < 0 && errno == EINTR);
+
+    workers.erase(worker->pidFd);
+    close(worker->pidFd);
+    if(worker->timerFd >= 0){
+        workers.erase(worker->timerFd);
+        close(worker->timerFd);
+    }
+    delete worker;
+    --runningWorkers;
+}
+
+static void timeoutExpired(int timerFd){
+    auto found = workers.find(timerFd);
+    if(found == workers.end())
+        return;
+
+    uint64_t expirations;
+    if(read(timerFd, &expirations, sizeof(expirations)) < 0)
+        return;
+
+    Worker* worker = found->second;
+    if(worker->terminated){
+        kill(worker->pid, SIGKILL);
+        return;
+    }
+
+    fprintf(stderr, "[Dispatcher] Process %d was stuck. It has been terminated.\n", worker->pid);
+    kill(worker->pid, SIGTERM);
+    worker->terminated = true;
+
+    struct itimerspec expiration;
+    memset(&expiration, 0, sizeof(expiration));
+    expiration.it_value.tv_sec = KILL_GRACE_PERIOD;
+    timerfd_settime(timerFd, 0, &expiration, NULL);
+}
+
+// Returns false when stdin has been closed
+static bool readJobs(string& buffer){
+    char chunk[4096];
+    ssize_t len = read(STDIN_FILENO, chunk, sizeof(chunk));
+    if(len < 0)
+        return errno == EINTR || errno == EAGAIN;
+    if(len == 0)
+        return false;
+
+    buffer.append(chunk, len);
+
+    while(true){
+        vector<string> fields;
+        size_t begin = 0;
+        size_t expected = 1;
+        while(fields.size() < expected){
+            size_t end = buffer.find('\0', begin);
+            if(end == string::npos)
+                break;
+
+            fields.push_back(buffer.substr(begin, end - begin));
+            begin = end + 1;
+            if(fields.size() == 1)
+                expected = 4 + strtoul(fields[0].c_str(), NULL, 10);
+        }
+
+        if(fields.size() < expected)
+            return true;
+
+        buffer.erase(0, begin);
+        if(expected == 4){
+            fprintf(stderr, "[Dispatcher] Ignoring job without command\n");
+            continue;
+        }
+
+        Job job;
+        job.stdinPath = fields[1];
+        job.outputPath = fields[2];
+        job.envPath = fields[3];
+        job.argv.assign(fields.begin() + 4, fields.end());
+        pendingJobs.push_back(job);
+    }
+}
+
+int main(int argc, char** argv){
+    vector<std::pair<string, string>> watched;
+
+    for(int i = 1; i < argc; ++i){
+        string arg(argv[i]);
+        if(arg == "-j" && i + 1 < argc)
+            maxWorkers = strtoul(argv[++i], NULL, 10);
+        else if(arg == "-t" && i + 1 < argc)
+            timeout = strtoul(argv[++i], NULL, 10);
+        else if(arg == "--watch" && i + 2 < argc){
+            watched.push_back(std::make_pair(string(argv[i + 1]), string(argv[i + 2])));
+            i += 2;
+        }
+        else
+            usage(argv[0]);
+    }
+
+    if(maxWorkers == 0)
+        usage(argv[0]);
+
+    // Check pidfds are supported before accepting any job
+    int selfFd = pidfdOpen(getpid());
+    if(selfFd < 0){
+        fprintf(stderr, "[Dispatcher] pidfd_open not supported: %s\n", strerror(errno));
+        return 2;
+    }
+    close(selfFd);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    inotifyFd = inotify_init1(IN_CLOEXEC);
+    if(epollFd < 0 || inotifyFd < 0){
+        perror("[Dispatcher] Initialization failed");
+        return 2;
+    }
+
+    printf("READY\n");
+    fflush(stdout);
+    signal(SIGPIPE, SIG_IGN);
+    fcntl(STDOUT_FILENO, F_SETFL, fcntl(STDOUT_FILENO, F_GETFL) | O_NONBLOCK);
+
+    addToEpoll(STDIN_FILENO, JOBS_SOURCE);
+    addToEpoll(inotifyFd, INOTIFY_SOURCE);
+    for(auto& watch : watched){
+        addWatch(watch.first, watch.second);
+    }
+    flushOutput();
+
+    string jobsBuffer;
+    bool acceptingJobs = true;
+    while(acceptingJobs || runningWorkers > 0){
+        struct epoll_event events[64];
+        int count = epoll_wait(epollFd, events, 64, -1);
+        if(count < 0){
+            if(errno == EINTR)
+                continue;
+            perror("epoll_wait");
+            return 1;
+        }
+
+        for(int i = 0; i < count; ++i){
+            EventSource source = (EventSource) (events[i].data.u64 >> 32);
+            int fd = (int) (uint32_t) events[i].data.u64;
+
+            switch(source){
+                case JOBS_SOURCE:
+                    if(!readJobs(jobsBuffer)){
+                        acceptingJobs = false;
+                        epoll_ctl(epollFd, EPOLL_CTL_DEL, STDIN_FILENO, NULL);
+                        epoll_ctl(epollFd, EPOLL_CTL_DEL, inotifyFd, NULL);
+                        close(inotifyFd);
+                        inotifyFd = -1;
+                    }
+                    break;
+                case INOTIFY_SOURCE:
+                    if(inotifyFd >= 0)
+                        readInotifyEvents();
+                    break;
+                case PID_SOURCE:
+                    reapWorker(fd);
+                    break;
+                case TIMER_SOURCE:
+                    timeoutExpired(fd);
+                    break;
+                case OUTPUT_SOURCE:
+                    break;
+            }
+        }
+
+        flushOutput();
+
+        // New processes are started only after every event has been handled, so that the file descriptors
+        // of the terminated ones can't be reused while some of their events are still pending
+        startPendingJobs();
+    }
+
+    return 0;
+}
@@ -1,5 +1,4 @@
 #include <vector>
-#include <unordered_map>
 #include <string.h>
 
 // Headers required to have definitions of some required structs
@@ -24,12 +23,11 @@
 
 #include "SyscallMemAccess.h"
 
-#define RETTYPE static set<SyscallMemAccess>
-#define ARGUMENTS (ADDRINT retVal, vector<ADDRINT> args)
+// Handlers insert the memory accesses performed by the system call into |ret|
+#define RETTYPE static void
+#define ARGUMENTS (ADDRINT retVal, const ADDRINT* args, SyscallEffects& ret)
 
 using std::vector;
-using std::unordered_map;
-using std::pair;
 
 
 /////////////////////////////////////////////////////////////////
@@ -40,57 +38,49 @@ using std::pair;
 //  it, just add it to the HandlerSelector class below         //
 //  (instructions below).                                      //
 //  If you just need to modify an handler, just modify it,     //
-//  nothing else is needed.                                    //      
+//  nothing else is needed.                                    //
+//  A handler can delegate to another one by passing it an     //
+//  array of adjusted arguments and its own |ret| buffer.      //
 /////////////////////////////////////////////////////////////////
 
 
 RETTYPE sys_read_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0){
-        return ret;
+        return;
     }
     SyscallMemAccess ma(args[1], retVal, AccessType::WRITE);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_write_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0){
-        return ret;
+        return;
     }
     SyscallMemAccess ma(args[1], retVal, AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_pread_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0){
-        return ret;
+        return;
     }
     SyscallMemAccess ma(args[1], retVal, AccessType::WRITE);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_pwrite_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0){
-        return ret;
+        return;
     }
     SyscallMemAccess ma(args[1], retVal, AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 // NOTE: THE NEXT 2 SYSCALLS ARE USED TO HANDLE OTHER SYSCALLS, AS THEY HAVE THE SAME EFFECT.
 // CHANGES TO THEM WILL AFFECT THE HANDLING OF THOSE SYSTEM CALLS AS WELL.
 RETTYPE sys_readv_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
-
     if((long long) retVal < 0){
-        return ret;
+        return;
     }
 
     const struct iovec* bufs = (struct iovec*) args[1];
@@ -109,14 +99,11 @@ RETTYPE sys_readv_handler ARGUMENTS{
         ret.insert(vecAccess);
         ret.insert(bufAccess);
     }
-    return ret;
 }
 
 RETTYPE sys_writev_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
-
     if((long long) retVal < 0){
-        return ret;
+        return;
     }
 
     const struct iovec* bufs = (struct iovec*) args[1];
@@ -135,46 +122,40 @@ RETTYPE sys_writev_handler ARGUMENTS{
         ret.insert(vecAccess);
         ret.insert(bufAccess);
     }
-    return ret;
 }
 
 RETTYPE sys_readlink_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0){
-        return ret;
+        return;
     }
     const char* pathname = (char*) args[0];
     SyscallMemAccess pathMA(args[0], strlen(pathname), AccessType::READ);
     SyscallMemAccess ma(args[1], retVal, AccessType::WRITE);
     ret.insert(pathMA);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_readlinkat_handler ARGUMENTS{
-    vector<ADDRINT> readlink_args;
-    readlink_args.push_back(args[1]);
-    readlink_args.push_back(args[2]);
-    readlink_args.push_back(args[3]);
-    return sys_readlink_handler(retVal, readlink_args);
+    ADDRINT readlink_args[] = {args[1], args[2], args[3]};
+    return sys_readlink_handler(retVal, readlink_args, ret);
 }
 
 // The next 2 syscalls have 1 additional argument w.r.t. readv/writev, but it is added as a 4th argument. Arguments at index 0, 1 and 2
 // (those interesting to detect memory read/write) are the same.
 RETTYPE sys_preadv_handler ARGUMENTS{
-    return sys_readv_handler(retVal, args);
+    return sys_readv_handler(retVal, args, ret);
 }
 
 RETTYPE sys_pwritev_handler ARGUMENTS{
-    return sys_writev_handler(retVal, args);
+    return sys_writev_handler(retVal, args, ret);
 }
 
 RETTYPE sys_preadv2_handler ARGUMENTS{
-    return sys_preadv_handler(retVal, args);
+    return sys_preadv_handler(retVal, args, ret);
 }
 
 RETTYPE sys_pwritev2_handler ARGUMENTS{
-    return sys_pwritev_handler(retVal, args);
+    return sys_pwritev_handler(retVal, args, ret);
 }
 
 // The next 2 syscalls transfer data between 2 processes address spaces. Since our tool is thought to detect overlaps
@@ -183,33 +164,26 @@ RETTYPE sys_pwritev2_handler ARGUMENTS{
 RETTYPE sys_process_vm_readv_handler ARGUMENTS{
     // This syscall has the same effect (locally) of readv. So, just call readv handler after having adjusted
     // syscall arguments to fit readv arguments.
-    vector<ADDRINT> readv_args;
     // First argument is the fd of the file to read from. In this case, there's no fd, so just set it to 0
     // In any case, it is not useful to keep track of read/written memory areas.
-    readv_args.push_back(0);
-    readv_args.push_back((ADDRINT) args[1]);
-    readv_args.push_back((ADDRINT) args[2]);
-    return sys_readv_handler(retVal, readv_args);
+    ADDRINT readv_args[] = {0, (ADDRINT) args[1], (ADDRINT) args[2]};
+    return sys_readv_handler(retVal, readv_args, ret);
 }
 
 RETTYPE sys_process_vm_writev_handler ARGUMENTS{
     // This syscall has the same effect (locally) of readv. So, just call readv handler after having adjusted
     // syscall arguments to fit readv arguments.
-    vector<ADDRINT> writev_args;
     // First argument is the fd of the file to read from. In this case, there's no fd, so just set it to 0
     // In any case, it is not useful to keep track of read/written memory areas.
-    writev_args.push_back(0);
-    writev_args.push_back((ADDRINT) args[1]);
-    writev_args.push_back((ADDRINT) args[2]);
-    return sys_writev_handler(retVal, writev_args);
+    ADDRINT writev_args[] = {0, (ADDRINT) args[1], (ADDRINT) args[2]};
+    return sys_writev_handler(retVal, writev_args, ret);
 }
 
 // NOTE: THIS SYSCALL IS USED AS A HANDLER FOR OTHER SYSCALLS HAVING THE SAME MEMORY BEHAVIOUR.
 // ANY MODIFICATION TO THIS HANDLER WILL AFFECT THOSE SYSCALLS AS WELL
 RETTYPE sys_stat_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0){
-        return ret;
+        return;
     }
     const char* pathname = (char*) args[0];
 
@@ -217,124 +191,103 @@ RETTYPE sys_stat_handler ARGUMENTS{
     SyscallMemAccess ma(args[1], sizeof(struct stat), AccessType::WRITE);
     ret.insert(pathMA);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_fstat_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0){
-        return ret;
+        return;
     }
     SyscallMemAccess ma(args[1], sizeof(struct stat), AccessType::WRITE);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_lstat_handler ARGUMENTS{
-    return sys_stat_handler(retVal, args);
+    return sys_stat_handler(retVal, args, ret);
 }
 
 RETTYPE sys_fstatat_handler ARGUMENTS{
-    vector<ADDRINT> stat_args;
-    stat_args.push_back(args[1]);
-    stat_args.push_back(args[2]);
-    return sys_stat_handler(retVal, stat_args);
+    ADDRINT stat_args[] = {args[1], args[2]};
+    return sys_stat_handler(retVal, stat_args, ret);
 }
 
 
 // NOTE: THIS SYSCALL HAS BEEN USED TO HANDLE OTHER SIMILAR SYSCALLS.
 // ANY MODIFICATION TO THIS HANDLER WILL AFFECT THOSE SYSCALLS AS WELL
 RETTYPE sys_open_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0){
-        return ret;
+        return;
     }
     const char* pathname = (char*) args[0];
     SyscallMemAccess ma(args[0], strlen(pathname), AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_creat_handler ARGUMENTS{
     // As 'open', this syscall simply reads the pathname from args[0].
     // Delegate to sys_open_handler.
-    return sys_open_handler(retVal, args);
+    return sys_open_handler(retVal, args, ret);
 }
 
 RETTYPE sys_openat_handler ARGUMENTS{
     // Works as 'open'. Adjust args vector and delegate to sys_open_handler.
-    vector<ADDRINT> open_args;
-    open_args.push_back(args[1]);
-    open_args.push_back(args[2]);
-    open_args.push_back(args[3]);
-    return sys_open_handler(retVal, open_args);
+    ADDRINT open_args[] = {args[1], args[2], args[3]};
+    return sys_open_handler(retVal, open_args, ret);
 }
 
 // NOTE: THIS SYSCALL HANDLER HAS BEEN USED TO HANDLE OTHER SIMILAR SYSCALLS.
 // ANY MODIFICATION TO THIS HANDLER WILL AFFECT THOSE SYSCALLS AS WELL.
 RETTYPE sys_access_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     const char* pathname = (char*) args[0];
     SyscallMemAccess ma(args[0], strlen(pathname), AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_faccessat_handler ARGUMENTS{
     // Works as 'access'. Adjust args vector and delegate to sys_access_handler.
-    vector<ADDRINT> access_args;
-    access_args.push_back(args[1]);
-    access_args.push_back(args[2]);
-    return sys_access_handler(retVal, access_args);
+    ADDRINT access_args[] = {args[1], args[2]};
+    return sys_access_handler(retVal, access_args, ret);
 }
 
 RETTYPE sys_pipe_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0){
-        return ret;
+        return;
     }
     SyscallMemAccess ma(args[0], 2 * sizeof(int), AccessType::WRITE);;
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_pipe2_handler ARGUMENTS{
     // Works as 'pipe'. Delegate to sys_pipe_handler.
-    return sys_pipe_handler(retVal, args);
+    return sys_pipe_handler(retVal, args, ret);
 }
 
 RETTYPE sys_connect_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     SyscallMemAccess ma(args[1], args[2], AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 // NOTE: THIS HANDLER IS USED TO HANDLE OTHER SYSCALLS.
 // ANY MODIFICATION TO THIS HANDLER WILL AFFECT THOSE SYSCALLS AS WELL
 RETTYPE sys_accept_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     socklen_t* addrLen = (socklen_t*) args[2];
     SyscallMemAccess ma(args[1], *addrLen, AccessType::WRITE);
     SyscallMemAccess addrLenMA(args[2], sizeof(socklen_t), AccessType::WRITE);
     ret.insert(ma);
     ret.insert(addrLenMA);
-    return ret;
 }
 
 RETTYPE sys_accept4_handler ARGUMENTS{
     // Works as accept. Delegate to sys_accept_handler.
-    return sys_accept_handler(retVal, args);
+    return sys_accept_handler(retVal, args, ret);
 }
 
 RETTYPE sys_recvfrom_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     SyscallMemAccess bufMA(args[1], retVal, AccessType::WRITE);
     ret.insert(bufMA);
     struct sockaddr* src_addr = (struct sockaddr*)args[4];
@@ -345,13 +298,11 @@ RETTYPE sys_recvfrom_handler ARGUMENTS{
         ret.insert(addrMA);
         ret.insert(addrLenMA);
     }
-    return ret;
 }
 
 RETTYPE sys_recvmsg_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     struct msghdr* msg = (struct msghdr*) args[1];
     SyscallMemAccess msghdrMA(args[1], sizeof(struct msghdr), AccessType::READ);
     struct iovec* msg_vec = (struct iovec*) msg->msg_iov;
@@ -360,42 +311,30 @@ RETTYPE sys_recvmsg_handler ARGUMENTS{
     // This syscalls behaves exactly as readv for msg_vec. Adjust args vector and retrieve written buffers from sys_readv_handler.
     // Note that the first argument of readv is a fd. However that's not useful to register
     // memory operations. Just set it to 0.
-    vector<ADDRINT> readv_args;
-    readv_args.push_back(0);
-    readv_args.push_back((ADDRINT) msg_vec);
-    readv_args.push_back((ADDRINT) msg_iovlen);
-    set<SyscallMemAccess> readvResult = sys_readv_handler(retVal, readv_args);
+    ADDRINT readv_args[] = {0, (ADDRINT) msg_vec, (ADDRINT) msg_iovlen};
+    sys_readv_handler(retVal, readv_args, ret);
 
     ret.insert(msghdrMA);
-    ret.insert(readvResult.begin(), readvResult.end());
-    return ret;
 }
 
 RETTYPE sys_recvmmsg_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
 
     unsigned int vlen = (unsigned int) args[2];
     struct mmsghdr* msgvec = (struct mmsghdr*) args[1];
     for(unsigned int i = 0; i < vlen; ++i, ++msgvec){
         SyscallMemAccess arrMA((ADDRINT)msgvec, sizeof(struct mmsghdr), AccessType::READ);
         // For each msg header, get the corresponding memory operations from sys_recvmsg_handler.
-        vector<ADDRINT> recvmsg_args;
-        recvmsg_args.push_back(args[0]);
-        recvmsg_args.push_back((ADDRINT) msgvec);
-        recvmsg_args.push_back(args[3]);
-        set<SyscallMemAccess> recvmsgResult = sys_recvmsg_handler(msgvec->msg_len, recvmsg_args);
-        ret.insert(recvmsgResult.begin(), recvmsgResult.end());
+        ADDRINT recvmsg_args[] = {args[0], (ADDRINT) msgvec, args[3]};
+        sys_recvmsg_handler(msgvec->msg_len, recvmsg_args, ret);
         ret.insert(arrMA);
     }
-    return ret;
 }
 
 RETTYPE sys_sendto_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     SyscallMemAccess bufMA(args[1], retVal, AccessType::READ);
     ret.insert(bufMA);
     const struct sockaddr* dest_addr = (struct sockaddr*) args[4];
@@ -403,13 +342,11 @@ RETTYPE sys_sendto_handler ARGUMENTS{
         SyscallMemAccess addrMA(args[4], args[5], AccessType::READ);
         ret.insert(addrMA);
     }
-    return ret;
 }
 
 RETTYPE sys_sendmsg_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     const struct msghdr* msg = (struct msghdr*) args[1];
     SyscallMemAccess msgMA(args[1], sizeof(struct msghdr), AccessType::READ);
     ret.insert(msgMA);
@@ -419,92 +356,70 @@ RETTYPE sys_sendmsg_handler ARGUMENTS{
     // This syscalls behaves exactly as writev for msg_vec. Adjust args vector and retrieve read buffers from sys_readv_handler.
     // Note that the first argument of readv is a fd. However that's not useful to register
     // memory operations. Just set it to 0.
-    vector<ADDRINT> writev_args;
-    writev_args.push_back(0);
-    writev_args.push_back((ADDRINT) msg_vec);
-    writev_args.push_back((ADDRINT) msg_iovlen);
-    set<SyscallMemAccess> writevResult = sys_writev_handler(retVal, writev_args);
-    ret.insert(writevResult.begin(), writevResult.end());
-    return ret;
+    ADDRINT writev_args[] = {0, (ADDRINT) msg_vec, (ADDRINT) msg_iovlen};
+    sys_writev_handler(retVal, writev_args, ret);
 }
 
 RETTYPE sys_sendmmsg_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     unsigned int vlen = (unsigned int) args[2];
     struct mmsghdr* arr = (struct mmsghdr*) args[1];
     for(unsigned int i = 0; i < vlen; ++i, ++arr){
         SyscallMemAccess arrMA((ADDRINT) arr, sizeof(struct mmsghdr), AccessType::READ);
-        vector<ADDRINT> sendmsg_args;
-        sendmsg_args.push_back(args[0]);
-        sendmsg_args.push_back((ADDRINT) arr);
-        sendmsg_args.push_back(args[3]);
-        set<SyscallMemAccess> sendmsg_result = sys_sendmsg_handler(arr->msg_len, sendmsg_args);
-        ret.insert(sendmsg_result.begin(), sendmsg_result.end());
+        ADDRINT sendmsg_args[] = {args[0], (ADDRINT) arr, args[3]};
+        sys_sendmsg_handler(arr->msg_len, sendmsg_args, ret);
         ret.insert(arrMA);
     }
-    return ret;
 }
 
 RETTYPE sys_bind_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     SyscallMemAccess ma(args[1], args[2], AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_getsockname_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     SyscallMemAccess lenMA(args[2], sizeof(socklen_t), AccessType::WRITE);
     socklen_t* addrlen = (socklen_t*) args[2];
     SyscallMemAccess addrMA(args[1], MIN(*addrlen, sizeof(struct sockaddr)), AccessType::WRITE);
     ret.insert(lenMA);
     ret.insert(addrMA);
-    return ret;
 }
 
 RETTYPE sys_getpeername_handler ARGUMENTS{
     // This syscall has the very same behaviour of getsockname. Just delegate to sys_getsockname_handler.
-    return sys_getsockname_handler(retVal, args);
+    return sys_getsockname_handler(retVal, args, ret);
 }
 
 RETTYPE sys_socketpair_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     SyscallMemAccess ma(args[3], 2 * sizeof(int), AccessType::WRITE);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_setsockopt_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     SyscallMemAccess ma(args[3], args[4], AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_getsockopt_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     socklen_t* optlen = (socklen_t*) args[4];
     SyscallMemAccess ma(args[3], *optlen, AccessType::WRITE);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_wait4_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal == -1)
-        return ret;
+        return;
 
     int* wstatus = (int*) args[1];
     struct rusage* rusage = (struct rusage*) args[3];
@@ -519,16 +434,13 @@ RETTYPE sys_wait4_handler ARGUMENTS{
         ret.insert(rusageMA);
     }
 
-    return ret;
 }
 
 RETTYPE sys_uname_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     SyscallMemAccess ma(args[0], sizeof(struct utsname), AccessType::WRITE);
     ret.insert(ma);
-    return ret;
 }
 
 // This is a quite complex system call. Indeed, its semantic is different according to the value of the |cmd|
@@ -539,9 +451,8 @@ RETTYPE sys_uname_handler ARGUMENTS{
 // from the kernel version have been guarded by pre-processor conditionals to check the corresponding value is
 // actually defined somewhere)
 RETTYPE sys_fcntl_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((int) retVal == -1)
-        return ret;
+        return;
 
     unsigned int cmd = (unsigned int) args[1];
     switch(cmd){
@@ -618,198 +529,158 @@ RETTYPE sys_fcntl_handler ARGUMENTS{
             {}
     }
 
-    return ret;
 }
 
 RETTYPE sys_truncate_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     const char* path = (char*) args[0];
     SyscallMemAccess ma(args[0], strlen(path), AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_getdents_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((int) retVal == -1)
-        return ret;
+        return;
     SyscallMemAccess ma(args[1], retVal, AccessType::WRITE);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_getcwd_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((char*) retVal == NULL)
-        return ret;
+        return;
     char* buf = (char*) args[0];
     SyscallMemAccess ma(args[0], strlen(buf), AccessType::WRITE);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_chdir_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     char* path = (char*) args[0];
     SyscallMemAccess ma(args[0], strlen(path), AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_rename_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     char* old = (char*) args[0];
     char* newpath = (char*) args[1];
     SyscallMemAccess oldMA(args[0], strlen(old), AccessType::READ);
     SyscallMemAccess newMA(args[1], strlen(newpath), AccessType::READ);
     ret.insert(oldMA);
     ret.insert(newMA);
-    return ret;
 }
 
 RETTYPE sys_renameat_handler ARGUMENTS{
-    vector<ADDRINT> rename_args;
-    rename_args.push_back(args[1]);
-    rename_args.push_back(args[3]);
-    return sys_rename_handler(retVal, rename_args);
+    ADDRINT rename_args[] = {args[1], args[3]};
+    return sys_rename_handler(retVal, rename_args, ret);
 }
 
 RETTYPE sys_renameat2_handler ARGUMENTS{
-    return sys_renameat_handler(retVal, args);
+    return sys_renameat_handler(retVal, args, ret);
 }
 
 RETTYPE sys_mkdir_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     char* path = (char*) args[0];
     SyscallMemAccess ma(args[0], strlen(path), AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_mkdirat_handler ARGUMENTS{
-    vector<ADDRINT> mkdir_args;
-    mkdir_args.push_back(args[1]);
-    mkdir_args.push_back(args[2]);
-    return sys_mkdir_handler(retVal, mkdir_args);
+    ADDRINT mkdir_args[] = {args[1], args[2]};
+    return sys_mkdir_handler(retVal, mkdir_args, ret);
 }
 
 RETTYPE sys_rmdir_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     char* path = (char*) args[0];
     SyscallMemAccess ma(args[0], strlen(path), AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_link_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     char* oldpath = (char*) args[0];
     char* newpath = (char*) args[1];
     SyscallMemAccess oldMA(args[0], strlen(oldpath), AccessType::READ);
     SyscallMemAccess newMA(args[1], strlen(newpath), AccessType::READ);
     ret.insert(oldMA);
     ret.insert(newMA);
-    return ret;
 }
 
 RETTYPE sys_linkat_handler ARGUMENTS{
-    vector<ADDRINT> link_args;
-    link_args.push_back(args[1]);
-    link_args.push_back(args[3]);
-    return sys_link_handler(retVal, link_args);
+    ADDRINT link_args[] = {args[1], args[3]};
+    return sys_link_handler(retVal, link_args, ret);
 }
 
 RETTYPE sys_unlink_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     char* path = (char*) args[0];
     SyscallMemAccess ma(args[0], strlen(path), AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_unlinkat_handler ARGUMENTS{
-    vector<ADDRINT> unlink_args;
-    unlink_args.push_back(args[1]);
-    return sys_unlink_handler(retVal, unlink_args);
+    ADDRINT unlink_args[] = {args[1]};
+    return sys_unlink_handler(retVal, unlink_args, ret);
 }
 
 RETTYPE sys_symlink_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     const char* target = (char*) args[0];
     const char* linkpath = (char*) args[1];
     SyscallMemAccess targetMA(args[0], strlen(target), AccessType::READ);
     SyscallMemAccess pathMA(args[1], strlen(linkpath), AccessType::READ);
     ret.insert(targetMA);
     ret.insert(pathMA);
-    return ret;
 }
 
 RETTYPE sys_symlinkat_handler ARGUMENTS{
-    vector<ADDRINT> symlink_args;
-    symlink_args.push_back(args[0]);
-    symlink_args.push_back(args[2]);
-    return sys_symlink_handler(retVal, symlink_args);
+    ADDRINT symlink_args[] = {args[0], args[2]};
+    return sys_symlink_handler(retVal, symlink_args, ret);
 }
 
 RETTYPE sys_chmod_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0) 
-        return ret;
+        return;
     const char* path = (char*) args[0];
     SyscallMemAccess ma(args[0], strlen(path), AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_fchmodat_handler ARGUMENTS{
-    vector<ADDRINT> chmod_args;
-    chmod_args.push_back(args[1]);
-    chmod_args.push_back(args[2]);
-    return sys_chmod_handler(retVal, chmod_args);
+    ADDRINT chmod_args[] = {args[1], args[2]};
+    return sys_chmod_handler(retVal, chmod_args, ret);
 }
 
 RETTYPE sys_chown_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     const char* path = (char*) args[0];
     SyscallMemAccess ma(args[0], strlen(path), AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_lchown_handler ARGUMENTS{
-    return sys_chown_handler(retVal, args);
+    return sys_chown_handler(retVal, args, ret);
 }
 
 RETTYPE sys_fchownat_handler ARGUMENTS{
-    vector<ADDRINT> chown_args;
-    chown_args.push_back(args[1]);
-    chown_args.push_back(args[2]);
-    chown_args.push_back(args[3]);
-    return sys_chown_handler(retVal, chown_args);
+    ADDRINT chown_args[] = {args[1], args[2], args[3]};
+    return sys_chown_handler(retVal, chown_args, ret);
 }
 
 RETTYPE sys_gettimeofday_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     struct timeval* tv = (struct timeval*) args[0];
     struct timezone* tz = (struct timezone*) args[1];
     if(tv != NULL){
@@ -820,13 +691,11 @@ RETTYPE sys_gettimeofday_handler ARGUMENTS{
         SyscallMemAccess tzMA(args[1], sizeof(struct timezone), AccessType::WRITE);
         ret.insert(tzMA);
     }
-    return ret;
 }
 
 RETTYPE sys_settimeofday_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     const struct timeval* tv = (struct timeval*) args[0];
     const struct timezone* tz = (struct timezone*) args[1];
     if(tv != NULL){
@@ -837,111 +706,84 @@ RETTYPE sys_settimeofday_handler ARGUMENTS{
         SyscallMemAccess tzMA(args[1], sizeof(struct timezone), AccessType::READ);
         ret.insert(tzMA);
     }
-    return ret;
 }
 
 RETTYPE sys_getrlimit_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     SyscallMemAccess ma(args[1], sizeof(struct rlimit), AccessType::WRITE);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_setrlimit_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     SyscallMemAccess ma(args[1], sizeof(struct rlimit), AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_prlimit_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
-    vector<ADDRINT> getrlimit_args;
-    vector<ADDRINT> setrlimit_args;
-    set<SyscallMemAccess> partialRes;
-
+        return;
     struct rlimit* old_limit = (struct rlimit*) args[3];
     if(old_limit != NULL){
-        getrlimit_args.push_back(args[1]);
-        getrlimit_args.push_back(args[3]);
-        partialRes = sys_getrlimit_handler(retVal, getrlimit_args);
-        ret.insert(partialRes.begin(), partialRes.end());
-        partialRes.clear();
+        ADDRINT getrlimit_args[] = {args[1], args[3]};
+        sys_getrlimit_handler(retVal, getrlimit_args, ret);
     }
 
     const struct rlimit* new_limit = (struct rlimit*) args[2];
     if(new_limit != NULL){
-        setrlimit_args.push_back(args[1]);
-        setrlimit_args.push_back(args[2]);
-        partialRes = sys_setrlimit_handler(retVal, setrlimit_args);
-        ret.insert(partialRes.begin(), partialRes.end());
+        ADDRINT setrlimit_args[] = {args[1], args[2]};
+        sys_setrlimit_handler(retVal, setrlimit_args, ret);
     }
-    return ret;
 }
 
 RETTYPE sys_getrusage_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     SyscallMemAccess ma(args[1], sizeof(struct rusage), AccessType::WRITE);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_sysinfo_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     SyscallMemAccess ma(args[0], sizeof(struct sysinfo), AccessType::WRITE);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_times_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     // Man page tells the returned value may overflow the possible range, and on error -1 is returned.
     // So, instead of a < comparison, perform an == comparison
     if((time_t) retVal == -1)
-        return ret;
+        return;
     SyscallMemAccess ma(args[0], sizeof(struct tms), AccessType::WRITE);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_getgroups_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     gid_t* list = (gid_t*) args[1];
     for(unsigned int i = 0; i < retVal; ++i, ++list){
         SyscallMemAccess ma((ADDRINT) list, sizeof(gid_t), AccessType::WRITE);
         ret.insert(ma);
     }
-    return ret;
 }
 
 RETTYPE sys_setgroups_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     gid_t* list = (gid_t*) args[1];
     for(unsigned int i = 0; i < args[0]; ++i, ++list){
         SyscallMemAccess ma((ADDRINT) list, sizeof(gid_t), AccessType::READ);
         ret.insert(ma);
     }
-    return ret;
 }
 
 RETTYPE sys_getresuid_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     size_t size = sizeof(uid_t);
     SyscallMemAccess realMA(args[0], size, AccessType::WRITE);
     SyscallMemAccess effectiveMA(args[1], size, AccessType::WRITE);
@@ -949,17 +791,15 @@ RETTYPE sys_getresuid_handler ARGUMENTS{
     ret.insert(realMA);
     ret.insert(effectiveMA);
     ret.insert(setMA);
-    return ret;
 }
 
 RETTYPE sys_getresgid_handler ARGUMENTS{
-    return sys_getresuid_handler(retVal, args);
+    return sys_getresuid_handler(retVal, args, ret);
 }
 
 RETTYPE sys_utime_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     const char* filename = (char*) args[0];
     SyscallMemAccess filenameMA(args[0], strlen(filename), AccessType::READ);
     ret.insert(filenameMA);
@@ -968,13 +808,11 @@ RETTYPE sys_utime_handler ARGUMENTS{
         SyscallMemAccess timesMA(args[1], sizeof(struct utimbuf), AccessType::READ);
         ret.insert(timesMA);
     }
-    return ret;
 }
 
 RETTYPE sys_utimes_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     const char* filename = (char*) args[0];
     SyscallMemAccess filenameMA(args[0], strlen(filename), AccessType::READ);
     ret.insert(filenameMA);
@@ -983,20 +821,16 @@ RETTYPE sys_utimes_handler ARGUMENTS{
         SyscallMemAccess timesMA(args[1], 2 * sizeof(struct timeval), AccessType::READ);
         ret.insert(timesMA);
     }
-    return ret;
 }
 
 RETTYPE sys_futimesat_handler ARGUMENTS{
-    vector<ADDRINT> utimes_args;
-    utimes_args.push_back(args[1]);
-    utimes_args.push_back(args[2]);
-    return sys_utimes_handler(retVal, utimes_args);
+    ADDRINT utimes_args[] = {args[1], args[2]};
+    return sys_utimes_handler(retVal, utimes_args, ret);
 }
 
 RETTYPE sys_waitid_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal == -1)
-        return ret;
+        return;
 
     struct siginfo* infop = (struct siginfo*) args[2];
     struct rusage* rusage = (struct rusage*) args[4];
@@ -1011,13 +845,11 @@ RETTYPE sys_waitid_handler ARGUMENTS{
         ret.insert(rusageMA);
     }
 
-    return ret;
 }
 
 RETTYPE sys_utimensat_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     const char* pathname = (char*) args[1];
     SyscallMemAccess pathMA(args[1], strlen(pathname), AccessType::READ);
     const struct timespec* times = (struct timespec*) args[2];
@@ -1025,188 +857,155 @@ RETTYPE sys_utimensat_handler ARGUMENTS{
         SyscallMemAccess timesMA(args[2], 2 * sizeof(struct timespec), AccessType::READ);
         ret.insert(timesMA);
     }
-    return ret;
 }
 
 // Syscall number not found
 RETTYPE sys_futimens_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     const struct timespec* times = (struct timespec*) args[1];
     if(times != NULL){
         SyscallMemAccess ma(args[1], 2 * sizeof(struct timespec), AccessType::READ);
         ret.insert(ma);
     }
-    return ret;
 }
 
 RETTYPE sys_mknod_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     const char* path = (char*) args[0];
     SyscallMemAccess ma(args[0], strlen(path), AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_mknodat_handler ARGUMENTS{
-    vector<ADDRINT> mknod_args;
-    mknod_args.push_back(args[1]);
-    mknod_args.push_back(args[2]);
-    mknod_args.push_back(args[3]);
-    return sys_mknod_handler(retVal, mknod_args);
+    ADDRINT mknod_args[] = {args[1], args[2], args[3]};
+    return sys_mknod_handler(retVal, mknod_args, ret);
 }
 
 RETTYPE sys_ustat_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     SyscallMemAccess ma(args[1], sizeof(struct ustat), AccessType::WRITE);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_statfs_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     const char* path = (char*) args[0];
     SyscallMemAccess pathMA(args[0], strlen(path), AccessType::READ);
     SyscallMemAccess bufMA(args[1], sizeof(struct statfs), AccessType::WRITE);
     ret.insert(pathMA);
     ret.insert(bufMA);
-    return ret;
 }
 
 RETTYPE sys_fstatfs_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     SyscallMemAccess ma(args[1], sizeof(struct statfs), AccessType::WRITE);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_chroot_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     const char* path = (char*) args[0];
     SyscallMemAccess ma(args[0], strlen(path), AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_acct_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     const char* filename = (char*) args[0];
     if(filename != NULL){
         SyscallMemAccess ma(args[0], strlen(filename), AccessType::READ);
         ret.insert(ma);
     }
-    return ret;
 }
 
 // Syscall number not found
 RETTYPE sys_gethostname_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0) 
-        return ret;
+        return;
     char* name = (char*) args[0];
     SyscallMemAccess ma(args[0], MIN(args[1], strlen(name) + 1), AccessType::WRITE);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_sethostname_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     const char* name = (char*) args[0];
     SyscallMemAccess ma(args[0], MIN(args[1], strlen(name)), AccessType::READ);
     ret.insert(ma);
-    return ret;
 }
 
 // Syscall number not found
 RETTYPE sys_getdomainname_handler ARGUMENTS{
-    return sys_gethostname_handler(retVal, args);
+    return sys_gethostname_handler(retVal, args, ret);
 }
 
 RETTYPE sys_setdomainname_handler ARGUMENTS{
-    return sys_sethostname_handler(retVal, args);
+    return sys_sethostname_handler(retVal, args, ret);
 }
 
 RETTYPE sys_time_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((time_t) retVal == -1)
-        return ret;
+        return;
     time_t* tloc = (time_t*) args[0];
     if(tloc != NULL){
         SyscallMemAccess ma(args[0], sizeof(time_t), AccessType::WRITE);
         ret.insert(ma);
     }
-    return ret;
 }
 
 RETTYPE sys_getdents64_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((int) retVal == -1)
-        return ret;
+        return;
 
     SyscallMemAccess ma(args[1], retVal, AccessType::WRITE);
     ret.insert(ma);
-    return ret;
 }
 
 RETTYPE sys_clock_settime ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((int) retVal == -1)
-        return ret;
+        return;
 
     const struct timespec* tp = (struct timespec*) args[1];
     if(tp != NULL){
         SyscallMemAccess ma(args[1], sizeof(struct timespec), AccessType::READ);
         ret.insert(ma);
     }
-    return ret;
 }
 
 RETTYPE sys_clock_gettime ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((int) retVal == -1)
-        return ret;
+        return;
     
     struct timespec* tp = (struct timespec*) args[1];
     if(tp != NULL){
         SyscallMemAccess ma(args[1], sizeof(struct timespec), AccessType::WRITE);
         ret.insert(ma);
     }
-    return ret;
 }
 
 RETTYPE sys_clock_getres ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((int) retVal == -1)
-        return ret;
+        return;
 
     struct timespec* res = (struct timespec*) args[1];
     if(res != NULL){
         SyscallMemAccess ma(args[1], sizeof(struct timespec), AccessType::WRITE);
         ret.insert(ma);
     }
-    return ret;
 }
 
 RETTYPE sys_clock_nanosleep ARGUMENTS{
-    set<SyscallMemAccess> ret;
     // NOTE: if this system call is interrupted, it returns EINTR and writes inside |remain| the
     if(retVal != 0 && retVal != EINTR)
-        return ret;
+        return;
 
     struct timespec* request = (struct timespec*) args[2];
     struct timespec* remain = (struct timespec*) args[3];
@@ -1226,13 +1025,11 @@ RETTYPE sys_clock_nanosleep ARGUMENTS{
         ret.insert(ma);
     }
 
-    return ret;
 }
 
 RETTYPE sys_rt_sigaction_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
     
     struct sigaction* act = (struct sigaction*) args[1];
     struct sigaction* oldact = (struct sigaction*) args[2];
@@ -1247,13 +1044,11 @@ RETTYPE sys_rt_sigaction_handler ARGUMENTS{
         ret.insert(oldactMA);
     }
 
-    return ret;
 }
 
 RETTYPE sys_rt_sigprocmask_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((long long) retVal < 0)
-        return ret;
+        return;
 
     sigset_t* set = (sigset_t*) args[1];
     sigset_t* oldset = (sigset_t*) args[2];
@@ -1268,13 +1063,11 @@ RETTYPE sys_rt_sigprocmask_handler ARGUMENTS{
         ret.insert(oldsetMA);
     }
 
-    return ret;
 }
 
 RETTYPE sys_sched_setattr_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((int) retVal < 0)
-        return ret;
+        return;
 
     struct sched_attr* attr = (struct sched_attr*) args[1];
     if(attr != NULL){
@@ -1282,13 +1075,11 @@ RETTYPE sys_sched_setattr_handler ARGUMENTS{
         ret.insert(attrMA);
     }
 
-    return ret;
 }
 
 RETTYPE sys_sched_getattr_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((int) retVal < 0)
-        return ret;
+        return;
 
     struct sched_attr* attr = (struct sched_attr*) args[1];
     if(attr != NULL){
@@ -1296,13 +1087,11 @@ RETTYPE sys_sched_getattr_handler ARGUMENTS{
         ret.insert(attrMA);
     }
 
-    return ret;
 }
 
 RETTYPE sys_getrandom_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((ssize_t) retVal == -1)
-        return ret;
+        return;
 
     // Return value is the number of bytes written into buffer args[0]. As happens with read system call,
     // it may be less than the requested value
@@ -1312,13 +1101,11 @@ RETTYPE sys_getrandom_handler ARGUMENTS{
         ret.insert(ma);
     }
 
-    return ret;
 }
 
 RETTYPE sys_memfd_create_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((int) retVal == -1)
-        return ret;
+        return;
 
     const char* name = (char*) args[0];
     if(name != NULL){
@@ -1326,13 +1113,11 @@ RETTYPE sys_memfd_create_handler ARGUMENTS{
         ret.insert(ma);
     }
 
-    return ret;
 }
 
 RETTYPE sys_bpf_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((int) retVal == -1)
-        return ret;
+        return;
 
     union bpf_attr* attr = (union bpf_attr*) args[1];
     if(attr != NULL){
@@ -1340,13 +1125,11 @@ RETTYPE sys_bpf_handler ARGUMENTS{
         ret.insert(ma);
     }
 
-    return ret;
 }
 
 RETTYPE sys_statx_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((int) retVal == -1)
-        return ret;
+        return;
 
     const char* pathname = (char*) args[1];
     struct statx* statxbuf = (struct statx*) args[4];
@@ -1360,13 +1143,11 @@ RETTYPE sys_statx_handler ARGUMENTS{
         ret.insert(ma);
     }
 
-    return ret;
 }
 
 RETTYPE sys_setxattr_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((int) retVal == -1)
-        return ret;
+        return;
 
     const char* path = (char*) args[0];
     const char* name = (char*) args[1];
@@ -1386,17 +1167,15 @@ RETTYPE sys_setxattr_handler ARGUMENTS{
         ret.insert(ma);
     }
 
-    return ret;
 }
 
 RETTYPE sys_lsetxattr_handler ARGUMENTS{
-    return sys_setxattr_handler(retVal, args);
+    return sys_setxattr_handler(retVal, args, ret);
 }
 
 RETTYPE sys_fsetxattr_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((int) retVal == -1)
-        return ret;
+        return;
 
     const char* name = (char*) args[1];
     const void* value = (char*) args[2];
@@ -1410,13 +1189,11 @@ RETTYPE sys_fsetxattr_handler ARGUMENTS{
         ret.insert(ma);
     }
 
-    return ret;
 }
 
 RETTYPE sys_getxattr_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((ssize_t) retVal == -1)
-        return ret;
+        return;
 
     const char* path = (char*) args[0];
     const char* name = (char*) args[1];
@@ -1436,17 +1213,15 @@ RETTYPE sys_getxattr_handler ARGUMENTS{
         ret.insert(ma);
     }
 
-    return ret;
 }
 
 RETTYPE sys_lgetxattr_handler ARGUMENTS{
-    return sys_getxattr_handler(retVal, args);
+    return sys_getxattr_handler(retVal, args, ret);
 }
 
 RETTYPE sys_fgetxattr_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((ssize_t) retVal == -1)
-        return ret;
+        return;
 
     const char* name = (char*) args[1];
     const void* value = (void*) args[2];
@@ -1460,13 +1235,11 @@ RETTYPE sys_fgetxattr_handler ARGUMENTS{
         ret.insert(ma);
     }
 
-    return ret;
 }
 
 RETTYPE sys_listxattr_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((ssize_t) retVal == -1)
-        return ret;
+        return;
 
     const char* path = (char*) args[0];
     char* list = (char*) args[1];
@@ -1490,17 +1263,15 @@ RETTYPE sys_listxattr_handler ARGUMENTS{
         ret.insert(ma);
     }
 
-    return ret;
 }
 
 RETTYPE sys_llistxattr_handler ARGUMENTS{
-    return sys_listxattr_handler(retVal, args);
+    return sys_listxattr_handler(retVal, args, ret);
 }
 
 RETTYPE sys_flistxattr_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((ssize_t) retVal == -1)
-        return ret;
+        return;
 
     char* list = (char*) args[1];
     size_t size = (size_t) args[2];
@@ -1519,13 +1290,11 @@ RETTYPE sys_flistxattr_handler ARGUMENTS{
         ret.insert(ma);
     }
 
-    return ret;
 }
 
 RETTYPE sys_removexattr_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((int) retVal == -1)
-        return ret;
+        return;
 
     const char* path = (char*) args[0];
     const char* name = (char*) args[1];
@@ -1539,17 +1308,15 @@ RETTYPE sys_removexattr_handler ARGUMENTS{
         ret.insert(ma);
     }
 
-    return ret;
 }
 
 RETTYPE sys_lremovexattr_handler ARGUMENTS{
-    return sys_removexattr_handler(retVal, args);
+    return sys_removexattr_handler(retVal, args, ret);
 }
 
 RETTYPE sys_fremovexattr_handler ARGUMENTS{
-    set<SyscallMemAccess> ret;
     if((int) retVal == -1)
-        return ret;
+        return;
 
     const char* name = (char*) args[1];
     if(name != NULL){
@@ -1557,7 +1324,6 @@ RETTYPE sys_fremovexattr_handler ARGUMENTS{
         ret.insert(ma);
     }
 
-    return ret;
 }
 
 #undef RETTYPE
@@ -1568,26 +1334,35 @@ RETTYPE sys_fremovexattr_handler ARGUMENTS{
 //////////////////////////////////////////////////////////////////
 //                      HANDLER SELECTOR                        //
 //  The only thing to do here is adding the new defined         //
-//  handler into 'handlers' map, inside method 'init()'         //
+//  handler into 'handlers' table, inside method 'init()'       //
 //  by using the macro 'SYSCALL_ENTRY'.                         //
 //  Macro's signature:                                          //    
 //  SYSCALL_ENTRY(<Syscall_Number>, <Args_Number>, <Handler>).  //
 //  <Args_Number> is the number of arguments the system call    //
 //  requires (e.g. read system call requires 3 arguments).      //
+//  <Syscall_Number> must be lower than SYSCALL_TABLE_SIZE.     //
 //  If no new handler has been defined, then nothing has to be  //
 //  done here.                                                  //
 //////////////////////////////////////////////////////////////////
 
-typedef set<SyscallMemAccess>(*HandlerFunction)(ADDRINT, vector<ADDRINT>);
+typedef void(*HandlerFunction)(ADDRINT, const ADDRINT*, SyscallEffects&);
+
+// Size of the handlers table, which is indexed by system call number (the highest x86_64 system call number is below 512)
+#define SYSCALL_TABLE_SIZE 512
+// Maximum number of arguments of a system call
+#define SYSCALL_MAX_ARGS 6
 
 #define SYSCALL_ENTRY(SYS_NUM, SYS_ARGS, SYS_HANDLER) \
-handlers.insert(pair<unsigned short, HandlerFunction>((SYS_NUM), (SYS_HANDLER)));\
-argsCount.insert(pair<unsigned short, unsigned short>((SYS_NUM), (SYS_ARGS)))
+static_assert((SYS_NUM) < SYSCALL_TABLE_SIZE && (SYS_ARGS) <= SYSCALL_MAX_ARGS, "Invalid system call entry");\
+handlers[(SYS_NUM)] = (SYS_HANDLER);\
+argsCount[(SYS_NUM)] = (SYS_ARGS)
 
 class HandlerSelector{
     private:
-        unordered_map<unsigned short, HandlerFunction> handlers;
-        unordered_map<unsigned short, unsigned short> argsCount;
+        // Flat tables indexed by system call number: system calls without a handler have a NULL handler
+        // and 0 arguments
+        HandlerFunction handlers[SYSCALL_TABLE_SIZE];
+        unsigned short argsCount[SYSCALL_TABLE_SIZE];
 
         void init(){
             SYSCALL_ENTRY(0, 3, sys_read_handler);
@@ -1714,7 +1489,7 @@ class HandlerSelector{
             unused.push_back(sys_futimens_handler);
         }
 
-        HandlerSelector(){
+        HandlerSelector() : handlers(), argsCount(){
             init();
         };
 
@@ -1727,19 +1502,19 @@ class HandlerSelector{
             return instance;
         }
 
-        set<SyscallMemAccess> handle_syscall(unsigned short sysNum, ADDRINT retVal, vector<ADDRINT> args){
-            auto handler = handlers.find(sysNum);
-            // If there's an handler in the map, execute it and return the result;
-            // otherwise, just return an empty set
-            /*if(handler == handlers.end()){
-                std::cerr << "System call " << std::dec << sysNum << " not implemented" << std::endl;
-            }*/
-            return handler == handlers.end() ? set<SyscallMemAccess>() : set<SyscallMemAccess>((*handler->second)(retVal, args));
+        // Stores into |effects| the memory accesses performed by system call |sysNum|, given its arguments and return value.
+        // |effects| is left empty if the system call has no handler
+        void handle_syscall(unsigned short sysNum, ADDRINT retVal, const ADDRINT* args, SyscallEffects& effects){
+            effects.clear();
+            if(sysNum >= SYSCALL_TABLE_SIZE || handlers[sysNum] == NULL){
+                /*std::cerr << "System call " << std::dec << sysNum << " not implemented" << std::endl;*/
+                return;
+            }
+            (*handlers[sysNum])(retVal, args, effects);
         }
 
         unsigned short getSyscallArgsCount(unsigned short sysNum){
-            auto count = argsCount.find(sysNum);
-            return count == argsCount.end() ? 0 : count->second;
+            return sysNum < SYSCALL_TABLE_SIZE ? argsCount[sysNum] : 0;
         }
 
 };
\ No newline at end of file